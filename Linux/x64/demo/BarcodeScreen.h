@@ -0,0 +1,122 @@
+#ifndef BARCODESCREEN_H_
+#define BARCODESCREEN_H_
+
+#include "RecognizerApi.h"
+#include "ScanlineRuns.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Texture class of a cell of the image, as told by barcodeScreenCell.
+ */
+typedef enum BarcodeScreenVerdict {
+	/* too little contrast on every scanline: background, blank paper */
+	BARCODE_SCREEN_FLAT,
+	/* too few edges along any direction: large print, photos, smooth shapes */
+	BARCODE_SCREEN_SPARSE,
+	/* as many edges along one direction as across it: text, guilloche, halftone */
+	BARCODE_SCREEN_ISOTROPIC,
+	/* dark or light runs all of one width: fine guilloche lines, hatching, ruled lines */
+	BARCODE_SCREEN_PERIODIC,
+	/* parallel bars of several widths: 1D and PDF417 codes */
+	BARCODE_SCREEN_LINEAR,
+	/* edges both ways with runs of several widths, accepted only with acceptMatrix: QR, Aztec, DataMatrix codes */
+	BARCODE_SCREEN_MATRIX,
+	BARCODE_SCREEN_VERDICT_COUNT
+} BarcodeScreenVerdict;
+
+/**
+ * Options of barcode screening.
+ */
+typedef struct BarcodeScreenOptions {
+	/* side of square cells in pixels. A cell should fit inside the smallest code, across and along its bars. */
+	int cellSize;
+	/* parallel scanlines per direction crossing each cell */
+	int linesPerCell;
+	/* difference between the darkest and brightest sample for a scanline to count */
+	int minContrast;
+	/* average runs per scanline across the bars of a code. Cells hold codes whose modules are at most
+	cellSize / minRuns pixels wide. */
+	int minRuns;
+	/* ratio of runs across the bars to runs along them */
+	float minAnisotropy;
+	/* ratio of wide to narrow runs, for dark and light runs alike */
+	float minWidthSpread;
+	/* if non-zero, isotropic cells with runs of several widths are accepted as matrix codes. Text passes this test
+	too, so it is left off unless 2D codes are expected and not located by their finder patterns. */
+	int acceptMatrix;
+	/* accepted region is extended by this many cells on each side, to take in quiet zones and code edges */
+	int marginCells;
+} BarcodeScreenOptions;
+
+/**
+ * Counters of barcode screening, accumulated over calls.
+ */
+typedef struct BarcodeScreenStats {
+	/* number of cells of each verdict */
+	unsigned long cells[BARCODE_SCREEN_VERDICT_COUNT];
+	/* images screened */
+	unsigned long numImages;
+	/* images in which no cell was accepted */
+	unsigned long numRejectedImages;
+	/* time spent screening in milliseconds */
+	double screenMs;
+} BarcodeScreenStats;
+
+/**
+ * Initializes options for 48 pixel cells crossed by 4 scanlines per direction, contrast 80, 8 runs per scanline,
+ * anisotropy 2, width spread 1.8, no matrix codes and a margin of 1 cell.
+ *
+ *  @param options options to initialize
+ */
+void barcodeScreenOptionsInit(BarcodeScreenOptions* options);
+
+/**
+ * Returns name of verdict.
+ *
+ *  @param verdict verdict
+ *
+ *  @return name of verdict, e.g. "linear"
+ */
+const char* barcodeScreenVerdictToString(BarcodeScreenVerdict verdict);
+
+/**
+ * Classifies one cell by its texture, at a small fraction of the cost of sampling it for decoding. Scanlines cross
+ * the cell horizontally, vertically and along both diagonals and are split into runs with scanlineRuns. Bars of a
+ * code are straight, so the direction with most runs crosses them while the perpendicular one runs along them and
+ * sees few; text and guilloche curves have edges in all directions. Bars and spaces of a code also come in several
+ * widths, while fine guilloche and hatching lines repeat one width.
+ *
+ *  @param image    image
+ *  @param x        left edge of the cell in pixels
+ *  @param y        top edge of the cell in pixels
+ *  @param options  options, or NULL for defaults
+ *
+ *  @return verdict of the cell
+ */
+BarcodeScreenVerdict barcodeScreenCell(const ScanlineImage* image, int x, int y, const BarcodeScreenOptions* options);
+
+/**
+ * Screens image cell by cell with barcodeScreenCell and returns the bounding region of accepted cells, so that
+ * decoders sample only that region, or none at all when nothing looks like a code. Cells of the last partial column
+ * and row are moved back to end at the image edge. Images smaller than one cell are not screened and their whole
+ * area is returned.
+ *
+ *  @param image    image
+ *  @param options  options, or NULL for defaults
+ *  @param region   set to the region holding all accepted cells with margin, in pixels
+ *  @param found    set to non-zero if any cell was accepted
+ *  @param stats    if non-NULL, verdicts and timing are added to it
+ *
+ *  @return status of the operation
+ */
+RecognizerErrorStatus barcodeScreen(const ScanlineImage* image, const BarcodeScreenOptions* options,
+		PPRectangle* region, int* found, BarcodeScreenStats* stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
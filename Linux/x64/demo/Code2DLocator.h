@@ -0,0 +1,129 @@
+#ifndef CODE2DLOCATOR_H_
+#define CODE2DLOCATOR_H_
+
+#include <stddef.h>
+
+#include "RecognizerApi.h"
+#include "RecognizerProfiles.h"
+#include "ScanlineRuns.h"
+#include "TiledRecognition.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* located symbols recognized by recognizeCodes2D at most */
+#define CODE2D_MAX_SYMBOLS 32
+
+/**
+ * 2D symbologies of ZXing told apart by localisation.
+ */
+typedef enum Code2DSymbology {
+	CODE2D_SYMBOLOGY_QR,
+	CODE2D_SYMBOLOGY_AZTEC,
+	CODE2D_SYMBOLOGY_DATA_MATRIX,
+	/* all of the above, read from the whole image when nothing is located */
+	CODE2D_SYMBOLOGY_ANY,
+	CODE2D_SYMBOLOGY_COUNT
+} Code2DSymbology;
+
+/**
+ * Options of 2D code localisation.
+ */
+typedef struct Code2DLocatorOptions {
+	/* distance between parallel scanlines in pixels. Must be smaller than the centre of the smallest finder pattern,
+	i.e. 3 modules of QR and Aztec symbols. */
+	int spacing;
+	/* side of square cells in which texture is measured, in pixels. Symbols are found if their modules are at most half
+	of a cell; cells of about four modules separate symbols from background best. */
+	int cellSize;
+	/* number of scanlines which must cross a finder pattern to accept it */
+	int minHits;
+	/* longest side in pixels of a texture region examined as a DataMatrix symbol. Larger regions are text or
+	background, and examining them would cost more than decoding. */
+	int maxDataMatrixSize;
+	/* each side of a located symbol is extended by this fraction of its size */
+	float margin;
+} Code2DLocatorOptions;
+
+/**
+ * Located 2D symbol.
+ */
+typedef struct Code2DCandidate {
+	Code2DSymbology symbology;
+	/* region holding the symbol, in pixels */
+	PPRectangle region;
+	/* scanlines crossing finder patterns of QR and Aztec symbols, textured cells of DataMatrix symbols */
+	size_t strength;
+} Code2DCandidate;
+
+/**
+ * Initializes options for scanlines 4 pixels apart, 16 pixel cells, 2 hits per finder pattern, DataMatrix symbols
+ * up to 512 pixels and 10% margin.
+ *
+ *  @param options options to initialize
+ */
+void code2DLocatorOptionsInit(Code2DLocatorOptions* options);
+
+/**
+ * Finds QR, Aztec and DataMatrix symbols in one sweep of scanlines, instead of one detection pass per symbology.
+ * Scanlines are run horizontally, vertically and along both diagonals and split into runs, on which QR finder
+ * patterns (1 1 3 1 1 modules) and Aztec bullseyes (9 runs of one module, or 1 1 1 3 1 1 1 modules off its centre)
+ * are matched; relative widths along any line through a pattern are the same, so rotated symbols are found. Horizontal
+ * and vertical scanlines also count edges per cell, and connected cells dense in edges both ways form texture regions.
+ *
+ * Finder patterns crossed by scanlines of at least two orientations are kept. Three QR finders forming a right
+ * isosceles triangle of equal module size make a QR symbol. A bullseye confirmed on lines through its centre makes an
+ * Aztec symbol, extending over the texture region around it. Texture regions holding no QR or Aztec symbol are taken
+ * as DataMatrix symbols if they have two long perpendicular solid edges, the L of the DataMatrix finder pattern.
+ *
+ *  @param image            image to search
+ *  @param options          options, or NULL for defaults
+ *  @param candidates       destination of located symbols, QR first, then Aztec and DataMatrix
+ *  @param maxCandidates    number of candidates which fit into candidates
+ *  @param numCandidates    set to number of located symbols
+ *
+ *  @return status of the operation
+ */
+RecognizerErrorStatus code2DLocate(const ScanlineImage* image, const Code2DLocatorOptions* options,
+		Code2DCandidate* candidates, size_t maxCandidates, size_t* numCandidates);
+
+/**
+ * Derives profile which reads only one 2D symbology, or all three for CODE2D_SYMBOLOGY_ANY: ZXing is enabled with
+ * only that symbology, all other recognizers are disabled, and multiple results are output so that touching symbols in one region are all reported. Other ZXing
+ * settings (inverse, thorough scan) are taken from base.
+ *
+ *  @param base         profile to derive from
+ *  @param symbology    symbology to read
+ *  @param profile      destination
+ */
+void code2DProfile(const RecognizerProfile* base, Code2DSymbology symbology, RecognizerProfile* profile);
+
+/**
+ * Locates all 2D symbols with code2DLocate, then decodes each located region with the recognizer of its symbology
+ * only, all regions in one parallel pass of recognizeClassifiedRegions. Each symbol is decoded on its own, so every
+ * symbol of the image is reported rather than the first one. If nothing is located, the whole image is recognized
+ * once, by the recognizer of CODE2D_SYMBOLOGY_ANY, rather than once per symbology.
+ *
+ *  @param recognizers      CODE2D_SYMBOLOGY_COUNT recognizers per thread, created from code2DProfile: recognizer of
+ *                          symbology s on thread t is at index t * CODE2D_SYMBOLOGY_COUNT + s
+ *  @param numRecognizers   number of threads
+ *  @param image            image to recognize
+ *  @param options          localisation options, or NULL for defaults
+ *  @param deadlineMs       absolute deadline of recognizeMonotonicMs() clock, or zero for no deadline
+ *  @param results          destination, tiles of which are the located regions. Must be released with
+ *                          tiledResultsTerm, also on failure.
+ *  @param symbologies      if non-NULL, set to the symbology of each tile of results. Must hold CODE2D_MAX_SYMBOLS
+ *                          entries.
+ *
+ *  @return status of the operation
+ */
+RecognizerErrorStatus recognizeCodes2D(const Recognizer* const* recognizers, size_t numRecognizers,
+		const RecognizerImage* image, const Code2DLocatorOptions* options, double deadlineMs, TiledResults* results,
+		Code2DSymbology* symbologies);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,121 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "DemoUtil.h"
+
+int demoBytesPerPixel(RawImageType type) {
+	switch (type) {
+	case RAW_IMAGE_TYPE_BGRA:
+		return 4;
+	case RAW_IMAGE_TYPE_BGR:
+		return 3;
+	default:
+		/* GRAY, and luma plane of NV21 */
+		return 1;
+	}
+}
+
+unsigned int demoLuma(const unsigned char* pixel, RawImageType type) {
+	switch (type) {
+	case RAW_IMAGE_TYPE_BGRA:
+	case RAW_IMAGE_TYPE_BGR:
+		return (29 * pixel[0] + 150 * pixel[1] + 77 * pixel[2] + 128) >> 8;
+	default:
+		return pixel[0];
+	}
+}
+
+int demoReadPath(FILE* list, char* path, size_t capacity) {
+	while (fgets(path, (int) capacity, list) != NULL) {
+		size_t length = strlen(path);
+		while (length > 0 && (path[length - 1] == '\n' || path[length - 1] == '\r')) path[--length] = '\0';
+		if (length > 0) return 1;
+	}
+	return 0;
+}
+
+int demoNextPath(char* const* files, int numFiles, int* index, char* path, size_t capacity) {
+	if (files == NULL) return demoReadPath(stdin, path, capacity);
+	if (*index >= numFiles) return 0;
+	strncpy(path, files[(*index)++], capacity - 1);
+	path[capacity - 1] = '\0';
+	return 1;
+}
+
+void jsonAppend(JsonBuffer* json, const char* data, size_t size) {
+	if (json->failed) return;
+	if (json->size + size + 1 > json->capacity) {
+		size_t capacity = json->capacity * 2 + size + 1;
+		char* grown = (char*) realloc(json->data, capacity);
+		if (grown == NULL) {
+			json->failed = 1;
+			return;
+		}
+		json->data = grown;
+		json->capacity = capacity;
+	}
+	memcpy(json->data + json->size, data, size);
+	json->size += size;
+	json->data[json->size] = '\0';
+}
+
+void jsonAppendText(JsonBuffer* json, const char* text) {
+	jsonAppend(json, text, strlen(text));
+}
+
+/* Writes escape sequence of byte c into escaped and returns its length, or returns zero if c needs no escaping.
+JSON is UTF-8, so bytes from 0x80 up are part of characters and pass through. */
+static size_t jsonEscape(unsigned char c, char escaped[8]) {
+	if (c == '"' || c == '\\') {
+		escaped[0] = '\\';
+		escaped[1] = (char) c;
+		return 2;
+	}
+	if (c < 0x20) {
+		sprintf(escaped, "\\u%04x", c);
+		return 6;
+	}
+	return 0;
+}
+
+void jsonAppendString(JsonBuffer* json, const char* data, size_t length) {
+	size_t i, start = 0;
+
+	jsonAppend(json, "\"", 1);
+	for (i = 0; i < length; ++i) {
+		char escaped[8];
+		size_t n = jsonEscape((unsigned char) data[i], escaped);
+		if (n == 0) continue;
+		/* runs of plain bytes are copied at once */
+		jsonAppend(json, data + start, i - start);
+		jsonAppend(json, escaped, n);
+		start = i + 1;
+	}
+	jsonAppend(json, data + start, length - start);
+	jsonAppend(json, "\"", 1);
+}
+
+void jsonAppendField(JsonBuffer* json, int* first, const char* name, StringView value) {
+	if (value.length == 0) return;
+	if (!*first) jsonAppend(json, ",", 1);
+	*first = 0;
+	jsonAppendString(json, name, strlen(name));
+	jsonAppend(json, ":", 1);
+	jsonAppendString(json, value.data, value.length);
+}
+
+void jsonPrintString(const char* data, size_t length) {
+	size_t i;
+
+	putchar('"');
+	for (i = 0; i < length; ++i) {
+		char escaped[8];
+		size_t n = jsonEscape((unsigned char) data[i], escaped);
+		if (n == 0) {
+			putchar(data[i]);
+		} else {
+			fwrite(escaped, 1, n, stdout);
+		}
+	}
+	putchar('"');
+}
@@ -0,0 +1,350 @@
+#define _POSIX_C_SOURCE 199506L
+
+#include <stddef.h>
+#include <string.h>
+#include <time.h>
+
+#include "MRTDFields.h"
+
+typedef RecognizerErrorStatus (PP_CALL *MRTDStringGetter)(const RecognizerResult* result, const char** dst);
+
+/* string getter of each string field, in order of members of MRTDFields */
+static const struct {
+	MRTDStringGetter getter;
+	size_t offset;
+} stringFields[] = {
+	{ recognizerResultGetMRTDDocumentCode, offsetof(MRTDFields, documentCode) },
+	{ recognizerResultGetMRTDIssuer, offsetof(MRTDFields, issuer) },
+	{ recognizerResultGetMRTDDocumentNumber, offsetof(MRTDFields, documentNumber) },
+	{ recognizerResultGetMRTDPrimaryID, offsetof(MRTDFields, primaryID) },
+	{ recognizerResultGetMRTDSecondaryID, offsetof(MRTDFields, secondaryID) },
+	{ recognizerResultGetMRTDNationality, offsetof(MRTDFields, nationality) },
+	{ recognizerResultGetMRTDSex, offsetof(MRTDFields, sex) },
+	{ recognizerResultGetMRTDDateOfBirth, offsetof(MRTDFields, dateOfBirth) },
+	{ recognizerResultGetMRTDDateOfExpiry, offsetof(MRTDFields, dateOfExpiry) },
+	{ recognizerResultGetMRTDOpt1, offsetof(MRTDFields, opt1) },
+	{ recognizerResultGetMRTDOpt2, offsetof(MRTDFields, opt2) },
+	{ recognizerResultGetMRTDAlienNumber, offsetof(MRTDFields, alienNumber) },
+	{ recognizerResultGetMRTDApplicationReceiptNumber, offsetof(MRTDFields, applicationReceiptNumber) },
+	{ recognizerResultGetMRTDImmigrantCaseNumber, offsetof(MRTDFields, immigrantCaseNumber) },
+	{ recognizerResultGetMRTDRawStringData, offsetof(MRTDFields, rawData) }
+};
+
+#define NUM_STRING_FIELDS (sizeof(stringFields) / sizeof(stringFields[0]))
+
+static StringView* fieldAt(MRTDFields* fields, size_t i) {
+	return (StringView*) ((char*) fields + stringFields[i].offset);
+}
+
+static int currentYear() {
+	time_t now = time(NULL);
+	struct tm t;
+	return gmtime_r(&now, &t) != NULL ? t.tm_year + 1900 : 2000;
+}
+
+/* Parses YYMMDD. Two digit year is placed into the latest century for which it is not after maxYear. */
+static MRTDDate parseDate(StringView str, int maxYear) {
+	MRTDDate date = { 0, 0, 0 };
+	int digits[6];
+	int i;
+	int year;
+
+	if (str.length != 6) return date;
+	for (i = 0; i < 6; ++i) {
+		if (str.data[i] < '0' || str.data[i] > '9') return date;
+		digits[i] = str.data[i] - '0';
+	}
+
+	year = 2000 + digits[0] * 10 + digits[1];
+	while (year > maxYear) year -= 100;
+
+	date.year = year;
+	date.month = digits[2] * 10 + digits[3];
+	date.day = digits[4] * 10 + digits[5];
+	if (date.month < 1 || date.month > 12 || date.day < 1 || date.day > 31) {
+		date.day = date.month = date.year = 0;
+	}
+	return date;
+}
+
+/* Running ICAO 9303 check digit over one or more segments */
+typedef struct CheckSum {
+	int sum;
+	int position;
+	int invalid;
+} CheckSum;
+
+static int mrzCharValue(char c) {
+	if (c >= '0' && c <= '9') return c - '0';
+	if (c >= 'A' && c <= 'Z') return c - 'A' + 10;
+	if (c == '<') return 0;
+	return -1;
+}
+
+static void checkSumAdd(CheckSum* check, const char* data, size_t length) {
+	static const int weights[3] = { 7, 3, 1 };
+	size_t i;
+
+	for (i = 0; i < length; ++i) {
+		int value = mrzCharValue(data[i]);
+		if (value < 0) check->invalid = 1;
+		else check->sum += value * weights[check->position++ % 3];
+	}
+}
+
+/* Filler in place of a check digit stands for zero, used when the checked field is empty */
+static int checkSumMatches(const CheckSum* check, char digit) {
+	return !check->invalid && (digit == '<' ? 0 : digit - '0') == check->sum % 10;
+}
+
+static int fieldCheckMatches(const char* data, size_t length, char digit) {
+	CheckSum check = { 0, 0, 0 };
+	checkSumAdd(&check, data, length);
+	return checkSumMatches(&check, digit);
+}
+
+/* Reads letter O as digit 0 in a numeric field, the most common OCR confusion in MRZ */
+static void fixDigits(char* data, size_t length) {
+	size_t i;
+	for (i = 0; i < length; ++i) {
+		if (data[i] == 'O') data[i] = '0';
+	}
+}
+
+/* View of field with trailing fillers removed */
+static StringView mrzField(const char* data, size_t length) {
+	StringView view;
+	while (length > 0 && data[length - 1] == '<') --length;
+	view.data = data;
+	view.length = length;
+	return view;
+}
+
+/* Splits name field at "<<" into primary and secondary identifier and turns remaining fillers into spaces */
+static void parseName(MRTDFields* fields, char* name, size_t length) {
+	StringView whole = mrzField(name, length);
+	size_t i, split = whole.length;
+
+	for (i = 0; i < whole.length; ++i) {
+		if (name[i] == '<') {
+			if (split == whole.length && i + 1 < whole.length && name[i + 1] == '<') split = i;
+			name[i] = ' ';
+		}
+	}
+	fields->primaryID.data = name;
+	fields->primaryID.length = split;
+	if (split + 2 <= whole.length) {
+		fields->secondaryID.data = name + split + 2;
+		fields->secondaryID.length = whole.length - split - 2;
+	}
+}
+
+static MRTDDocumentType documentTypeOf(const char* code, const char* issuer) {
+	if (code[0] == 'P') return MRTD_TYPE_PASSPORT;
+	if (code[0] == 'V') return MRTD_TYPE_VISA;
+	if (code[0] == 'C' && code[1] == '1' && memcmp(issuer, "USA", 3) == 0) return MRTD_TYPE_GREEN_CARD;
+	if (code[0] == 'I' || code[0] == 'A' || code[0] == 'C') return MRTD_TYPE_IDENITY_CARD;
+	return MRTD_TYPE_UNKNOWN;
+}
+
+/* TD2, TD3 and visas: line 1 holds code, issuer and name, line 2 the number, dates and optional data */
+static unsigned int parseTwoLines(MRTDFields* fields, char* mrz, size_t lineLength) {
+	char* line1 = mrz;
+	char* line2 = mrz + lineLength;
+	unsigned int failed = 0;
+	int visa = line1[0] == 'V';
+	CheckSum composite = { 0, 0, 0 };
+	size_t optLength = lineLength - 28;
+
+	fixDigits(line2 + 13, 7);
+	fixDigits(line2 + 21, 7);
+	fixDigits(line2 + 9, 1);
+	if (!fieldCheckMatches(line2, 9, line2[9])) failed |= MRZ_CHECK_DOCUMENT_NUMBER;
+	if (!fieldCheckMatches(line2 + 13, 6, line2[19])) failed |= MRZ_CHECK_DATE_OF_BIRTH;
+	if (!fieldCheckMatches(line2 + 21, 6, line2[27])) failed |= MRZ_CHECK_DATE_OF_EXPIRY;
+
+	/* visas have neither personal number check digit nor composite check digit */
+	if (!visa) {
+		optLength = lineLength == 44 ? 14 : 7;
+		fixDigits(line2 + lineLength - 1, 1);
+		if (lineLength == 44) {
+			fixDigits(line2 + 42, 1);
+			if (!fieldCheckMatches(line2 + 28, 14, line2[42])) failed |= MRZ_CHECK_OPTIONAL_DATA;
+		}
+		checkSumAdd(&composite, line2, 10);
+		checkSumAdd(&composite, line2 + 13, 7);
+		checkSumAdd(&composite, line2 + 21, lineLength - 22);
+		if (!checkSumMatches(&composite, line2[lineLength - 1])) failed |= MRZ_CHECK_COMPOSITE;
+	}
+
+	fields->documentType = documentTypeOf(line1, line1 + 2);
+	fields->documentCode = mrzField(line1, 2);
+	fields->issuer = mrzField(line1 + 2, 3);
+	parseName(fields, line1 + 5, lineLength - 5);
+	fields->documentNumber = mrzField(line2, 9);
+	fields->nationality = mrzField(line2 + 10, 3);
+	fields->dateOfBirth = mrzField(line2 + 13, 6);
+	fields->sex = mrzField(line2 + 20, 1);
+	fields->dateOfExpiry = mrzField(line2 + 21, 6);
+	fields->opt1 = mrzField(line2 + 28, optLength);
+	return failed;
+}
+
+/* TD1: line 1 holds code, issuer, number and optional data, line 2 dates, nationality and optional data, line 3 name */
+static unsigned int parseThreeLines(MRTDFields* fields, char* mrz) {
+	char* line1 = mrz;
+	char* line2 = mrz + 30;
+	char* line3 = mrz + 60;
+	unsigned int failed = 0;
+	CheckSum composite = { 0, 0, 0 };
+	size_t numberLength = 9, optStart = 15, end = 15;
+	/* number longer than 9 characters continues in optional data, ended by its check digit */
+	int longNumber = line1[14] == '<' && line1[15] != '<';
+
+	/* check digits of line 1 are fixed before they are summed into the composite */
+	if (longNumber) {
+		CheckSum check = { 0, 0, 0 };
+
+		while (end < 30 && line1[end] != '<') ++end;
+		fixDigits(line1 + end - 1, 1);
+		checkSumAdd(&check, line1 + 5, 9);
+		checkSumAdd(&check, line1 + 15, end - 16);
+		if (!checkSumMatches(&check, line1[end - 1])) failed |= MRZ_CHECK_DOCUMENT_NUMBER;
+	} else {
+		fixDigits(line1 + 14, 1);
+		if (!fieldCheckMatches(line1 + 5, 9, line1[14])) failed |= MRZ_CHECK_DOCUMENT_NUMBER;
+	}
+
+	fixDigits(line2, 7);
+	fixDigits(line2 + 8, 7);
+	fixDigits(line2 + 29, 1);
+	if (!fieldCheckMatches(line2, 6, line2[6])) failed |= MRZ_CHECK_DATE_OF_BIRTH;
+	if (!fieldCheckMatches(line2 + 8, 6, line2[14])) failed |= MRZ_CHECK_DATE_OF_EXPIRY;
+	checkSumAdd(&composite, line1 + 5, 25);
+	checkSumAdd(&composite, line2, 7);
+	checkSumAdd(&composite, line2 + 8, 7);
+	checkSumAdd(&composite, line2 + 18, 11);
+	if (!checkSumMatches(&composite, line2[29])) failed |= MRZ_CHECK_COMPOSITE;
+
+	if (longNumber) {
+		/* the rest of the number is moved next to its first 9 characters, over the filler between them */
+		memmove(line1 + 14, line1 + 15, end - 16);
+		line1[end - 2] = '<';
+		numberLength = 9 + end - 16;
+		/* optional data follows the filler ending the number */
+		optStart = end < 30 ? end + 1 : 30;
+	}
+
+	fields->documentType = documentTypeOf(line1, line1 + 2);
+	fields->documentCode = mrzField(line1, 2);
+	fields->issuer = mrzField(line1 + 2, 3);
+	fields->documentNumber = mrzField(line1 + 5, numberLength);
+	fields->opt1 = mrzField(line1 + optStart, 30 - optStart);
+	fields->dateOfBirth = mrzField(line2, 6);
+	fields->sex = mrzField(line2 + 7, 1);
+	fields->dateOfExpiry = mrzField(line2 + 8, 6);
+	fields->nationality = mrzField(line2 + 15, 3);
+	fields->opt2 = mrzField(line2 + 18, 11);
+	parseName(fields, line3, 30);
+	return failed;
+}
+
+RecognizerErrorStatus mrtdFieldsFromResult(MRTDFields* fields, const RecognizerResult* result) {
+	RecognizerErrorStatus status;
+	int isMrtd = 0;
+	int year;
+	size_t i;
+
+	if (fields == NULL || result == NULL) return RECOGNIZER_ERROR_STATUS_POINTER_IS_NULL;
+
+	memset(fields, 0, sizeof(*fields));
+
+	status = recognizerResultIsMRTDResult(result, &isMrtd);
+	if (status != RECOGNIZER_ERROR_STATUS_SUCCESS) return status;
+	if (!isMrtd) return RECOGNIZER_ERROR_STATUS_INVALID_TYPE;
+
+	if (recognizerResultGetMRTDDocumentType(result, &fields->documentType) != RECOGNIZER_ERROR_STATUS_SUCCESS) {
+		fields->documentType = MRTD_TYPE_UNKNOWN;
+	}
+
+	for (i = 0; i < NUM_STRING_FIELDS; ++i) {
+		const char* value = NULL;
+		StringView* view = fieldAt(fields, i);
+		if (stringFields[i].getter(result, &value) == RECOGNIZER_ERROR_STATUS_SUCCESS && value != NULL) {
+			view->data = value;
+			view->length = strlen(value);
+		} else {
+			view->data = "";
+		}
+	}
+
+	/* nobody is born in the future, while documents expire up to a few decades ahead */
+	year = currentYear();
+	fields->birthDate = parseDate(fields->dateOfBirth, year);
+	fields->expiryDate = parseDate(fields->dateOfExpiry, year + 50);
+	return RECOGNIZER_ERROR_STATUS_SUCCESS;
+}
+
+RecognizerErrorStatus mrtdFieldsCopy(MRTDFields* dst, const MRTDFields* src, char* buffer, size_t capacity, size_t* required) {
+	MRTDFields copy;
+	size_t total = 0;
+	size_t i;
+	char* out = buffer;
+
+	if (dst == NULL || src == NULL) return RECOGNIZER_ERROR_STATUS_POINTER_IS_NULL;
+
+	copy = *src;
+	for (i = 0; i < NUM_STRING_FIELDS; ++i) {
+		total += fieldAt(&copy, i)->length + 1;
+	}
+	if (required != NULL) *required = total;
+	if (buffer == NULL || capacity < total) return RECOGNIZER_ERROR_STATUS_FAIL;
+
+	for (i = 0; i < NUM_STRING_FIELDS; ++i) {
+		StringView* view = fieldAt(&copy, i);
+		if (view->length > 0) memcpy(out, view->data, view->length);
+		out[view->length] = '\0';
+		view->data = out;
+		out += view->length + 1;
+	}
+
+	*dst = copy;
+	return RECOGNIZER_ERROR_STATUS_SUCCESS;
+}
+
+RecognizerErrorStatus mrtdFieldsParse(MRTDFields* fields, const char* mrz, char* buffer, size_t capacity,
+		unsigned int* failedChecks) {
+	size_t length = 0;
+	unsigned int failed;
+	int year;
+	size_t i;
+
+	if (failedChecks != NULL) *failedChecks = 0;
+	if (fields == NULL || mrz == NULL || buffer == NULL) return RECOGNIZER_ERROR_STATUS_POINTER_IS_NULL;
+
+	memset(fields, 0, sizeof(*fields));
+	for (i = 0; i < NUM_STRING_FIELDS; ++i) fieldAt(fields, i)->data = "";
+	fields->documentType = MRTD_TYPE_UNKNOWN;
+
+	for (i = 0; mrz[i] != '\0'; ++i) {
+		if (mrz[i] == ' ' || mrz[i] == '\t' || mrz[i] == '\r' || mrz[i] == '\n') continue;
+		if (length == capacity) return RECOGNIZER_ERROR_STATUS_FAIL;
+		buffer[length++] = mrz[i];
+	}
+
+	if (length == 90) {
+		failed = parseThreeLines(fields, buffer);
+	} else if (length == 88 || length == 72) {
+		failed = parseTwoLines(fields, buffer, length / 2);
+	} else {
+		return RECOGNIZER_ERROR_STATUS_INVALID_TYPE;
+	}
+	fields->rawData.data = mrz;
+	fields->rawData.length = i;
+
+	year = currentYear();
+	fields->birthDate = parseDate(fields->dateOfBirth, year);
+	fields->expiryDate = parseDate(fields->dateOfExpiry, year + 50);
+	if (failedChecks != NULL) *failedChecks = failed;
+	return RECOGNIZER_ERROR_STATUS_SUCCESS;
+}
@@ -0,0 +1,110 @@
+#ifndef MRTDFIELDS_H_
+#define MRTDFIELDS_H_
+
+#include <stddef.h>
+
+#include "RecognizerApi.h"
+#include "StringView.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Date parsed from MRZ YYMMDD format. All members are zero if date could not be parsed.
+ */
+typedef struct MRTDDate {
+	int day;
+	int month;
+	/* four digit year, century inferred from the kind of date */
+	int year;
+} MRTDDate;
+
+/**
+ * All fields of MRTD result obtained at once.
+ */
+typedef struct MRTDFields {
+	MRTDDocumentType documentType;
+	StringView documentCode;
+	StringView issuer;
+	StringView documentNumber;
+	StringView primaryID;
+	StringView secondaryID;
+	StringView nationality;
+	StringView sex;
+	StringView dateOfBirth;
+	StringView dateOfExpiry;
+	StringView opt1;
+	StringView opt2;
+	/* green card only fields, empty for other documents */
+	StringView alienNumber;
+	StringView applicationReceiptNumber;
+	StringView immigrantCaseNumber;
+	/* raw MRZ lines */
+	StringView rawData;
+	MRTDDate birthDate;
+	MRTDDate expiryDate;
+} MRTDFields;
+
+/**
+ * Check digits of MRZ, as bits of the failedChecks mask of mrtdFieldsParse.
+ */
+typedef enum MRZCheck {
+	MRZ_CHECK_DOCUMENT_NUMBER = 1,
+	MRZ_CHECK_DATE_OF_BIRTH = 2,
+	MRZ_CHECK_DATE_OF_EXPIRY = 4,
+	/* personal number of passports */
+	MRZ_CHECK_OPTIONAL_DATA = 8,
+	MRZ_CHECK_COMPOSITE = 16
+} MRZCheck;
+
+/**
+ * Fills fields from MRTD result. Views point to strings owned by result, so they are valid until the result list
+ * holding the result is deleted. Fields that result does not have are set to empty views.
+ *
+ *  @param fields   destination
+ *  @param result   MRTD result
+ *
+ *  @return status of the operation. RECOGNIZER_ERROR_STATUS_INVALID_TYPE if result is not MRTD result.
+ */
+RecognizerErrorStatus mrtdFieldsFromResult(MRTDFields* fields, const RecognizerResult* result);
+
+/**
+ * Parses MRZ text, e.g. from an NFC chip or a partner feed, into fields without any image recognition. TD1 (3 lines
+ * of 30 characters), TD2 (2 x 36) and TD3 (2 x 44) documents and visas are supported; lines may be separated by
+ * whitespace or concatenated. Check digits are verified with ICAO 9303 weights, with letter O read as digit 0 in
+ * numeric positions. Names are split at "<<" and their fillers turned into spaces, so fields read like those of
+ * mrtdFieldsFromResult. Green card specific fields are left empty.
+ *
+ *  @param fields       destination. Views point into buffer, except rawData which points to mrz.
+ *  @param mrz          zero-terminated MRZ text
+ *  @param buffer       buffer for normalized MRZ text, must outlive fields
+ *  @param capacity     size of buffer in bytes, at least the number of non-whitespace characters of mrz
+ *  @param failedChecks if non-NULL, set to mask of MRZCheck values for check digits which did not match
+ *
+ *  @return status of the operation. RECOGNIZER_ERROR_STATUS_INVALID_TYPE if mrz has no known layout,
+ *          RECOGNIZER_ERROR_STATUS_FAIL if buffer is too small. Mismatching check digits are reported only in
+ *          failedChecks.
+ */
+RecognizerErrorStatus mrtdFieldsParse(MRTDFields* fields, const char* mrz, char* buffer, size_t capacity,
+		unsigned int* failedChecks);
+
+/**
+ * Copies all strings of fields into one contiguous caller-provided buffer and makes dst refer to it, so that fields
+ * can outlive the result or be serialized without allocating per field. Strings in buffer are zero-terminated.
+ *
+ *  @param dst          destination fields, may be the same as src
+ *  @param src          fields to copy
+ *  @param buffer       destination buffer, may be NULL when only querying the required size
+ *  @param capacity     size of buffer in bytes
+ *  @param required     if non-NULL, set to number of bytes needed for all strings
+ *
+ *  @return status of the operation. RECOGNIZER_ERROR_STATUS_FAIL if buffer is too small, in which case dst is not modified.
+ */
+RecognizerErrorStatus mrtdFieldsCopy(MRTDFields* dst, const MRTDFields* src, char* buffer, size_t capacity, size_t* required);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
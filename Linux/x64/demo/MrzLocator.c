@@ -0,0 +1,263 @@
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "MrzLocator.h"
+#include "DemoUtil.h"
+
+/* Counts positions in row where neighbouring gray levels differ by more than threshold */
+static int countEdges(const unsigned char* row, int length, unsigned char threshold) {
+	int count = 0;
+	int i = 0;
+
+#ifdef __SSE2__
+	const __m128i t = _mm_set1_epi8((char) threshold);
+	const __m128i zero = _mm_setzero_si128();
+
+	for (; i + 17 <= length; i += 16) {
+		__m128i a = _mm_loadu_si128((const __m128i*) (row + i));
+		__m128i b = _mm_loadu_si128((const __m128i*) (row + i + 1));
+		/* saturating subtraction in both directions gives absolute difference of unsigned bytes */
+		__m128i diff = _mm_or_si128(_mm_subs_epu8(a, b), _mm_subs_epu8(b, a));
+		__m128i notEdge = _mm_cmpeq_epi8(_mm_subs_epu8(diff, t), zero);
+		count += 16 - __builtin_popcount((unsigned int) _mm_movemask_epi8(notEdge));
+	}
+#endif
+	for (; i + 1 < length; ++i) {
+		int diff = row[i + 1] - row[i];
+		count += (diff > threshold) | (-diff > threshold);
+	}
+	return count;
+}
+
+/* Point samples luma of rectangle (left, top, regionWidth, regionHeight) of image into gray copy of size width x height.
+Each copy pixel averages two samples half a step apart horizontally, so that thin character strokes are not skipped
+over. */
+static RecognizerErrorStatus sampleImage(const RecognizerImage* image, int left, int top, int regionWidth,
+		int regionHeight, unsigned char* copy, int width, int height) {
+	const unsigned char* src;
+	void* data;
+	int bytesPerRow, channels, x, y;
+	size_t* offsets;
+	RawImageType type;
+	RecognizerErrorStatus status;
+
+	status = recognizerImageGetRawBytes(image, &data);
+	if (status == RECOGNIZER_ERROR_STATUS_SUCCESS) status = recognizerImageGetBytesPerRow(image, &bytesPerRow);
+	if (status == RECOGNIZER_ERROR_STATUS_SUCCESS) status = recognizerImageGetRawImageType(image, &type);
+	if (status != RECOGNIZER_ERROR_STATUS_SUCCESS) return status;
+	src = (const unsigned char*) data;
+	channels = demoBytesPerPixel(type);
+
+	offsets = (size_t*) malloc(2 * (size_t) width * sizeof(size_t));
+	if (offsets == NULL) return RECOGNIZER_ERROR_STATUS_FAIL;
+	for (x = 0; x < width; ++x) {
+		size_t sx = (size_t) x * regionWidth / width;
+		size_t half = sx + (size_t) regionWidth / (2 * width);
+		offsets[2 * x] = (left + sx) * channels;
+		offsets[2 * x + 1] = (left + (half < (size_t) regionWidth ? half : sx)) * channels;
+	}
+
+	for (y = 0; y < height; ++y) {
+		size_t sy = top + ((size_t) y * regionHeight + regionHeight / 2) / height;
+		const unsigned char* row = src + sy * bytesPerRow;
+		unsigned char* out = copy + (size_t) y * width;
+		for (x = 0; x < width; ++x) {
+			out[x] = (unsigned char) ((demoLuma(row + offsets[2 * x], type) + demoLuma(row + offsets[2 * x + 1], type) + 1) / 2);
+		}
+	}
+
+	free(offsets);
+	return RECOGNIZER_ERROR_STATUS_SUCCESS;
+}
+
+/* Finds the strongest group of rows dense in edges, tolerating gaps between text lines. Returns zero if none. */
+static int findBand(const int* scores, int height, int minScore, int* top, int* bottom) {
+	int maxGap = height / 50 > 2 ? height / 50 : 2;
+	long best = 0;
+	int y = 0;
+
+	while (y < height) {
+		int start, end, gap;
+		long strength = 0;
+
+		if (scores[y] < minScore) {
+			++y;
+			continue;
+		}
+		start = end = y;
+		for (gap = 0; y < height && gap <= maxGap; ++y) {
+			if (scores[y] >= minScore) {
+				strength += scores[y];
+				end = y;
+				gap = 0;
+			} else {
+				++gap;
+			}
+		}
+		/* a single row is noise; MRZ has at least two lines, each several rows high */
+		if (end - start >= 2 && strength > best) {
+			best = strength;
+			*top = start;
+			*bottom = end + 1;
+		}
+	}
+	return best > 0;
+}
+
+/* Finds horizontal extent of the band as the columns holding all but 2% of edges on each side */
+static void findExtent(const unsigned char* copy, int width, int top, int bottom, int threshold, int* left, int* right) {
+	long* columns = (long*) calloc((size_t) width, sizeof(long));
+	long total = 0, sum = 0;
+	int x, y;
+
+	*left = 0;
+	*right = width;
+	if (columns == NULL) return;
+
+	for (y = top; y < bottom; ++y) {
+		const unsigned char* row = copy + (size_t) y * width;
+		for (x = 0; x + 1 < width; ++x) {
+			int diff = row[x + 1] - row[x];
+			if (diff > threshold || -diff > threshold) ++columns[x];
+		}
+	}
+	for (x = 0; x < width; ++x) total += columns[x];
+	for (x = 0; x < width && sum + columns[x] <= total / 50; ++x) sum += columns[x];
+	*left = x;
+	for (sum = 0, x = width - 1; x > *left && sum + columns[x] <= total / 50; --x) sum += columns[x];
+	*right = x + 1;
+	free(columns);
+}
+
+void mrzLocatorOptionsInit(MrzLocatorOptions* options) {
+	options->workWidth = 640;
+	options->edgeThreshold = 24;
+	options->margin = 0.25f;
+	options->roi = NULL;
+	options->retryWholeImage = 1;
+}
+
+static float clampRelative(float v) {
+	return v < 0.f ? 0.f : (v > 1.f ? 1.f : v);
+}
+
+RecognizerErrorStatus mrzLocate(const RecognizerImage* image, const MrzLocatorOptions* options, PPRectangle* band,
+		int* found) {
+	MrzLocatorOptions defaults;
+	unsigned char* copy;
+	int* scores;
+	int imageWidth, imageHeight, width, height, top, bottom, left, right, y;
+	/* searched region in pixels */
+	int regionX = 0, regionY = 0, regionWidth, regionHeight;
+	float marginY, marginX, x0, y0, x1, y1;
+	RecognizerErrorStatus status;
+
+	if (image == NULL || band == NULL || found == NULL) return RECOGNIZER_ERROR_STATUS_POINTER_IS_NULL;
+	*found = 0;
+	if (options == NULL) {
+		mrzLocatorOptionsInit(&defaults);
+		options = &defaults;
+	}
+
+	status = recognizerImageGetWidth(image, &imageWidth);
+	if (status == RECOGNIZER_ERROR_STATUS_SUCCESS) status = recognizerImageGetHeight(image, &imageHeight);
+	if (status != RECOGNIZER_ERROR_STATUS_SUCCESS) return status;
+	if (imageWidth <= 0 || imageHeight <= 0) return RECOGNIZER_ERROR_STATUS_INVALID_TYPE;
+
+	regionWidth = imageWidth;
+	regionHeight = imageHeight;
+	if (options->roi != NULL) {
+		regionX = (int) (clampRelative(options->roi->x) * imageWidth);
+		regionY = (int) (clampRelative(options->roi->y) * imageHeight);
+		regionWidth = (int) (clampRelative(options->roi->x + options->roi->width) * imageWidth) - regionX;
+		regionHeight = (int) (clampRelative(options->roi->y + options->roi->height) * imageHeight) - regionY;
+		if (regionWidth <= 0 || regionHeight <= 0) return RECOGNIZER_ERROR_STATUS_INVALID_TYPE;
+	}
+
+	width = options->workWidth > 0 && options->workWidth < regionWidth ? options->workWidth : regionWidth;
+	height = (int) ((long) regionHeight * width / regionWidth);
+	if (height < 1) height = 1;
+
+	copy = (unsigned char*) malloc((size_t) width * height);
+	scores = (int*) malloc((size_t) height * sizeof(int));
+	if (copy == NULL || scores == NULL) {
+		status = RECOGNIZER_ERROR_STATUS_FAIL;
+	} else {
+		status = sampleImage(image, regionX, regionY, regionWidth, regionHeight, copy, width, height);
+	}
+
+	if (status == RECOGNIZER_ERROR_STATUS_SUCCESS) {
+		for (y = 0; y < height; ++y) {
+			scores[y] = countEdges(copy + (size_t) y * width, width, (unsigned char) options->edgeThreshold);
+		}
+		/* MRZ line has 30 to 44 characters, each giving several edges, over a large part of the document width */
+		if (findBand(scores, height, width / 10, &top, &bottom)) {
+			findExtent(copy, width, top, bottom, options->edgeThreshold, &left, &right);
+			if (right - left >= width / 4) {
+				marginY = (bottom - top) * options->margin;
+				marginX = (right - left) * options->margin / 2;
+				/* band relative to the region is clamped to it, then mapped to the whole image */
+				x0 = clampRelative((left - marginX) / width);
+				y0 = clampRelative((top - marginY) / height);
+				x1 = clampRelative((right + marginX) / width);
+				y1 = clampRelative((bottom + marginY) / height);
+				band->x = (regionX + x0 * regionWidth) / imageWidth;
+				band->y = (regionY + y0 * regionHeight) / imageHeight;
+				band->width = (x1 - x0) * regionWidth / imageWidth;
+				band->height = (y1 - y0) * regionHeight / imageHeight;
+				*found = 1;
+			}
+		}
+	}
+
+	free(copy);
+	free(scores);
+	return status;
+}
+
+RecognizerErrorStatus recognizeMrzCoarseToFine(const Recognizer* recognizer, RecognizerResultList** resultList,
+		const RecognizerImage* image, const RecognizeOptions* options, const MrzLocatorOptions* locatorOptions,
+		MrzLocalization* localized) {
+	RecognizeOptions bandOptions;
+	MrzLocatorOptions searchOptions;
+	PPRectangle band;
+	int found = 0;
+	RecognizerErrorStatus status;
+
+	if (localized != NULL) *localized = MRZ_LOCALIZATION_NONE;
+	if (resultList == NULL) return RECOGNIZER_ERROR_STATUS_POINTER_IS_NULL;
+	*resultList = NULL;
+
+	if (locatorOptions != NULL) {
+		searchOptions = *locatorOptions;
+	} else {
+		mrzLocatorOptionsInit(&searchOptions);
+	}
+	/* band is searched for inside the caller's ROI, so it replaces the ROI without widening it */
+	searchOptions.roi = options != NULL ? options->roi : NULL;
+	status = mrzLocate(image, &searchOptions, &band, &found);
+	if (status != RECOGNIZER_ERROR_STATUS_SUCCESS) return status;
+	if (!found) return recognizeWithOptions(recognizer, resultList, image, options);
+
+	if (options != NULL) {
+		bandOptions = *options;
+	} else {
+		recognizeOptionsInit(&bandOptions);
+	}
+	bandOptions.roi = &band;
+	status = recognizeWithOptions(recognizer, resultList, image, &bandOptions);
+	if (!searchOptions.retryWholeImage
+			|| (status == RECOGNIZER_ERROR_STATUS_SUCCESS && recognizeResultListQuality(*resultList) >= 2)) {
+		if (localized != NULL) *localized = MRZ_LOCALIZATION_BAND;
+		return status;
+	}
+
+	/* strongest band may be other text, e.g. the visual inspection zone, so the whole image is tried before giving up */
+	if (*resultList != NULL) recognizerResultListDelete(resultList);
+	if (localized != NULL) *localized = MRZ_LOCALIZATION_RETRIED;
+	return recognizeWithOptions(recognizer, resultList, image, options);
+}
@@ -0,0 +1,277 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "MultiDocument.h"
+#include "RecognizeOptions.h"
+#include "DemoUtil.h"
+
+/* Downscaled gray copy of the image on which documents are detected */
+typedef struct DetectionCopy {
+	unsigned char* pixels;
+	int width;
+	int height;
+	/* mean gray level, used to paint over detected documents */
+	unsigned char background;
+} DetectionCopy;
+
+/* Outcome of one detection pass */
+typedef struct Detection {
+	int found;
+	PPPoint points[4];
+	size_t numPoints;
+	PPSize imageSize;
+} Detection;
+
+/* detection collected on this thread. Callbacks have no user data parameter, so the detection is reachable only
+through thread local storage. */
+static __thread Detection* tlsDetection = NULL;
+
+static int detectionOnDetectedObject(const PPPoint* points, const size_t pointsSize, PPSize imageSize,
+		PPDetectionStatus detectionStatus) {
+	Detection* detection = tlsDetection;
+	size_t i;
+
+	if (detection == NULL || detection->found || points == NULL || pointsSize == 0
+			|| (detectionStatus & DETECTION_STATUS_SUCCESS) == 0) {
+		return 1;
+	}
+	detection->numPoints = pointsSize < 4 ? pointsSize : 4;
+	for (i = 0; i < detection->numPoints; ++i) detection->points[i] = points[i];
+	detection->imageSize = imageSize;
+	detection->found = 1;
+	/* only the location is needed, OCR of the downscaled copy would be wasted */
+	return 0;
+}
+
+static int detectionOnShouldStopRecognition() {
+	return tlsDetection != NULL && tlsDetection->found;
+}
+
+/* Makes gray copy of image downscaled by an integer factor with area averaging. Returns the factor, or zero on error. */
+static int makeDetectionCopy(const RecognizerImage* image, int maxDimension, DetectionCopy* copy) {
+	const unsigned char* src;
+	void* data;
+	int width, height, bytesPerRow, channels, factor, longer, x, y, dx, dy;
+	unsigned long total = 0;
+	RawImageType type;
+
+	if (recognizerImageGetRawBytes(image, &data) != RECOGNIZER_ERROR_STATUS_SUCCESS
+			|| recognizerImageGetWidth(image, &width) != RECOGNIZER_ERROR_STATUS_SUCCESS
+			|| recognizerImageGetHeight(image, &height) != RECOGNIZER_ERROR_STATUS_SUCCESS
+			|| recognizerImageGetBytesPerRow(image, &bytesPerRow) != RECOGNIZER_ERROR_STATUS_SUCCESS
+			|| recognizerImageGetRawImageType(image, &type) != RECOGNIZER_ERROR_STATUS_SUCCESS
+			|| width <= 0 || height <= 0) {
+		return 0;
+	}
+	src = (const unsigned char*) data;
+	channels = demoBytesPerPixel(type);
+
+	longer = width > height ? width : height;
+	factor = maxDimension > 0 ? (longer + maxDimension - 1) / maxDimension : 1;
+	if (factor < 1) factor = 1;
+	copy->width = width / factor > 0 ? width / factor : 1;
+	copy->height = height / factor > 0 ? height / factor : 1;
+	copy->pixels = (unsigned char*) malloc((size_t) copy->width * copy->height);
+	if (copy->pixels == NULL) return 0;
+
+	for (y = 0; y < copy->height; ++y) {
+		for (x = 0; x < copy->width; ++x) {
+			unsigned int sum = 0;
+			for (dy = 0; dy < factor && y * factor + dy < height; ++dy) {
+				for (dx = 0; dx < factor && x * factor + dx < width; ++dx) {
+					sum += demoLuma(src + (size_t) (y * factor + dy) * bytesPerRow + (size_t) (x * factor + dx) * channels, type);
+				}
+			}
+			sum /= (unsigned int) (factor * factor);
+			copy->pixels[(size_t) y * copy->width + x] = (unsigned char) sum;
+			total += sum;
+		}
+	}
+	copy->background = (unsigned char) (total / ((unsigned long) copy->width * copy->height));
+	return factor;
+}
+
+/* Runs one detection pass on the copy. Returns non-zero if a document was detected. */
+static int detectDocument(const Recognizer* recognizer, const DetectionCopy* copy, double deadlineMs,
+		Detection* detection) {
+	RecognizerImage* image = NULL;
+	RecognizerResultList* resultList = NULL;
+	RecognizerCallback callback;
+	RecognizeOptions options;
+
+	memset(detection, 0, sizeof(*detection));
+	if (recognizerImageCreateFromRawImage(&image, copy->pixels, copy->width, copy->height, copy->width,
+			RAW_IMAGE_TYPE_GRAY) != RECOGNIZER_ERROR_STATUS_SUCCESS) {
+		return 0;
+	}
+
+	memset(&callback, 0, sizeof(callback));
+	callback.onDetectedObject = detectionOnDetectedObject;
+	callback.onShouldStopRecognition = detectionOnShouldStopRecognition;
+	recognizeOptionsInit(&options);
+	options.deadlineMs = deadlineMs;
+	options.callback = &callback;
+
+	tlsDetection = detection;
+	recognizeWithOptions(recognizer, &resultList, image, &options);
+	tlsDetection = NULL;
+
+	if (resultList != NULL) recognizerResultListDelete(&resultList);
+	recognizerImageDelete(&image);
+	if (detection->imageSize.width <= 0 || detection->imageSize.height <= 0) {
+		detection->imageSize.width = copy->width;
+		detection->imageSize.height = copy->height;
+	}
+	return detection->found;
+}
+
+/* Bounding box of detected points in pixels of the copy, extended by margin and clamped to the copy */
+static void detectionBounds(const Detection* detection, const DetectionCopy* copy, float margin, PPRectangle* box) {
+	float scaleX = (float) copy->width / detection->imageSize.width;
+	float scaleY = (float) copy->height / detection->imageSize.height;
+	float left = (float) detection->points[0].x, right = left;
+	float top = (float) detection->points[0].y, bottom = top;
+	float marginX, marginY;
+	size_t i;
+
+	for (i = 1; i < detection->numPoints; ++i) {
+		if (detection->points[i].x < left) left = (float) detection->points[i].x;
+		if (detection->points[i].x > right) right = (float) detection->points[i].x;
+		if (detection->points[i].y < top) top = (float) detection->points[i].y;
+		if (detection->points[i].y > bottom) bottom = (float) detection->points[i].y;
+	}
+	left *= scaleX;
+	right *= scaleX;
+	top *= scaleY;
+	bottom *= scaleY;
+	marginX = (right - left) * margin;
+	marginY = (bottom - top) * margin;
+	left = left - marginX < 0.f ? 0.f : left - marginX;
+	top = top - marginY < 0.f ? 0.f : top - marginY;
+	right = right + marginX > copy->width ? (float) copy->width : right + marginX;
+	bottom = bottom + marginY > copy->height ? (float) copy->height : bottom + marginY;
+
+	box->x = left;
+	box->y = top;
+	box->width = right - left;
+	box->height = bottom - top;
+}
+
+static void paintOver(DetectionCopy* copy, const PPRectangle* box) {
+	int x = (int) box->x;
+	int y = (int) box->y;
+	int right = (int) (box->x + box->width + 0.5f);
+	int bottom = (int) (box->y + box->height + 0.5f);
+
+	if (right > copy->width) right = copy->width;
+	for (; y < bottom && y < copy->height; ++y) {
+		memset(copy->pixels + (size_t) y * copy->width + x, copy->background, (size_t) (right - x));
+	}
+}
+
+/* Non-zero if center of box lies in one of previous boxes, i.e. painting over did not hide the document */
+static int isRepeated(const PPRectangle* box, const PPRectangle* boxes, size_t numBoxes) {
+	float cx = box->x + box->width / 2;
+	float cy = box->y + box->height / 2;
+	size_t i;
+
+	for (i = 0; i < numBoxes; ++i) {
+		if (cx >= boxes[i].x && cx <= boxes[i].x + boxes[i].width && cy >= boxes[i].y
+				&& cy <= boxes[i].y + boxes[i].height) {
+			return 1;
+		}
+	}
+	return 0;
+}
+
+/* Detects documents one by one, storing their quads and regions in pixels of the image */
+static void detectDocuments(const Recognizer* recognizer, DetectionCopy* copy, int factor,
+		const MultiDocumentOptions* options, MultiDocumentResults* results) {
+	Detection detection;
+	PPRectangle box;
+	size_t n = 0, i;
+
+	while (n < (size_t) options->maxDocuments && detectDocument(recognizer, copy, options->deadlineMs, &detection)) {
+		detectionBounds(&detection, copy, options->margin, &box);
+		if (box.width < 1.f || box.height < 1.f || isRepeated(&box, results->regions, n)) break;
+		paintOver(copy, &box);
+
+		/* regions are kept in copy pixels until detection is over, so that isRepeated can compare them */
+		results->regions[n] = box;
+		for (i = 0; i < 4; ++i) {
+			const PPPoint* p = &detection.points[i < detection.numPoints ? i : detection.numPoints - 1];
+			results->quads[4 * n + i].x = (int) ((float) p->x * copy->width / detection.imageSize.width * factor);
+			results->quads[4 * n + i].y = (int) ((float) p->y * copy->height / detection.imageSize.height * factor);
+		}
+		++n;
+	}
+
+	for (i = 0; i < n; ++i) {
+		results->regions[i].x *= factor;
+		results->regions[i].y *= factor;
+		results->regions[i].width *= factor;
+		results->regions[i].height *= factor;
+	}
+	results->numDocuments = n;
+}
+
+void multiDocumentOptionsInit(MultiDocumentOptions* options) {
+	options->maxDocuments = 8;
+	options->detectionDimension = 1024;
+	options->margin = 0.1f;
+	options->deadlineMs = 0.0;
+}
+
+RecognizerErrorStatus recognizeMultiDocument(const Recognizer* const* recognizers, size_t numRecognizers,
+		const RecognizerImage* image, const MultiDocumentOptions* options, MultiDocumentResults* results) {
+	MultiDocumentOptions defaults;
+	DetectionCopy copy;
+	int factor, width, height;
+	size_t maxDocuments;
+
+	if (results == NULL) return RECOGNIZER_ERROR_STATUS_POINTER_IS_NULL;
+	memset(results, 0, sizeof(*results));
+	if (recognizers == NULL || numRecognizers == 0 || image == NULL) return RECOGNIZER_ERROR_STATUS_POINTER_IS_NULL;
+
+	if (options == NULL) {
+		multiDocumentOptionsInit(&defaults);
+		options = &defaults;
+	}
+
+	maxDocuments = options->maxDocuments > 0 ? (size_t) options->maxDocuments : 1;
+	results->quads = (PPPoint*) malloc(4 * maxDocuments * sizeof(PPPoint));
+	results->regions = (PPRectangle*) malloc(maxDocuments * sizeof(PPRectangle));
+	if (results->quads == NULL || results->regions == NULL) return RECOGNIZER_ERROR_STATUS_FAIL;
+
+	memset(&copy, 0, sizeof(copy));
+	factor = makeDetectionCopy(image, options->detectionDimension, &copy);
+	if (factor == 0) return RECOGNIZER_ERROR_STATUS_FAIL;
+	detectDocuments(recognizers[0], &copy, factor, options, results);
+	free(copy.pixels);
+
+	if (results->numDocuments == 0) {
+		recognizerImageGetWidth(image, &width);
+		recognizerImageGetHeight(image, &height);
+		results->regions[0].x = 0.f;
+		results->regions[0].y = 0.f;
+		results->regions[0].width = (float) width;
+		results->regions[0].height = (float) height;
+		memset(results->quads, 0, 4 * sizeof(PPPoint));
+		results->quads[1].x = results->quads[2].x = width;
+		results->quads[2].y = results->quads[3].y = height;
+		results->numDocuments = 1;
+	}
+
+	return recognizeRegions(recognizers, numRecognizers, image, results->regions, results->numDocuments,
+			options->deadlineMs, &results->tiled);
+}
+
+RecognizerErrorStatus multiDocumentResultsTerm(MultiDocumentResults* results) {
+	if (results == NULL) return RECOGNIZER_ERROR_STATUS_POINTER_IS_NULL;
+
+	tiledResultsTerm(&results->tiled);
+	free(results->quads);
+	free(results->regions);
+	memset(results, 0, sizeof(*results));
+	return RECOGNIZER_ERROR_STATUS_SUCCESS;
+}
@@ -0,0 +1,83 @@
+#ifndef MULTIDOCUMENT_H_
+#define MULTIDOCUMENT_H_
+
+#include <stddef.h>
+
+#include "RecognizerApi.h"
+#include "TiledRecognition.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Options of multi-document recognition.
+ */
+typedef struct MultiDocumentOptions {
+	/* maximum number of documents searched for in one image */
+	int maxDocuments;
+	/* longer side of the downscaled copy on which documents are detected, in pixels */
+	int detectionDimension;
+	/* each side of a detected document is extended by this fraction of its size before recognition, so that
+	imprecise detection on the downscaled copy does not cut the document */
+	float margin;
+	/* absolute deadline in milliseconds of recognizeMonotonicMs() clock, shared by detection and recognition.
+	Zero disables the deadline. */
+	double deadlineMs;
+} MultiDocumentOptions;
+
+/**
+ * Documents found in an image and their results.
+ */
+typedef struct MultiDocumentResults {
+	/* results of all documents; tiled.tileIndices gives the document of each result */
+	TiledResults tiled;
+	/* four corners of each document in pixels of the image, as reported by detection */
+	PPPoint* quads;
+	/* region of each document which was recognized, in pixels of the image */
+	PPRectangle* regions;
+	size_t numDocuments;
+} MultiDocumentResults;
+
+/**
+ * Initializes options for up to 8 documents detected on a 1024 pixel copy with 10% margin and no deadline.
+ *
+ *  @param options options to initialize
+ */
+void multiDocumentOptionsInit(MultiDocumentOptions* options);
+
+/**
+ * Recognizes several documents placed on one image, e.g. ID cards on a flatbed scan. The library reports at most one
+ * document per recognition, so documents are first detected one by one on a downscaled gray copy of the image: after
+ * each detection the document is painted over and detection is repeated, until nothing more is found. Recognition of
+ * the copy is stopped as soon as the document is detected, so detection passes do not pay for OCR. The detected
+ * documents are then recognized in parallel at full resolution with recognizeRegions, one thread per recognizer.
+ *
+ * If no document is detected, the whole image is recognized as a single document.
+ *
+ *  @param recognizers      recognizers, one per thread. All should be created with the same settings. The first one
+ *                          is also used for detection.
+ *  @param numRecognizers   number of recognizers
+ *  @param image            image to recognize
+ *  @param options          options, or NULL for defaults
+ *  @param results          destination. Must be released with multiDocumentResultsTerm, also on failure.
+ *
+ *  @return status of the operation
+ */
+RecognizerErrorStatus recognizeMultiDocument(const Recognizer* const* recognizers, size_t numRecognizers,
+		const RecognizerImage* image, const MultiDocumentOptions* options, MultiDocumentResults* results);
+
+/**
+ * Deletes result lists of all documents and frees taken resources.
+ *
+ *  @param results results
+ *
+ *  @return status of the operation
+ */
+RecognizerErrorStatus multiDocumentResultsTerm(MultiDocumentResults* results);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,111 @@
+#ifndef RECOGNIZERARENA_H_
+#define RECOGNIZERARENA_H_
+
+#include <stddef.h>
+
+#include "RecognizerApi.h"
+#include "ResultSerializer.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Bump allocator with a fixed byte budget, reset once per request. Everything allocated from arena is released
+ * at once by recognizerArenaReset, without touching the heap. Arena is not thread safe, use one per thread.
+ */
+typedef struct RecognizerArena {
+	/* memory of the arena */
+	unsigned char* base;
+	/* byte budget */
+	size_t capacity;
+	/* bytes allocated since last reset */
+	size_t used;
+	/* largest number of bytes allocated between two resets */
+	size_t highWater;
+	/* number of allocations which did not fit into the budget */
+	size_t numFailed;
+	/* number of resets */
+	size_t numResets;
+} RecognizerArena;
+
+/**
+ * Copy of image pixels allocated from arena.
+ */
+typedef struct RecognizerArenaImage {
+	const void* data;
+	int width;
+	int height;
+	int bytesPerRow;
+	RawImageType type;
+} RecognizerArenaImage;
+
+/**
+ * Allocates memory of the arena. This is the only heap allocation arena makes.
+ *
+ *  @param arena    arena to initialize
+ *  @param capacity byte budget of the arena
+ *
+ *  @return status of the operation
+ */
+RecognizerErrorStatus recognizerArenaInit(RecognizerArena* arena, size_t capacity);
+
+/**
+ * Allocates size bytes aligned to 16 bytes.
+ *
+ *  @param arena arena
+ *  @param size  number of bytes
+ *
+ *  @return allocated memory or NULL if budget is exceeded
+ */
+void* recognizerArenaAlloc(RecognizerArena* arena, size_t size);
+
+/**
+ * Releases everything allocated from arena in O(1). Statistics are kept.
+ *
+ *  @param arena arena
+ */
+void recognizerArenaReset(RecognizerArena* arena);
+
+/**
+ * Moves result list into arena: results are serialized into arena memory and the library result list is deleted
+ * right away, so the heap memory of the library is returned as early as possible and the copy is released by the
+ * next reset.
+ *
+ *  @param arena        arena
+ *  @param resultList   result list to move. Deleted and set to NULL on success.
+ *  @param view         destination view of serialized results
+ *
+ *  @return status of the operation. RECOGNIZER_ERROR_STATUS_FAIL if budget is exceeded, in which case result list
+ *          is left untouched.
+ */
+RecognizerErrorStatus recognizerArenaAdoptResultList(RecognizerArena* arena, RecognizerResultList** resultList,
+		SerializedResultList* view);
+
+/**
+ * Copies pixels of image into arena. Intended for images given to onShowImage, which are deleted after the
+ * callback returns.
+ *
+ *  @param arena    arena
+ *  @param image    image to copy
+ *  @param copy     destination
+ *
+ *  @return status of the operation. RECOGNIZER_ERROR_STATUS_FAIL if budget is exceeded.
+ */
+RecognizerErrorStatus recognizerArenaCopyImage(RecognizerArena* arena, const RecognizerImage* image,
+		RecognizerArenaImage* copy);
+
+/**
+ * Frees memory of the arena.
+ *
+ *  @param arena arena
+ *
+ *  @return status of the operation
+ */
+RecognizerErrorStatus recognizerArenaTerm(RecognizerArena* arena);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,215 @@
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "RecognizerClient.h"
+#include "RecognizerdProtocol.h"
+
+struct RecognizerClient {
+	/* -1 once the connection is out of step with the daemon */
+	int socket;
+	/* shared memory holding pixels, sent to daemon with every request */
+	int memfd;
+	void* pixels;
+	size_t pixelsSize;
+	/* serialized results of the last request */
+	unsigned char* reply;
+	size_t replyCapacity;
+};
+
+static int readFully(int fd, void* data, size_t size) {
+	unsigned char* p = (unsigned char*) data;
+	while (size > 0) {
+		ssize_t n = read(fd, p, size);
+		if (n < 0 && errno == EINTR) continue;
+		if (n <= 0) return 0;
+		p += n;
+		size -= (size_t) n;
+	}
+	return 1;
+}
+
+/* Reads and drops size bytes, so that the next reply is read from its start */
+static int discardFully(int fd, size_t size) {
+	unsigned char buffer[4096];
+
+	while (size > 0) {
+		size_t n = size < sizeof(buffer) ? size : sizeof(buffer);
+		if (!readFully(fd, buffer, n)) return 0;
+		size -= n;
+	}
+	return 1;
+}
+
+/* Closes connection after a partial exchange; bytes left in the stream would be read as the next reply */
+static RecognizerErrorStatus breakConnection(RecognizerClient* client) {
+	close(client->socket);
+	client->socket = -1;
+	return RECOGNIZER_ERROR_STATUS_FAIL;
+}
+
+/* Sends request with memfd attached as SCM_RIGHTS */
+static int sendRequest(int socket, const RecognizerdRequest* request, int fd) {
+	struct msghdr message;
+	struct iovec iov;
+	struct cmsghdr* cmsg;
+	union {
+		char buffer[CMSG_SPACE(sizeof(int))];
+		struct cmsghdr align;
+	} control;
+	ssize_t n;
+
+	memset(&message, 0, sizeof(message));
+	memset(&control, 0, sizeof(control));
+	iov.iov_base = (void*) request;
+	iov.iov_len = sizeof(*request);
+	message.msg_iov = &iov;
+	message.msg_iovlen = 1;
+	message.msg_control = control.buffer;
+	message.msg_controllen = sizeof(control.buffer);
+	cmsg = CMSG_FIRSTHDR(&message);
+	cmsg->cmsg_level = SOL_SOCKET;
+	cmsg->cmsg_type = SCM_RIGHTS;
+	cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+	memcpy(CMSG_DATA(cmsg), &fd, sizeof(int));
+
+	do {
+		n = sendmsg(socket, &message, MSG_NOSIGNAL);
+	} while (n < 0 && errno == EINTR);
+	/* the request is a few bytes, a stream socket does not split it */
+	return n == (ssize_t) sizeof(*request);
+}
+
+RecognizerErrorStatus recognizerClientCreate(RecognizerClient** client, const char* socketPath) {
+	struct sockaddr_un address;
+	RecognizerClient* c;
+
+	if (client == NULL) return RECOGNIZER_ERROR_STATUS_POINTER_IS_NULL;
+	*client = NULL;
+	if (socketPath == NULL) socketPath = RECOGNIZERD_DEFAULT_SOCKET;
+	if (strlen(socketPath) >= sizeof(address.sun_path)) return RECOGNIZER_ERROR_STATUS_FAIL;
+
+	c = (RecognizerClient*) calloc(1, sizeof(RecognizerClient));
+	if (c == NULL) return RECOGNIZER_ERROR_STATUS_FAIL;
+	c->memfd = -1;
+
+	c->socket = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+	memset(&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+	strcpy(address.sun_path, socketPath);
+	if (c->socket < 0 || connect(c->socket, (struct sockaddr*) &address, sizeof(address)) != 0) {
+		if (c->socket >= 0) close(c->socket);
+		free(c);
+		return RECOGNIZER_ERROR_STATUS_FAIL;
+	}
+
+	*client = c;
+	return RECOGNIZER_ERROR_STATUS_SUCCESS;
+}
+
+RecognizerErrorStatus recognizerClientGetImageBuffer(RecognizerClient* client, size_t size, void** pixels) {
+	if (client == NULL || pixels == NULL) return RECOGNIZER_ERROR_STATUS_POINTER_IS_NULL;
+
+	/* buffer only grows, so steady streams of same sized images never remap. A sealed memfd cannot be resized, so
+	growing takes a new one. */
+	if (size > client->pixelsSize) {
+		if (client->pixels != NULL) munmap(client->pixels, client->pixelsSize);
+		if (client->memfd >= 0) close(client->memfd);
+		client->pixels = NULL;
+		client->pixelsSize = 0;
+
+		client->memfd = memfd_create("recognizer-client", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+		if (client->memfd < 0) return RECOGNIZER_ERROR_STATUS_FAIL;
+		/* daemon accepts only memfds whose size is sealed, so that it never reads past a shrunk file */
+		if (ftruncate(client->memfd, (off_t) size) != 0
+				|| fcntl(client->memfd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL) != 0) {
+			close(client->memfd);
+			client->memfd = -1;
+			return RECOGNIZER_ERROR_STATUS_FAIL;
+		}
+		client->pixels = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, client->memfd, 0);
+		if (client->pixels == MAP_FAILED) {
+			client->pixels = NULL;
+			return RECOGNIZER_ERROR_STATUS_FAIL;
+		}
+		client->pixelsSize = size;
+	}
+
+	*pixels = client->pixels;
+	return RECOGNIZER_ERROR_STATUS_SUCCESS;
+}
+
+RecognizerErrorStatus recognizerClientRecognize(RecognizerClient* client, int width, int height, size_t bytesPerRow,
+		RawImageType rawType, int imageIsVideoFrame, SerializedResultList* results) {
+	RecognizerdRequest request;
+	RecognizerdReply reply;
+
+	if (client == NULL || results == NULL) return RECOGNIZER_ERROR_STATUS_POINTER_IS_NULL;
+	if (client->pixels == NULL) return RECOGNIZER_ERROR_STATUS_POINTER_IS_NULL;
+	if (client->socket < 0) return RECOGNIZER_ERROR_STATUS_FAIL;
+
+	request.magic = RECOGNIZERD_REQUEST_MAGIC;
+	request.width = (unsigned int) width;
+	request.height = (unsigned int) height;
+	request.bytesPerRow = (unsigned int) bytesPerRow;
+	request.rawType = (unsigned int) rawType;
+	request.imageIsVideoFrame = (unsigned int) imageIsVideoFrame;
+
+	if (!sendRequest(client->socket, &request, client->memfd)) return breakConnection(client);
+	if (!readFully(client->socket, &reply, sizeof(reply))) return breakConnection(client);
+
+	if (reply.size > client->replyCapacity) {
+		unsigned char* grown = (unsigned char*) realloc(client->reply, reply.size);
+		if (grown == NULL) {
+			/* reply is dropped, the connection stays usable for the next request */
+			if (!discardFully(client->socket, reply.size)) return breakConnection(client);
+			return RECOGNIZER_ERROR_STATUS_FAIL;
+		}
+		client->reply = grown;
+		client->replyCapacity = reply.size;
+	}
+	if (reply.size > 0 && !readFully(client->socket, client->reply, reply.size)) return breakConnection(client);
+
+	if (reply.status != RECOGNIZER_ERROR_STATUS_SUCCESS) return (RecognizerErrorStatus) reply.status;
+	return serializedResultListOpen(results, client->reply, reply.size);
+}
+
+RecognizerErrorStatus recognizerClientRecognizeRawImage(RecognizerClient* client, const void* pixels, int width, int height,
+		size_t bytesPerRow, RawImageType rawType, int imageIsVideoFrame, SerializedResultList* results) {
+	RecognizerErrorStatus status;
+	size_t size;
+	void* buffer;
+
+	if (client == NULL || pixels == NULL) return RECOGNIZER_ERROR_STATUS_POINTER_IS_NULL;
+
+	size = bytesPerRow * (size_t) height;
+	/* NV21 has interleaved chroma plane of half height after the luma plane */
+	if (rawType == RAW_IMAGE_TYPE_NV21) size += size / 2;
+
+	status = recognizerClientGetImageBuffer(client, size, &buffer);
+	if (status != RECOGNIZER_ERROR_STATUS_SUCCESS) return status;
+	memcpy(buffer, pixels, size);
+	return recognizerClientRecognize(client, width, height, bytesPerRow, rawType, imageIsVideoFrame, results);
+}
+
+RecognizerErrorStatus recognizerClientDelete(RecognizerClient** client) {
+	RecognizerClient* c;
+
+	if (client == NULL || *client == NULL) return RECOGNIZER_ERROR_STATUS_POINTER_IS_NULL;
+
+	c = *client;
+	if (c->socket >= 0) close(c->socket);
+	if (c->pixels != NULL) munmap(c->pixels, c->pixelsSize);
+	if (c->memfd >= 0) close(c->memfd);
+	free(c->reply);
+	free(c);
+	*client = NULL;
+	return RECOGNIZER_ERROR_STATUS_SUCCESS;
+}
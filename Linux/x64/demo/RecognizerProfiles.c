@@ -0,0 +1,124 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "RecognizerProfiles.h"
+
+void recognizerProfileInit(RecognizerProfile* profile) {
+	/* zero everything, including padding, so that profiles can be compared with memcmp */
+	memset(profile, 0, sizeof(*profile));
+	/* match the default of ZXingSettings C++ constructor */
+	profile->zxing.slowThoroughScan = 1;
+	profile->outputMultipleResults = 1;
+}
+
+int recognizerProfileParseTypes(RecognizerProfile* profile, const char* types) {
+	const char* p = types;
+
+	while (*p != '\0') {
+		size_t length = strcspn(p, ",");
+		if (length == 4 && strncmp(p, "mrtd", 4) == 0) profile->useMRTD = 1;
+		else if (length == 4 && strncmp(p, "usdl", 4) == 0) profile->useUsdl = 1;
+		else if (length == 6 && strncmp(p, "pdf417", 6) == 0) profile->usePdf417 = 1;
+		else if (length == 5 && strncmp(p, "zxing", 5) == 0) profile->useZXing = 1;
+		else if (length == 10 && strncmp(p, "bardecoder", 10) == 0) profile->useBarDecoder = 1;
+		else if (length == 5 && strncmp(p, "mykad", 5) == 0) profile->useMyKad = 1;
+		else return 0;
+		p += length;
+		if (*p == ',') ++p;
+	}
+	return 1;
+}
+
+RecognizerErrorStatus recognizerProfileApply(const RecognizerProfile* profile, RecognizerSettings* settings) {
+	RecognizerErrorStatus status;
+
+	if (profile == NULL || settings == NULL) return RECOGNIZER_ERROR_STATUS_POINTER_IS_NULL;
+
+	status = recognizerSettingsSetPdf417Settings(settings, profile->usePdf417 ? &profile->pdf417 : NULL);
+	if (status != RECOGNIZER_ERROR_STATUS_SUCCESS) return status;
+	status = recognizerSettingsSetUsdlSettings(settings, profile->useUsdl ? &profile->usdl : NULL);
+	if (status != RECOGNIZER_ERROR_STATUS_SUCCESS) return status;
+	status = recognizerSettingsSetBarDecoderSettings(settings, profile->useBarDecoder ? &profile->barDecoder : NULL);
+	if (status != RECOGNIZER_ERROR_STATUS_SUCCESS) return status;
+	status = recognizerSettingsSetZXingSettings(settings, profile->useZXing ? &profile->zxing : NULL);
+	if (status != RECOGNIZER_ERROR_STATUS_SUCCESS) return status;
+	status = recognizerSettingsSetMRTDSettings(settings, profile->useMRTD ? &profile->mrtd : NULL);
+	if (status != RECOGNIZER_ERROR_STATUS_SUCCESS) return status;
+	status = recognizerSettingsSetMyKadSettings(settings, profile->useMyKad ? &profile->myKad : NULL);
+	if (status != RECOGNIZER_ERROR_STATUS_SUCCESS) return status;
+	return recognizerSettingsSetOutputMultipleResults(settings, profile->outputMultipleResults);
+}
+
+RecognizerErrorStatus recognizerProfileSwitch(Recognizer* recognizer, RecognizerSettings* settings,
+		RecognizerProfile* current, const RecognizerProfile* next) {
+	RecognizerErrorStatus status;
+
+	if (recognizer == NULL || current == NULL || next == NULL) return RECOGNIZER_ERROR_STATUS_POINTER_IS_NULL;
+
+	if (memcmp(current, next, sizeof(*current)) == 0) return RECOGNIZER_ERROR_STATUS_SUCCESS;
+
+	status = recognizerProfileApply(next, settings);
+	if (status != RECOGNIZER_ERROR_STATUS_SUCCESS) return status;
+	status = recognizerUpdateSettings(recognizer, settings);
+	if (status != RECOGNIZER_ERROR_STATUS_SUCCESS) return status;
+
+	*current = *next;
+	return RECOGNIZER_ERROR_STATUS_SUCCESS;
+}
+
+RecognizerErrorStatus recognizerProfileCacheInit(RecognizerProfileCache* cache, RecognizerSettings* settings,
+		const RecognizerProfile* profiles, size_t numProfiles) {
+	RecognizerErrorStatus status;
+	size_t i;
+
+	if (cache == NULL || settings == NULL || profiles == NULL) return RECOGNIZER_ERROR_STATUS_POINTER_IS_NULL;
+
+	cache->settings = settings;
+	cache->numProfiles = 0;
+	cache->profiles = (RecognizerProfile*) malloc(numProfiles * sizeof(RecognizerProfile));
+	cache->recognizers = (Recognizer**) calloc(numProfiles, sizeof(Recognizer*));
+	if (cache->profiles == NULL || cache->recognizers == NULL) {
+		recognizerProfileCacheTerm(cache);
+		return RECOGNIZER_ERROR_STATUS_FAIL;
+	}
+
+	for (i = 0; i < numProfiles; ++i) {
+		cache->profiles[i] = profiles[i];
+		status = recognizerProfileApply(&profiles[i], settings);
+		if (status == RECOGNIZER_ERROR_STATUS_SUCCESS) {
+			status = recognizerCreate(&cache->recognizers[i], settings);
+		}
+		if (status != RECOGNIZER_ERROR_STATUS_SUCCESS) {
+			recognizerProfileCacheTerm(cache);
+			return status;
+		}
+		cache->numProfiles = i + 1;
+	}
+	return RECOGNIZER_ERROR_STATUS_SUCCESS;
+}
+
+RecognizerErrorStatus recognizerProfileCacheGet(const RecognizerProfileCache* cache, size_t index, const Recognizer** recognizer) {
+	if (cache == NULL || recognizer == NULL) return RECOGNIZER_ERROR_STATUS_POINTER_IS_NULL;
+	if (index >= cache->numProfiles) {
+		*recognizer = NULL;
+		return RECOGNIZER_ERROR_STATUS_INDEX_OUT_OF_RANGE;
+	}
+	*recognizer = cache->recognizers[index];
+	return RECOGNIZER_ERROR_STATUS_SUCCESS;
+}
+
+RecognizerErrorStatus recognizerProfileCacheTerm(RecognizerProfileCache* cache) {
+	size_t i;
+
+	if (cache == NULL) return RECOGNIZER_ERROR_STATUS_POINTER_IS_NULL;
+
+	for (i = 0; i < cache->numProfiles; ++i) {
+		recognizerDelete(&cache->recognizers[i]);
+	}
+	free(cache->recognizers);
+	free(cache->profiles);
+	cache->recognizers = NULL;
+	cache->profiles = NULL;
+	cache->numProfiles = 0;
+	return RECOGNIZER_ERROR_STATUS_SUCCESS;
+}
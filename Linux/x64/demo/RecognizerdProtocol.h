@@ -0,0 +1,53 @@
+#ifndef RECOGNIZERDPROTOCOL_H_
+#define RECOGNIZERDPROTOCOL_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Protocol between recognizerd and RecognizerClient over a Unix domain stream socket.
+ *
+ * Client sends RecognizerdRequest together with a memfd holding the pixels as SCM_RIGHTS ancillary data, so pixels
+ * are never copied through the socket. Daemon answers with RecognizerdReply followed by RecognizerdReply::size bytes
+ * of result list serialized by resultListSerialize. The memfd must carry F_SEAL_SHRINK and F_SEAL_GROW, so that it
+ * cannot be resized while the daemon reads it; other memfds are rejected with RECOGNIZER_ERROR_STATUS_INVALID_TYPE,
+ * as are requests whose bytesPerRow is less than width times bytes per pixel. Both sides run on the same host, so
+ * fields are in native byte order. All fields are 32 bit, so 32-bit and 64-bit builds can talk to each other.
+ */
+
+/** Socket used when none is given */
+#define RECOGNIZERD_DEFAULT_SOCKET "/tmp/recognizerd.sock"
+
+/** Value of RecognizerdRequest::magic, "RQD1" */
+#define RECOGNIZERD_REQUEST_MAGIC 0x31445152u
+
+/**
+ * Recognition request. Pixels start at offset zero of the memfd sent with the request.
+ */
+typedef struct RecognizerdRequest {
+	unsigned int magic;
+	unsigned int width;
+	unsigned int height;
+	unsigned int bytesPerRow;
+	/* RawImageType */
+	unsigned int rawType;
+	/* non-zero if image is a video frame */
+	unsigned int imageIsVideoFrame;
+} RecognizerdRequest;
+
+/**
+ * Reply to recognition request.
+ */
+typedef struct RecognizerdReply {
+	/* RecognizerErrorStatus of the recognition */
+	unsigned int status;
+	/* number of bytes of serialized result list following the reply, zero if status is not success */
+	unsigned int size;
+} RecognizerdReply;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,304 @@
+#include <string.h>
+
+#include "ResultSerializer.h"
+#include "MRTDFields.h"
+#include "USDLFields.h"
+
+#define HEADER_SIZE 16
+#define RECORD_HEADER_SIZE 12
+#define FIELD_HEADER_SIZE 8
+
+/* Bounds checked writer. Position keeps advancing past capacity so that required size can be reported. */
+typedef struct Writer {
+	unsigned char* buffer;
+	size_t capacity;
+	size_t position;
+} Writer;
+
+typedef RecognizerErrorStatus (PP_CALL *StringGetter)(const RecognizerResult* result, const char** dst);
+typedef RecognizerErrorStatus (PP_CALL *BinaryGetter)(RecognizerResult* result, const void** dst, size_t* size);
+
+static void putU32At(Writer* w, size_t position, unsigned long value) {
+	if (position + 4 <= w->capacity) {
+		w->buffer[position] = (unsigned char) (value & 0xFF);
+		w->buffer[position + 1] = (unsigned char) ((value >> 8) & 0xFF);
+		w->buffer[position + 2] = (unsigned char) ((value >> 16) & 0xFF);
+		w->buffer[position + 3] = (unsigned char) ((value >> 24) & 0xFF);
+	}
+}
+
+static void putU16At(Writer* w, size_t position, unsigned int value) {
+	if (position + 2 <= w->capacity) {
+		w->buffer[position] = (unsigned char) (value & 0xFF);
+		w->buffer[position + 1] = (unsigned char) ((value >> 8) & 0xFF);
+	}
+}
+
+static void putBytes(Writer* w, const void* data, size_t size) {
+	if (w->position + size <= w->capacity && size > 0) {
+		memcpy(w->buffer + w->position, data, size);
+	}
+	w->position += size;
+}
+
+static void putU32(Writer* w, unsigned long value) {
+	putU32At(w, w->position, value);
+	w->position += 4;
+}
+
+static void putU16(Writer* w, unsigned int value) {
+	putU16At(w, w->position, value);
+	w->position += 2;
+}
+
+/* Writes one field, zero-terminated and padded to 4 bytes. Returns 1 so that callers can count fields. */
+static int putField(Writer* w, unsigned int id, const void* data, size_t length) {
+	static const unsigned char zeros[4] = { 0, 0, 0, 0 };
+	size_t padded = (length + 1 + 3) & ~(size_t) 3;
+
+	putU16(w, id);
+	putU16(w, 0);
+	putU32(w, (unsigned long) length);
+	putBytes(w, data, length);
+	putBytes(w, zeros, padded - length);
+	return 1;
+}
+
+static int putStringField(Writer* w, unsigned int id, const RecognizerResult* result, StringGetter getter) {
+	const char* value = NULL;
+	if (getter(result, &value) != RECOGNIZER_ERROR_STATUS_SUCCESS || value == NULL) return 0;
+	return putField(w, id, value, strlen(value));
+}
+
+static int putBinaryField(Writer* w, unsigned int id, RecognizerResult* result, BinaryGetter getter) {
+	const void* value = NULL;
+	size_t size = 0;
+	if (getter(result, &value, &size) != RECOGNIZER_ERROR_STATUS_SUCCESS || value == NULL) return 0;
+	return putField(w, id, value, size);
+}
+
+static int putViewField(Writer* w, unsigned int id, StringView view) {
+	if (view.length == 0) return 0;
+	return putField(w, id, view.data, view.length);
+}
+
+static SerializedResultKind resultKind(const RecognizerResult* result) {
+	int is = 0;
+
+	/* USDL is checked before PDF417 as driver's licenses are PDF417 barcodes as well */
+	if (recognizerResultIsUSDLResult(result, &is) == RECOGNIZER_ERROR_STATUS_SUCCESS && is) return SERIALIZED_RESULT_USDL;
+	if (recognizerResultIsMRTDResult(result, &is) == RECOGNIZER_ERROR_STATUS_SUCCESS && is) return SERIALIZED_RESULT_MRTD;
+	if (recognizerResultIsMyKadResult(result, &is) == RECOGNIZER_ERROR_STATUS_SUCCESS && is) return SERIALIZED_RESULT_MYKAD;
+	if (recognizerResultIsPdf417Result(result, &is) == RECOGNIZER_ERROR_STATUS_SUCCESS && is) return SERIALIZED_RESULT_PDF417;
+	if (recognizerResultIsZXingResult(result, &is) == RECOGNIZER_ERROR_STATUS_SUCCESS && is) return SERIALIZED_RESULT_ZXING;
+	if (recognizerResultIsBardecoderResult(result, &is) == RECOGNIZER_ERROR_STATUS_SUCCESS && is) return SERIALIZED_RESULT_BARDECODER;
+	return SERIALIZED_RESULT_UNKNOWN;
+}
+
+static size_t putFields(Writer* w, RecognizerResult* result, SerializedResultKind kind, int* type) {
+	size_t numFields = 0;
+
+	*type = 0;
+	switch (kind) {
+	case SERIALIZED_RESULT_MRTD: {
+		MRTDFields f;
+		if (mrtdFieldsFromResult(&f, result) != RECOGNIZER_ERROR_STATUS_SUCCESS) break;
+		*type = (int) f.documentType;
+		numFields += putViewField(w, SERIALIZED_MRTD_DOCUMENT_CODE, f.documentCode);
+		numFields += putViewField(w, SERIALIZED_MRTD_ISSUER, f.issuer);
+		numFields += putViewField(w, SERIALIZED_MRTD_DOCUMENT_NUMBER, f.documentNumber);
+		numFields += putViewField(w, SERIALIZED_MRTD_PRIMARY_ID, f.primaryID);
+		numFields += putViewField(w, SERIALIZED_MRTD_SECONDARY_ID, f.secondaryID);
+		numFields += putViewField(w, SERIALIZED_MRTD_NATIONALITY, f.nationality);
+		numFields += putViewField(w, SERIALIZED_MRTD_SEX, f.sex);
+		numFields += putViewField(w, SERIALIZED_MRTD_DATE_OF_BIRTH, f.dateOfBirth);
+		numFields += putViewField(w, SERIALIZED_MRTD_DATE_OF_EXPIRY, f.dateOfExpiry);
+		numFields += putViewField(w, SERIALIZED_MRTD_OPT1, f.opt1);
+		numFields += putViewField(w, SERIALIZED_MRTD_OPT2, f.opt2);
+		numFields += putViewField(w, SERIALIZED_MRTD_ALIEN_NUMBER, f.alienNumber);
+		numFields += putViewField(w, SERIALIZED_MRTD_APPLICATION_RECEIPT_NUMBER, f.applicationReceiptNumber);
+		numFields += putViewField(w, SERIALIZED_MRTD_IMMIGRANT_CASE_NUMBER, f.immigrantCaseNumber);
+		numFields += putViewField(w, SERIALIZED_MRTD_RAW_DATA, f.rawData);
+		break;
+	}
+	case SERIALIZED_RESULT_USDL: {
+		USDLFieldTable table;
+		int i;
+		if (usdlFieldTableFill(&table, result) != RECOGNIZER_ERROR_STATUS_SUCCESS) break;
+		for (i = 0; i < USDL_FIELD_COUNT; ++i) {
+			numFields += putViewField(w, (unsigned int) i, table.fields[i]);
+		}
+		numFields += putBinaryField(w, SERIALIZED_USDL_RAW_DATA, result, recognizerResultGetUSDLRawBinaryData);
+		break;
+	}
+	case SERIALIZED_RESULT_MYKAD:
+		numFields += putStringField(w, SERIALIZED_MYKAD_FULL_NAME, result, recognizerResultGetMyKadFullName);
+		numFields += putStringField(w, SERIALIZED_MYKAD_ADDRESS, result, recognizerResultGetMyKadAddress);
+		numFields += putStringField(w, SERIALIZED_MYKAD_RELIGION, result, recognizerResultGetMyKadReligion);
+		numFields += putStringField(w, SERIALIZED_MYKAD_SEX, result, recognizerResultGetMyKadSex);
+		numFields += putStringField(w, SERIALIZED_MYKAD_BIRTH_DATE, result, recognizerResultGetMyKadBirthDate);
+		numFields += putStringField(w, SERIALIZED_MYKAD_NRIC_NUMBER, result, recognizerResultGetMyKadNricNumber);
+		break;
+	case SERIALIZED_RESULT_PDF417:
+	case SERIALIZED_RESULT_ZXING:
+	case SERIALIZED_RESULT_BARDECODER: {
+		BarcodeType barcodeType;
+		if (recognizerResultGetBarcodeType(result, &barcodeType) == RECOGNIZER_ERROR_STATUS_SUCCESS) {
+			*type = (int) barcodeType;
+		}
+		/* raw data is carried as is, without any text encoding */
+		numFields += putBinaryField(w, SERIALIZED_BARCODE_RAW_DATA, result, recognizerResultGetBarcodeRawData);
+		numFields += putStringField(w, SERIALIZED_BARCODE_STRING_DATA, result, recognizerResultGetBarcodeStringData);
+		numFields += putStringField(w, SERIALIZED_BARCODE_EXTENDED_STRING_DATA, result, recognizerResultGetBarcodeExtendedStringData);
+		numFields += putBinaryField(w, SERIALIZED_BARCODE_EXTENDED_RAW_DATA, result, recognizerResultGetBarcodeExtendedRawData);
+		break;
+	}
+	default:
+		break;
+	}
+	return numFields;
+}
+
+RecognizerErrorStatus resultListSerialize(const RecognizerResultList* resultList, void* buffer, size_t capacity, size_t* written) {
+	Writer w;
+	size_t numResults = 0;
+	size_t i;
+	RecognizerErrorStatus status;
+
+	if (resultList == NULL || written == NULL) return RECOGNIZER_ERROR_STATUS_POINTER_IS_NULL;
+
+	w.buffer = (unsigned char*) buffer;
+	w.capacity = buffer != NULL ? capacity : 0;
+	w.position = 0;
+
+	status = recognizerResultListGetNumOfResults(resultList, &numResults);
+	if (status != RECOGNIZER_ERROR_STATUS_SUCCESS) return status;
+
+	putBytes(&w, "RRLS", 4);
+	putU16(&w, SERIALIZED_RESULT_LIST_VERSION);
+	putU16(&w, 0);
+	putU32(&w, (unsigned long) numResults);
+	/* total size, patched at the end */
+	putU32(&w, 0);
+	/* offset table, patched while writing results */
+	w.position += 4 * numResults;
+
+	for (i = 0; i < numResults; ++i) {
+		RecognizerResult* result;
+		SerializedResultKind kind;
+		size_t start = w.position;
+		size_t numFields;
+		int flags = 0;
+		int value = 0;
+		int type;
+
+		status = recognizerResultListGetResultAtIndex(resultList, i, &result);
+		if (status != RECOGNIZER_ERROR_STATUS_SUCCESS) return status;
+
+		kind = resultKind(result);
+		if (recognizerResultIsResultEmpty(result, &value) == RECOGNIZER_ERROR_STATUS_SUCCESS && value) flags |= SERIALIZED_RESULT_FLAG_EMPTY;
+		if (recognizerResultIsResultValid(result, &value) == RECOGNIZER_ERROR_STATUS_SUCCESS && value) flags |= SERIALIZED_RESULT_FLAG_VALID;
+		if (recognizerResultIsResultUncertain(result, &value) == RECOGNIZER_ERROR_STATUS_SUCCESS && value) flags |= SERIALIZED_RESULT_FLAG_UNCERTAIN;
+
+		/* record size, number of fields and type are patched once fields are written */
+		w.position += RECORD_HEADER_SIZE;
+		numFields = putFields(&w, result, kind, &type);
+
+		putU32At(&w, HEADER_SIZE + 4 * i, (unsigned long) start);
+		putU32At(&w, start, (unsigned long) (w.position - start));
+		if (start + 8 <= w.capacity) {
+			w.buffer[start + 4] = (unsigned char) kind;
+			w.buffer[start + 5] = (unsigned char) flags;
+		}
+		putU16At(&w, start + 6, (unsigned int) numFields);
+		putU32At(&w, start + 8, (unsigned long) type);
+	}
+
+	putU32At(&w, 12, (unsigned long) w.position);
+
+	*written = w.position;
+	return w.position <= w.capacity ? RECOGNIZER_ERROR_STATUS_SUCCESS : RECOGNIZER_ERROR_STATUS_FAIL;
+}
+
+static unsigned long getU32(const unsigned char* p) {
+	return (unsigned long) p[0] | ((unsigned long) p[1] << 8) | ((unsigned long) p[2] << 16) | ((unsigned long) p[3] << 24);
+}
+
+static unsigned int getU16(const unsigned char* p) {
+	return (unsigned int) p[0] | ((unsigned int) p[1] << 8);
+}
+
+RecognizerErrorStatus serializedResultListOpen(SerializedResultList* list, const void* buffer, size_t size) {
+	const unsigned char* data = (const unsigned char*) buffer;
+	size_t numResults, tableEnd;
+	size_t i;
+
+	if (list == NULL || buffer == NULL) return RECOGNIZER_ERROR_STATUS_POINTER_IS_NULL;
+
+	if (size < HEADER_SIZE || memcmp(data, "RRLS", 4) != 0 || getU16(data + 4) != SERIALIZED_RESULT_LIST_VERSION
+			|| getU32(data + 12) > size || getU32(data + 12) < HEADER_SIZE) {
+		return RECOGNIZER_ERROR_STATUS_INVALID_TYPE;
+	}
+	size = getU32(data + 12);
+	numResults = getU32(data + 8);
+	if (numResults > (size - HEADER_SIZE) / 4) return RECOGNIZER_ERROR_STATUS_INVALID_TYPE;
+	tableEnd = HEADER_SIZE + 4 * numResults;
+
+	/* offsets are compared by subtraction from size, which cannot wrap, unlike addition to a 32-bit size_t */
+	for (i = 0; i < numResults; ++i) {
+		size_t offset = getU32(data + HEADER_SIZE + 4 * i);
+		if (offset < tableEnd || offset % 4 != 0 || offset > size - RECORD_HEADER_SIZE
+				|| getU32(data + offset) < RECORD_HEADER_SIZE
+				|| getU32(data + offset) > size - offset) {
+			return RECOGNIZER_ERROR_STATUS_INVALID_TYPE;
+		}
+	}
+
+	list->data = data;
+	list->size = size;
+	list->numResults = numResults;
+	return RECOGNIZER_ERROR_STATUS_SUCCESS;
+}
+
+RecognizerErrorStatus serializedResultListGetResult(const SerializedResultList* list, size_t index, SerializedResult* result) {
+	const unsigned char* record;
+
+	if (list == NULL || result == NULL) return RECOGNIZER_ERROR_STATUS_POINTER_IS_NULL;
+	if (index >= list->numResults) return RECOGNIZER_ERROR_STATUS_INDEX_OUT_OF_RANGE;
+
+	record = list->data + getU32(list->data + HEADER_SIZE + 4 * index);
+	result->data = record;
+	result->size = getU32(record);
+	result->kind = (SerializedResultKind) record[4];
+	result->flags = record[5];
+	result->numFields = getU16(record + 6);
+	result->type = (int) (long) getU32(record + 8);
+	return RECOGNIZER_ERROR_STATUS_SUCCESS;
+}
+
+RecognizerErrorStatus serializedResultGetField(const SerializedResult* result, unsigned int fieldId, StringView* value) {
+	size_t position = RECORD_HEADER_SIZE;
+	size_t i;
+
+	if (result == NULL || value == NULL) return RECOGNIZER_ERROR_STATUS_POINTER_IS_NULL;
+
+	for (i = 0; i < result->numFields && position + FIELD_HEADER_SIZE <= result->size; ++i) {
+		const unsigned char* field = result->data + position;
+		size_t length = getU32(field + 4);
+		size_t padded;
+
+		if (length >= result->size) break;
+		padded = (length + 1 + 3) & ~(size_t) 3;
+		if (padded > result->size - position - FIELD_HEADER_SIZE) break;
+		if (getU16(field) == fieldId) {
+			value->data = (const char*) field + FIELD_HEADER_SIZE;
+			value->length = length;
+			return RECOGNIZER_ERROR_STATUS_SUCCESS;
+		}
+		position += FIELD_HEADER_SIZE + padded;
+	}
+
+	value->data = "";
+	value->length = 0;
+	return RECOGNIZER_ERROR_STATUS_UNKNOWN_KEY;
+}
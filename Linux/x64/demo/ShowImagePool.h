@@ -0,0 +1,151 @@
+#ifndef SHOWIMAGEPOOL_H_
+#define SHOWIMAGEPOOL_H_
+
+#include <stddef.h>
+
+#include "RecognizerApi.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Number of ShowImageType values */
+#define SHOW_IMAGE_POOL_NUM_TYPES (SHOW_IMAGE_TYPE_SUCCESSFUL_SCAN + 1)
+
+/**
+ * Form in which a kept image is stored in its buffer.
+ */
+typedef enum ShowImageEncoding {
+	/* tightly packed pixels */
+	SHOW_IMAGE_ENCODING_RAW,
+	/* PNG file of the pixels, gray, RGB or RGBA, deflated with zlib at its fastest level. Programs using the pool
+	link with -lz. */
+	SHOW_IMAGE_ENCODING_PNG
+} ShowImageEncoding;
+
+/**
+ * Caller-owned buffer receiving images of one ShowImageType.
+ */
+typedef struct ShowImageBuffer {
+	/* memory owned by caller, or NULL if images of this type are not wanted */
+	void* data;
+	/* size of data in bytes */
+	size_t capacity;
+	/* longer side of kept image is downscaled to at most this many pixels. Zero keeps full resolution. */
+	int maxDimension;
+	/* if non-zero, kept image is converted to outputType */
+	int convert;
+	RawImageType outputType;
+	/* form of data; NV21 images are kept as gray when encoded */
+	ShowImageEncoding encoding;
+	/* non-zero if buffer holds an image delivered since last showImagePoolClear */
+	int valid;
+	/* description of the delivered image. Rows are tightly packed, or bytesPerRow is the row size before encoding. */
+	int width;
+	int height;
+	int bytesPerRow;
+	RawImageType type;
+	/* number of bytes of data used by the delivered image, i.e. size of the file if encoded */
+	size_t size;
+} ShowImageBuffer;
+
+/**
+ * Set of caller-owned buffers, one per ShowImageType, into which images given to onShowImage are copied.
+ * The library deletes its image once onShowImage returns, so keeping it otherwise requires a clone, i.e. one
+ * heap allocation per image. With a pool, memory is allocated once by the caller and reused for every frame.
+ */
+typedef struct ShowImagePool {
+	ShowImageBuffer buffers[SHOW_IMAGE_POOL_NUM_TYPES];
+	/* number of images not kept because buffer of their type was missing or too small */
+	size_t numDropped;
+	/* onShowImage replaced by showImagePoolAttach, called after the image is copied */
+	void (*chainedOnShowImage)(const RecognizerImage* image, const ShowImageType showType, const char* name);
+	/* zlib state reused by every PNG encoding, or NULL before the first one */
+	void* deflater;
+} ShowImagePool;
+
+/**
+ * Initializes pool without any buffers.
+ *
+ *  @param pool pool to initialize
+ */
+void showImagePoolInit(ShowImagePool* pool);
+
+/**
+ * Registers caller-owned buffer for images of given type. Images are kept at full resolution and in their own
+ * type until showImagePoolSetOutput is called.
+ *
+ *  @param pool     pool
+ *  @param type     type of images stored into buffer
+ *  @param data     memory of the buffer, or NULL to stop keeping images of this type
+ *  @param capacity size of data in bytes
+ *
+ *  @return status of the operation. RECOGNIZER_ERROR_STATUS_INDEX_OUT_OF_RANGE if type is not valid.
+ */
+RecognizerErrorStatus showImagePoolSetBuffer(ShowImagePool* pool, ShowImageType type, void* data, size_t capacity);
+
+/**
+ * Sets the form in which images of given type are kept. Downscaling (area average by an integer factor) and
+ * color conversion are done in the same pass that copies the image out of the library, so no full resolution
+ * intermediate is written.
+ *
+ *  @param pool         pool
+ *  @param type         type of images
+ *  @param maxDimension longer side of kept image in pixels, or zero for full resolution
+ *  @param convert      if non-zero, images are converted to outputType, otherwise their type is kept
+ *  @param outputType   RAW_IMAGE_TYPE_BGRA, RAW_IMAGE_TYPE_BGR or RAW_IMAGE_TYPE_GRAY
+ *
+ *  @return status of the operation. RECOGNIZER_ERROR_STATUS_INVALID_TYPE if outputType is not supported.
+ */
+RecognizerErrorStatus showImagePoolSetOutput(ShowImagePool* pool, ShowImageType type, int maxDimension, int convert,
+		RawImageType outputType);
+
+/**
+ * Sets encoding of images of given type. Images are encoded in place, after downscaling and conversion, so no image
+ * buffer besides the caller's is used; zlib state, about 270 KB, is allocated with the first encoded image and
+ * released by showImagePoolDetach. Encoding needs 57 bytes of the buffer besides the raw image, and room for the
+ * compressed rows to stay ahead of the rows not read yet, which a buffer 1% larger than the raw image
+ * gives even for noise; images whose file does not fit are dropped.
+ *
+ *  @param pool     pool
+ *  @param type     type of images
+ *  @param encoding encoding of kept images
+ *
+ *  @return status of the operation. RECOGNIZER_ERROR_STATUS_INVALID_TYPE if encoding is not supported.
+ */
+RecognizerErrorStatus showImagePoolSetEncoding(ShowImagePool* pool, ShowImageType type, ShowImageEncoding encoding);
+
+/**
+ * Marks all buffers as empty. Call before recognition whose images should be collected.
+ *
+ *  @param pool pool
+ */
+void showImagePoolClear(ShowImagePool* pool);
+
+/**
+ * Makes callback deliver images into pool. onShowImage of callback is replaced and called after the image is
+ * copied. Since onShowImage has no user data parameter, the pool is bound to the calling thread, so callback
+ * must be used for recognition on this thread only.
+ *
+ *  @param pool     pool
+ *  @param callback callback which will be given to recognition
+ *
+ *  @return status of the operation
+ */
+RecognizerErrorStatus showImagePoolAttach(ShowImagePool* pool, RecognizerCallback* callback);
+
+/**
+ * Restores onShowImage of callback, unbinds pool from the calling thread and releases its zlib state.
+ *
+ *  @param pool     pool
+ *  @param callback callback given to showImagePoolAttach
+ *
+ *  @return status of the operation
+ */
+RecognizerErrorStatus showImagePoolDetach(ShowImagePool* pool, RecognizerCallback* callback);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
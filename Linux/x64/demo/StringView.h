@@ -0,0 +1,22 @@
+#ifndef STRINGVIEW_H_
+#define STRINGVIEW_H_
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Non-owning view of a string. Data is not necessarily zero-terminated.
+ */
+typedef struct StringView {
+	const char* data;
+	size_t length;
+} StringView;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
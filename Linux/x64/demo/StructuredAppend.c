@@ -0,0 +1,427 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "StructuredAppend.h"
+
+/* QR mode indicators */
+#define MODE_TERMINATOR 0x0
+#define MODE_NUMERIC 0x1
+#define MODE_ALPHANUMERIC 0x2
+#define MODE_STRUCTURED_APPEND 0x3
+#define MODE_BYTE 0x4
+#define MODE_FNC1_FIRST 0x5
+#define MODE_ECI 0x7
+#define MODE_KANJI 0x8
+#define MODE_FNC1_SECOND 0x9
+
+/* bits of the structured append header after its mode indicator: index, count - 1 and parity */
+#define HEADER_BITS 16
+
+/* largest number of data codewords of versions 1 to 9 (9-L), and smallest of versions 10 to 40 (10-H). Raw data is
+compared against these as the data codeword bitstream holds one codeword per byte; decoded bytes have no such bound. */
+#define MAX_SMALL_CODEWORDS 232
+#define MIN_LARGE_CODEWORDS 122
+
+/* group separator written for FNC1 in alphanumeric data */
+#define GROUP_SEPARATOR 0x1D
+
+static const char alphanumeric[] = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ $%*+-./:";
+
+/* Character count bits of numeric, alphanumeric, byte and Kanji mode for versions 1-9, 10-26 and 27-40 */
+static const int countBits[3][4] = {
+	{ 10, 9, 8, 8 },
+	{ 12, 11, 16, 10 },
+	{ 14, 13, 16, 12 }
+};
+
+typedef struct BitReader {
+	const unsigned char* data;
+	size_t size;
+	size_t position;
+} BitReader;
+
+static size_t bitsLeft(const BitReader* reader) {
+	return reader->size * 8 - reader->position;
+}
+
+/* Reads up to 24 bits, most significant first. Caller checks that they are available. */
+static unsigned long readBits(BitReader* reader, int count) {
+	unsigned long value = 0;
+	int i;
+
+	for (i = 0; i < count; ++i, ++reader->position) {
+		value = (value << 1) | ((reader->data[reader->position / 8] >> (7 - reader->position % 8)) & 1u);
+	}
+	return value;
+}
+
+/* Output of decoded payload bytes */
+typedef struct Payload {
+	unsigned char* data;
+	size_t capacity;
+	size_t size;
+	int overflow;
+} Payload;
+
+static void putByte(Payload* payload, unsigned int c) {
+	if (payload->size < payload->capacity) payload->data[payload->size++] = (unsigned char) c;
+	else payload->overflow = 1;
+}
+
+static int decodeNumeric(BitReader* reader, unsigned long count, Payload* payload) {
+	while (count > 0) {
+		int digits = count >= 3 ? 3 : (int) count;
+		int bits = digits == 3 ? 10 : (digits == 2 ? 7 : 4);
+		unsigned long value, limit = digits == 3 ? 1000 : (digits == 2 ? 100 : 10);
+
+		if (bitsLeft(reader) < (size_t) bits) return 0;
+		value = readBits(reader, bits);
+		if (value >= limit) return 0;
+		if (digits == 3) putByte(payload, '0' + (unsigned int) (value / 100));
+		if (digits >= 2) putByte(payload, '0' + (unsigned int) (value / 10 % 10));
+		putByte(payload, '0' + (unsigned int) (value % 10));
+		count -= (unsigned long) digits;
+	}
+	return 1;
+}
+
+static int decodeAlphanumeric(BitReader* reader, unsigned long count, int fnc1, Payload* payload) {
+	size_t start = payload->size, i, j;
+
+	while (count > 0) {
+		if (count >= 2) {
+			unsigned long value;
+			if (bitsLeft(reader) < 11) return 0;
+			value = readBits(reader, 11);
+			if (value >= 45 * 45) return 0;
+			putByte(payload, (unsigned char) alphanumeric[value / 45]);
+			putByte(payload, (unsigned char) alphanumeric[value % 45]);
+			count -= 2;
+		} else {
+			unsigned long value;
+			if (bitsLeft(reader) < 6) return 0;
+			value = readBits(reader, 6);
+			if (value >= 45) return 0;
+			putByte(payload, (unsigned char) alphanumeric[value]);
+			count = 0;
+		}
+	}
+
+	/* in FNC1 mode, % stands for FNC1 and %% for a literal % */
+	if (fnc1 && !payload->overflow) {
+		for (i = start, j = start; i < payload->size; ++i, ++j) {
+			if (payload->data[i] == '%') {
+				if (i + 1 < payload->size && payload->data[i + 1] == '%') ++i;
+				else payload->data[i] = GROUP_SEPARATOR;
+			}
+			payload->data[j] = payload->data[i];
+		}
+		payload->size = j;
+	}
+	return 1;
+}
+
+static int decodeByte(BitReader* reader, unsigned long count, Payload* payload) {
+	if (bitsLeft(reader) < count * 8) return 0;
+	while (count-- > 0) putByte(payload, (unsigned int) readBits(reader, 8));
+	return 1;
+}
+
+static int decodeKanji(BitReader* reader, unsigned long count, Payload* payload) {
+	if (bitsLeft(reader) < count * 13) return 0;
+	while (count-- > 0) {
+		unsigned long value = readBits(reader, 13);
+		unsigned long assembled = ((value / 0xC0) << 8) | (value % 0xC0);
+
+		assembled += assembled < 0x1F00 ? 0x8140 : 0xC140;
+		putByte(payload, (unsigned int) (assembled >> 8));
+		putByte(payload, (unsigned int) (assembled & 0xFF));
+	}
+	return 1;
+}
+
+static int skipEci(BitReader* reader) {
+	unsigned long first;
+
+	if (bitsLeft(reader) < 8) return 0;
+	first = readBits(reader, 8);
+	if ((first & 0x80) == 0) return 1;
+	if ((first & 0xC0) == 0x80) {
+		if (bitsLeft(reader) < 8) return 0;
+		readBits(reader, 8);
+		return 1;
+	}
+	if ((first & 0xE0) == 0xC0) {
+		if (bitsLeft(reader) < 16) return 0;
+		readBits(reader, 16);
+		return 1;
+	}
+	return 0;
+}
+
+/* Non-zero if nothing but zero bits up to a byte boundary and pad codewords follow */
+static int onlyPadding(BitReader* reader) {
+	size_t i;
+
+	while (reader->position % 8 != 0) {
+		if (readBits(reader, 1) != 0) return 0;
+	}
+	for (i = reader->position / 8; i < reader->size; ++i) {
+		if (reader->data[i] != 0xEC && reader->data[i] != 0x11) return 0;
+	}
+	return 1;
+}
+
+/* Decodes segments following the structured append header with character counts of given version class */
+static int decodeSegments(BitReader reader, int versionClass, Payload* payload) {
+	int fnc1 = 0;
+
+	payload->size = 0;
+	payload->overflow = 0;
+	for (;;) {
+		unsigned int mode;
+		unsigned long count = 0;
+		int decoded;
+
+		/* a terminator may be left out when less than four bits remain */
+		if (bitsLeft(&reader) < 4) return 1;
+		mode = (unsigned int) readBits(&reader, 4);
+		switch (mode) {
+		case MODE_TERMINATOR:
+			return onlyPadding(&reader);
+		case MODE_FNC1_FIRST:
+			fnc1 = 1;
+			continue;
+		case MODE_FNC1_SECOND:
+			/* application indicator */
+			if (bitsLeft(&reader) < 8) return 0;
+			readBits(&reader, 8);
+			fnc1 = 1;
+			continue;
+		case MODE_ECI:
+			if (!skipEci(&reader)) return 0;
+			continue;
+		case MODE_NUMERIC:
+		case MODE_ALPHANUMERIC:
+		case MODE_BYTE:
+		case MODE_KANJI:
+			break;
+		default:
+			/* structured append header in the middle, Hanzi or undefined modes */
+			return 0;
+		}
+
+		{
+			int bits = countBits[versionClass][mode == MODE_NUMERIC ? 0 : (mode == MODE_ALPHANUMERIC ? 1
+					: (mode == MODE_BYTE ? 2 : 3))];
+			if (bitsLeft(&reader) < (size_t) bits) return 0;
+			count = readBits(&reader, bits);
+		}
+		if (mode == MODE_NUMERIC) decoded = decodeNumeric(&reader, count, payload);
+		else if (mode == MODE_ALPHANUMERIC) decoded = decodeAlphanumeric(&reader, count, fnc1, payload);
+		else if (mode == MODE_BYTE) decoded = decodeByte(&reader, count, payload);
+		else decoded = decodeKanji(&reader, count, payload);
+		if (!decoded) return 0;
+	}
+}
+
+RecognizerErrorStatus structuredAppendParseQR(const void* raw, size_t size, StructuredAppendHeader* header,
+		unsigned char* payload, size_t capacity, size_t* payloadSize) {
+	BitReader reader;
+	Payload out;
+	int versionClass;
+
+	if (raw == NULL || header == NULL || (payload == NULL && capacity > 0) || payloadSize == NULL) {
+		return RECOGNIZER_ERROR_STATUS_POINTER_IS_NULL;
+	}
+	*payloadSize = 0;
+
+	reader.data = (const unsigned char*) raw;
+	reader.size = size;
+	reader.position = 0;
+	if (bitsLeft(&reader) < 4 + HEADER_BITS || readBits(&reader, 4) != MODE_STRUCTURED_APPEND) {
+		return RECOGNIZER_ERROR_STATUS_INVALID_TYPE;
+	}
+	header->index = (unsigned int) readBits(&reader, 4);
+	header->count = (unsigned int) readBits(&reader, 4) + 1;
+	header->parity = (unsigned int) readBits(&reader, 8);
+	if (header->index >= header->count) return RECOGNIZER_ERROR_STATUS_INVALID_TYPE;
+
+	out.data = payload;
+	out.capacity = capacity;
+	for (versionClass = 0; versionClass < 3; ++versionClass) {
+		if (versionClass == 0 && size > MAX_SMALL_CODEWORDS) continue;
+		if (versionClass > 0 && size < MIN_LARGE_CODEWORDS) break;
+		if (decodeSegments(reader, versionClass, &out)) {
+			if (out.overflow) return RECOGNIZER_ERROR_STATUS_INDEX_OUT_OF_RANGE;
+			*payloadSize = out.size;
+			return RECOGNIZER_ERROR_STATUS_SUCCESS;
+		}
+	}
+	return RECOGNIZER_ERROR_STATUS_INVALID_TYPE;
+}
+
+static void clearSet(StructuredAppendSet* set) {
+	unsigned int i;
+
+	for (i = 0; i < STRUCTURED_APPEND_MAX_SEGMENTS; ++i) {
+		free(set->segments[i]);
+		set->segments[i] = NULL;
+		set->sizes[i] = 0;
+	}
+	set->numReceived = 0;
+}
+
+static void removeSet(StructuredAppend* assembler, size_t index) {
+	clearSet(&assembler->sets[index]);
+	/* the last set takes the freed place; its segment pointers move with it */
+	if (index + 1 < assembler->numSets) {
+		assembler->sets[index] = assembler->sets[assembler->numSets - 1];
+		memset(&assembler->sets[assembler->numSets - 1], 0, sizeof(StructuredAppendSet));
+	}
+	--assembler->numSets;
+}
+
+/* Set of given sequence, started if not gathered yet. The least recently updated set makes room when all are taken. */
+static StructuredAppendSet* findSet(StructuredAppend* assembler, unsigned int count, unsigned int parity) {
+	StructuredAppendSet* set;
+	size_t i, oldest = 0;
+
+	for (i = 0; i < assembler->numSets; ++i) {
+		if (assembler->sets[i].count == count && assembler->sets[i].parity == parity) return &assembler->sets[i];
+		if (assembler->sets[i].lastFrame < assembler->sets[oldest].lastFrame) oldest = i;
+	}
+	if (assembler->numSets == STRUCTURED_APPEND_MAX_SETS) {
+		removeSet(assembler, oldest);
+		++assembler->numExpired;
+	}
+	set = &assembler->sets[assembler->numSets++];
+	memset(set, 0, sizeof(*set));
+	set->count = count;
+	set->parity = parity;
+	return set;
+}
+
+/* Joins segments of a complete set in order. Returns 1 on success, 0 if parity does not match and -1 if memory runs
+out. */
+static int joinSet(const StructuredAppendSet* set, unsigned char** message, size_t* messageSize) {
+	unsigned int parity = 0;
+	size_t size = 0, offset = 0, i;
+	unsigned int s;
+
+	for (s = 0; s < set->count; ++s) size += set->sizes[s];
+	/* one spare byte, so that an empty message is not a NULL allocation */
+	*message = (unsigned char*) malloc(size + 1);
+	if (*message == NULL) return -1;
+	for (s = 0; s < set->count; ++s) {
+		memcpy(*message + offset, set->segments[s], set->sizes[s]);
+		offset += set->sizes[s];
+	}
+	for (i = 0; i < size; ++i) parity ^= (*message)[i];
+	if (parity != set->parity) {
+		free(*message);
+		*message = NULL;
+		return 0;
+	}
+	*messageSize = size;
+	return 1;
+}
+
+void structuredAppendInit(StructuredAppend* assembler, unsigned long maxAgeFrames) {
+	memset(assembler, 0, sizeof(*assembler));
+	assembler->maxAgeFrames = maxAgeFrames;
+}
+
+RecognizerErrorStatus structuredAppendAdd(StructuredAppend* assembler, const void* raw, size_t size,
+		unsigned char** message, size_t* messageSize) {
+	StructuredAppendHeader header;
+	StructuredAppendSet* set;
+	RecognizerErrorStatus status;
+	unsigned char* payload;
+	size_t payloadSize = 0;
+	int joined;
+
+	if (assembler == NULL || raw == NULL || message == NULL || messageSize == NULL) {
+		return RECOGNIZER_ERROR_STATUS_POINTER_IS_NULL;
+	}
+	*message = NULL;
+	*messageSize = 0;
+
+	/* one spare byte, so that an empty payload is not a NULL allocation */
+	payload = (unsigned char*) malloc(size * 3 + 1);
+	if (payload == NULL) return RECOGNIZER_ERROR_STATUS_FAIL;
+	status = structuredAppendParseQR(raw, size, &header, payload, size * 3 + 1, &payloadSize);
+	if (status != RECOGNIZER_ERROR_STATUS_SUCCESS) {
+		free(payload);
+		return status;
+	}
+	++assembler->numSegments;
+
+	set = findSet(assembler, header.count, header.parity);
+	set->lastFrame = assembler->frame;
+	if (set->segments[header.index] != NULL) {
+		if (set->sizes[header.index] == payloadSize
+				&& memcmp(set->segments[header.index], payload, payloadSize) == 0) {
+			++assembler->numDuplicates;
+			free(payload);
+			return RECOGNIZER_ERROR_STATUS_SUCCESS;
+		}
+		/* another message of the same count and parity; the older one is unlikely to be completed */
+		clearSet(set);
+		++assembler->numExpired;
+	}
+	set->segments[header.index] = payload;
+	set->sizes[header.index] = payloadSize;
+	++set->numReceived;
+	if (set->numReceived < set->count) return RECOGNIZER_ERROR_STATUS_SUCCESS;
+
+	joined = joinSet(set, message, messageSize);
+	if (joined > 0) ++assembler->numCompleted;
+	else if (joined == 0) ++assembler->numParityErrors;
+	removeSet(assembler, (size_t) (set - assembler->sets));
+	return joined > 0 ? RECOGNIZER_ERROR_STATUS_SUCCESS : RECOGNIZER_ERROR_STATUS_FAIL;
+}
+
+RecognizerErrorStatus structuredAppendAddResult(StructuredAppend* assembler, RecognizerResult* result,
+		unsigned char** message, size_t* messageSize) {
+	BarcodeType type;
+	const void* raw = NULL;
+	const char* text = NULL;
+	size_t size = 0;
+
+	if (assembler == NULL || result == NULL || message == NULL || messageSize == NULL) {
+		return RECOGNIZER_ERROR_STATUS_POINTER_IS_NULL;
+	}
+	*message = NULL;
+	*messageSize = 0;
+	if (recognizerResultGetBarcodeType(result, &type) != RECOGNIZER_ERROR_STATUS_SUCCESS || type != BARCODE_TYPE_QR
+			|| recognizerResultGetBarcodeRawData(result, &raw, &size) != RECOGNIZER_ERROR_STATUS_SUCCESS
+			|| raw == NULL) {
+		return RECOGNIZER_ERROR_STATUS_INVALID_TYPE;
+	}
+	/* raw data equal to the decoded text holds no mode indicators, so the header cannot be read from it */
+	if (recognizerResultGetBarcodeStringData(result, &text) == RECOGNIZER_ERROR_STATUS_SUCCESS && text != NULL
+			&& strlen(text) == size && memcmp(text, raw, size) == 0) {
+		++assembler->numDecodedRaw;
+		return RECOGNIZER_ERROR_STATUS_INVALID_TYPE;
+	}
+	return structuredAppendAdd(assembler, raw, size, message, messageSize);
+}
+
+void structuredAppendNextFrame(StructuredAppend* assembler) {
+	size_t i = 0;
+
+	while (i < assembler->numSets) {
+		if (assembler->frame - assembler->sets[i].lastFrame >= assembler->maxAgeFrames) {
+			removeSet(assembler, i);
+			++assembler->numExpired;
+		} else {
+			++i;
+		}
+	}
+	++assembler->frame;
+}
+
+void structuredAppendTerm(StructuredAppend* assembler) {
+	while (assembler->numSets > 0) removeSet(assembler, assembler->numSets - 1);
+}
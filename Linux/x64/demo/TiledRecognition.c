@@ -0,0 +1,418 @@
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "TiledRecognition.h"
+#include "RecognizeOptions.h"
+#include "StringView.h"
+
+/* largest object expected on a 600 dpi scan: TD3 MRZ is about 2950 pixels wide, ID1 card about 2020 pixels */
+#define DEFAULT_OBJECT_SIZE 3000
+/* twice the overlap, so that each tile contributes as many new pixels as it shares with its neighbour */
+#define DEFAULT_TILE_SIZE 6144
+
+/* Work shared by all threads. Tiles are taken in the order of order by atomically incrementing nextTile. */
+typedef struct TileJob {
+	const RecognizerImage* image;
+	int width;
+	int height;
+	/* tiles in pixels */
+	const PPRectangle* tiles;
+	size_t numTiles;
+	/* class of each tile, selecting the recognizer of a worker it is given to. NULL if all tiles are of class 0. */
+	const size_t* classes;
+	/* tile indices, largest tile first */
+	size_t* order;
+	size_t nextTile;
+	double deadlineMs;
+	RecognizerResultList** lists;
+	RecognizerErrorStatus* statuses;
+	double* tileMs;
+	/* non-zero for tiles skipped because of the deadline */
+	unsigned char* skipped;
+} TileJob;
+
+typedef struct TileWorker {
+	pthread_t thread;
+	/* recognizer of each tile class */
+	const Recognizer* const* recognizers;
+	TileJob* job;
+} TileWorker;
+
+/* Kind of identity of a result, results of different kinds are never duplicates of each other */
+typedef enum IdentityKind {
+	IDENTITY_NONE,
+	IDENTITY_MRTD,
+	IDENTITY_USDL,
+	IDENTITY_MYKAD,
+	IDENTITY_BARCODE
+} IdentityKind;
+
+typedef struct ResultIdentity {
+	IdentityKind kind;
+	/* barcode type for barcode results */
+	int type;
+	/* content identifying the result, owned by result */
+	StringView key;
+} ResultIdentity;
+
+static void* tileWorkerRun(void* arg) {
+	TileWorker* worker = (TileWorker*) arg;
+	TileJob* job = worker->job;
+
+	for (;;) {
+		size_t next = __atomic_fetch_add(&job->nextTile, 1, __ATOMIC_RELAXED);
+		RecognizeOptions options;
+		PPRectangle roi;
+		double start;
+		size_t i;
+
+		if (next >= job->numTiles) break;
+		i = job->order[next];
+		if (job->deadlineMs > 0.0 && recognizeMonotonicMs() >= job->deadlineMs) {
+			job->skipped[i] = 1;
+			continue;
+		}
+
+		/* ROI wraps the tile without copying its pixels */
+		roi.x = job->tiles[i].x / job->width;
+		roi.y = job->tiles[i].y / job->height;
+		roi.width = job->tiles[i].width / job->width;
+		roi.height = job->tiles[i].height / job->height;
+		recognizeOptionsInit(&options);
+		options.roi = &roi;
+		options.deadlineMs = job->deadlineMs;
+		start = recognizeMonotonicMs();
+		job->statuses[i] = recognizeWithOptions(worker->recognizers[job->classes != NULL ? job->classes[i] : 0],
+				&job->lists[i], job->image, &options);
+		job->tileMs[i] = recognizeMonotonicMs() - start;
+	}
+	return NULL;
+}
+
+/* Offsets of tiles along one axis. Last tile is aligned to the end, so that there are no thin slivers. */
+static size_t tileOffsets(int length, int tileSize, int step, int* offsets) {
+	size_t count = 0;
+	int offset;
+
+	if (length <= tileSize) {
+		if (offsets != NULL) offsets[0] = 0;
+		return 1;
+	}
+	for (offset = 0; offset + tileSize < length; offset += step) {
+		if (offsets != NULL) offsets[count] = offset;
+		++count;
+	}
+	if (offsets != NULL) offsets[count] = length - tileSize;
+	return count + 1;
+}
+
+/* Non-zero if region lies within image of given size. Half a pixel is tolerated for rounding of float coordinates. */
+static int regionInImage(const PPRectangle* region, int width, int height) {
+	return region->x >= 0.f && region->y >= 0.f && region->width > 0.f && region->height > 0.f
+			&& region->x + region->width <= width + 0.5f && region->y + region->height <= height + 0.5f;
+}
+
+/* 3 for valid and certain result, 2 for valid but uncertain, 1 otherwise */
+static int resultQuality(const RecognizerResult* result) {
+	int valid = 0;
+	int uncertain = 0;
+
+	recognizerResultIsResultValid(result, &valid);
+	recognizerResultIsResultUncertain(result, &uncertain);
+	return valid ? (uncertain ? 2 : 3) : 1;
+}
+
+static ResultIdentity resultIdentity(RecognizerResult* result) {
+	ResultIdentity identity;
+	const char* str = NULL;
+	const void* data = NULL;
+	size_t size = 0;
+	BarcodeType type;
+	int is = 0;
+
+	memset(&identity, 0, sizeof(identity));
+	if (recognizerResultIsMRTDResult(result, &is) == RECOGNIZER_ERROR_STATUS_SUCCESS && is) {
+		if (recognizerResultGetMRTDRawStringData(result, &str) != RECOGNIZER_ERROR_STATUS_SUCCESS) str = NULL;
+		identity.kind = IDENTITY_MRTD;
+	} else if (recognizerResultIsUSDLResult(result, &is) == RECOGNIZER_ERROR_STATUS_SUCCESS && is) {
+		if (recognizerResultGetUSDLRawBinaryData(result, &data, &size) != RECOGNIZER_ERROR_STATUS_SUCCESS) data = NULL;
+		identity.kind = IDENTITY_USDL;
+	} else if (recognizerResultIsMyKadResult(result, &is) == RECOGNIZER_ERROR_STATUS_SUCCESS && is) {
+		if (recognizerResultGetMyKadNricNumber(result, &str) != RECOGNIZER_ERROR_STATUS_SUCCESS) str = NULL;
+		identity.kind = IDENTITY_MYKAD;
+	} else if (recognizerResultGetBarcodeType(result, &type) == RECOGNIZER_ERROR_STATUS_SUCCESS
+			&& type != BARCODE_TYPE_NOT_BARCODE) {
+		if (recognizerResultGetBarcodeRawData(result, &data, &size) != RECOGNIZER_ERROR_STATUS_SUCCESS) data = NULL;
+		identity.kind = IDENTITY_BARCODE;
+		identity.type = (int) type;
+	}
+
+	if (str != NULL) {
+		identity.key.data = str;
+		identity.key.length = strlen(str);
+	} else if (data != NULL) {
+		identity.key.data = (const char*) data;
+		identity.key.length = size;
+	}
+	/* results without identifying content are never merged */
+	if (identity.key.length == 0) identity.kind = IDENTITY_NONE;
+	return identity;
+}
+
+static int sameIdentity(const ResultIdentity* a, const ResultIdentity* b) {
+	return a->kind != IDENTITY_NONE && a->kind == b->kind && a->type == b->type && a->key.length == b->key.length
+			&& memcmp(a->key.data, b->key.data, a->key.length) == 0;
+}
+
+/* Collects non-empty results of all tiles in tile order, keeping the best copy of duplicates */
+static RecognizerErrorStatus mergeResults(TiledResults* results, const PPRectangle* tiles) {
+	ResultIdentity* identities;
+	size_t capacity = 0;
+	size_t t, i, j;
+
+	for (t = 0; t < results->numTiles; ++t) {
+		size_t n = 0;
+		if (results->lists[t] != NULL) recognizerResultListGetNumOfResults(results->lists[t], &n);
+		capacity += n;
+	}
+	if (capacity == 0) return RECOGNIZER_ERROR_STATUS_SUCCESS;
+
+	results->results = (RecognizerResult**) malloc(capacity * sizeof(RecognizerResult*));
+	results->regions = (PPRectangle*) malloc(capacity * sizeof(PPRectangle));
+	results->tileIndices = (size_t*) malloc(capacity * sizeof(size_t));
+	identities = (ResultIdentity*) malloc(capacity * sizeof(ResultIdentity));
+	if (results->results == NULL || results->regions == NULL || results->tileIndices == NULL || identities == NULL) {
+		free(identities);
+		return RECOGNIZER_ERROR_STATUS_FAIL;
+	}
+
+	for (t = 0; t < results->numTiles; ++t) {
+		size_t n = 0;
+		if (results->lists[t] == NULL) continue;
+		recognizerResultListGetNumOfResults(results->lists[t], &n);
+		for (i = 0; i < n; ++i) {
+			RecognizerResult* result;
+			ResultIdentity identity;
+			int empty = 1;
+
+			if (recognizerResultListGetResultAtIndex(results->lists[t], i, &result) != RECOGNIZER_ERROR_STATUS_SUCCESS) continue;
+			recognizerResultIsResultEmpty(result, &empty);
+			if (empty) continue;
+
+			identity = resultIdentity(result);
+			for (j = 0; j < results->numResults && !sameIdentity(&identities[j], &identity); ++j) {
+			}
+			if (j == results->numResults) {
+				++results->numResults;
+			} else if (resultQuality(result) <= resultQuality(results->results[j])) {
+				continue;
+			}
+			results->results[j] = result;
+			results->regions[j] = tiles[t];
+			results->tileIndices[j] = t;
+			identities[j] = identity;
+		}
+	}
+
+	free(identities);
+	return RECOGNIZER_ERROR_STATUS_SUCCESS;
+}
+
+/* Orders tiles by area, largest first. Large regions (e.g. big PDF417 symbols) take longest, and starting them first
+keeps one of them from being left alone on a single thread at the end. */
+static void orderTiles(TileJob* job) {
+	size_t i, j;
+
+	for (i = 0; i < job->numTiles; ++i) {
+		float area = job->tiles[i].width * job->tiles[i].height;
+
+		for (j = i; j > 0; --j) {
+			const PPRectangle* previous = &job->tiles[job->order[j - 1]];
+			if (previous->width * previous->height >= area) break;
+			job->order[j] = job->order[j - 1];
+		}
+		job->order[j] = i;
+	}
+}
+
+/* Recognizes all tiles of job on all recognizers, the calling thread working as the first one. Each worker takes
+numClasses consecutive recognizers. */
+static void runTiles(TileJob* job, const Recognizer* const* recognizers, size_t numRecognizers, size_t numClasses,
+		TileWorker* workers) {
+	size_t i;
+
+	for (i = 0; i < numRecognizers; ++i) {
+		workers[i].recognizers = recognizers + i * numClasses;
+		workers[i].job = job;
+		if (i > 0 && pthread_create(&workers[i].thread, NULL, tileWorkerRun, &workers[i]) != 0) {
+			/* fewer threads only make recognition slower */
+			workers[i].job = NULL;
+		}
+	}
+	tileWorkerRun(&workers[0]);
+	for (i = 1; i < numRecognizers; ++i) {
+		if (workers[i].job != NULL) pthread_join(workers[i].thread, NULL);
+	}
+}
+
+/* Counts skipped tiles and merges results. Errors of tiles are reported only if no tile produced results. */
+static RecognizerErrorStatus collectResults(const TileJob* job, TiledResults* results) {
+	RecognizerErrorStatus status = RECOGNIZER_ERROR_STATUS_SUCCESS;
+	size_t i;
+
+	for (i = 0; i < job->numTiles; ++i) {
+		if (job->skipped[i]) ++results->numSkipped;
+	}
+	for (i = 0; i < job->numTiles && results->lists[i] == NULL; ++i) {
+		if (!job->skipped[i] && status == RECOGNIZER_ERROR_STATUS_SUCCESS) status = job->statuses[i];
+	}
+	if (i == job->numTiles) return status;
+	return mergeResults(results, job->tiles);
+}
+
+void tileOptionsInit(TileOptions* options) {
+	options->tileSize = DEFAULT_TILE_SIZE;
+	options->overlap = DEFAULT_TILE_SIZE / 2;
+	options->objectSize = DEFAULT_OBJECT_SIZE;
+	options->deadlineMs = 0.0;
+}
+
+RecognizerErrorStatus recognizeRegions(const Recognizer* const* recognizers, size_t numRecognizers,
+		const RecognizerImage* image, const PPRectangle* regions, size_t numRegions, double deadlineMs,
+		TiledResults* results) {
+	return recognizeClassifiedRegions(recognizers, numRecognizers, 1, image, regions, NULL, numRegions, deadlineMs,
+			results);
+}
+
+RecognizerErrorStatus recognizeClassifiedRegions(const Recognizer* const* recognizers, size_t numRecognizers,
+		size_t numClasses, const RecognizerImage* image, const PPRectangle* regions, const size_t* classes,
+		size_t numRegions, double deadlineMs, TiledResults* results) {
+	TileJob job;
+	TileWorker* workers;
+	RecognizerErrorStatus status;
+	size_t i;
+
+	if (results == NULL) return RECOGNIZER_ERROR_STATUS_POINTER_IS_NULL;
+	memset(results, 0, sizeof(*results));
+	if (recognizers == NULL || numRecognizers == 0 || image == NULL || regions == NULL) {
+		return RECOGNIZER_ERROR_STATUS_POINTER_IS_NULL;
+	}
+	if (numRegions == 0) return RECOGNIZER_ERROR_STATUS_SUCCESS;
+	if (numClasses == 0) return RECOGNIZER_ERROR_STATUS_INDEX_OUT_OF_RANGE;
+	for (i = 0; classes != NULL && i < numRegions; ++i) {
+		if (classes[i] >= numClasses) return RECOGNIZER_ERROR_STATUS_INDEX_OUT_OF_RANGE;
+	}
+
+	memset(&job, 0, sizeof(job));
+	job.image = image;
+	job.deadlineMs = deadlineMs;
+	job.tiles = regions;
+	job.numTiles = numRegions;
+	job.classes = classes;
+	status = recognizerImageGetWidth(image, &job.width);
+	if (status == RECOGNIZER_ERROR_STATUS_SUCCESS) status = recognizerImageGetHeight(image, &job.height);
+	if (status != RECOGNIZER_ERROR_STATUS_SUCCESS) return status;
+	for (i = 0; i < numRegions; ++i) {
+		if (!regionInImage(&regions[i], job.width, job.height)) return RECOGNIZER_ERROR_STATUS_INDEX_OUT_OF_RANGE;
+	}
+
+	workers = (TileWorker*) calloc(numRecognizers, sizeof(TileWorker));
+	results->lists = (RecognizerResultList**) calloc(numRegions, sizeof(RecognizerResultList*));
+	results->tileMs = (double*) calloc(numRegions, sizeof(double));
+	job.statuses = (RecognizerErrorStatus*) calloc(numRegions, sizeof(RecognizerErrorStatus));
+	job.skipped = (unsigned char*) calloc(numRegions, 1);
+	job.order = (size_t*) malloc(numRegions * sizeof(size_t));
+	if (workers == NULL || results->lists == NULL || results->tileMs == NULL || job.statuses == NULL
+			|| job.skipped == NULL || job.order == NULL) {
+		status = RECOGNIZER_ERROR_STATUS_FAIL;
+	} else {
+		results->numTiles = numRegions;
+		job.lists = results->lists;
+		job.tileMs = results->tileMs;
+		orderTiles(&job);
+		runTiles(&job, recognizers, numRecognizers, numClasses, workers);
+		status = collectResults(&job, results);
+	}
+
+	free(workers);
+	free(job.statuses);
+	free(job.skipped);
+	free(job.order);
+	return status;
+}
+
+RecognizerErrorStatus recognizeTiled(const Recognizer* const* recognizers, size_t numRecognizers,
+		const RecognizerImage* image, const TileOptions* options, TiledResults* results) {
+	TileOptions defaults;
+	PPRectangle* tiles;
+	int* xs;
+	int* ys;
+	int width, height, tileSize, step;
+	size_t numX, numY, x, y;
+	RecognizerErrorStatus status;
+
+	if (results == NULL) return RECOGNIZER_ERROR_STATUS_POINTER_IS_NULL;
+	memset(results, 0, sizeof(*results));
+	if (image == NULL) return RECOGNIZER_ERROR_STATUS_POINTER_IS_NULL;
+
+	if (options == NULL) {
+		tileOptionsInit(&defaults);
+		options = &defaults;
+	}
+
+	status = recognizerImageGetWidth(image, &width);
+	if (status == RECOGNIZER_ERROR_STATUS_SUCCESS) status = recognizerImageGetHeight(image, &height);
+	if (status != RECOGNIZER_ERROR_STATUS_SUCCESS) return status;
+
+	tileSize = options->tileSize > 0 ? options->tileSize : DEFAULT_TILE_SIZE;
+	/* an object crossing a tile edge is whole in the neighbouring tile only if the overlap can hold it */
+	if (options->overlap < 0 || options->overlap >= tileSize || options->overlap < options->objectSize) {
+		return RECOGNIZER_ERROR_STATUS_INDEX_OUT_OF_RANGE;
+	}
+	step = tileSize - options->overlap;
+
+	numX = tileOffsets(width, tileSize, step, NULL);
+	numY = tileOffsets(height, tileSize, step, NULL);
+	xs = (int*) malloc(numX * sizeof(int));
+	ys = (int*) malloc(numY * sizeof(int));
+	tiles = (PPRectangle*) malloc(numX * numY * sizeof(PPRectangle));
+	if (xs == NULL || ys == NULL || tiles == NULL) {
+		status = RECOGNIZER_ERROR_STATUS_FAIL;
+	} else {
+		tileOffsets(width, tileSize, step, xs);
+		tileOffsets(height, tileSize, step, ys);
+		for (y = 0; y < numY; ++y) {
+			for (x = 0; x < numX; ++x) {
+				PPRectangle* tile = &tiles[y * numX + x];
+				tile->x = (float) xs[x];
+				tile->y = (float) ys[y];
+				tile->width = (float) (width < tileSize ? width : tileSize);
+				tile->height = (float) (height < tileSize ? height : tileSize);
+			}
+		}
+		status = recognizeRegions(recognizers, numRecognizers, image, tiles, numX * numY, options->deadlineMs, results);
+	}
+
+	free(xs);
+	free(ys);
+	free(tiles);
+	return status;
+}
+
+RecognizerErrorStatus tiledResultsTerm(TiledResults* results) {
+	size_t i;
+
+	if (results == NULL) return RECOGNIZER_ERROR_STATUS_POINTER_IS_NULL;
+
+	for (i = 0; i < results->numTiles; ++i) {
+		if (results->lists[i] != NULL) recognizerResultListDelete(&results->lists[i]);
+	}
+	free(results->lists);
+	free(results->tileMs);
+	free(results->results);
+	free(results->regions);
+	free(results->tileIndices);
+	memset(results, 0, sizeof(*results));
+	return RECOGNIZER_ERROR_STATUS_SUCCESS;
+}
@@ -0,0 +1,155 @@
+#define _XOPEN_SOURCE 600
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "RecognizerApi.h"
+#include "RecognizeOptions.h"
+#include "RecognizerProfiles.h"
+#include "Code2DLocator.h"
+#include "StructuredAppend.h"
+#include "DemoUtil.h"
+
+#define MAX_PATH_LENGTH 4096
+
+static void usage(const char* program) {
+	fprintf(stderr, "usage %s [-j threads] [-f max_frames] [-k license_key] [file...]\n", program);
+	fprintf(stderr, "Recognizes images in order as frames of one video, decoding all 2D symbols of a frame in parallel, and joins\n");
+	fprintf(stderr, "structured append sequences of QR symbols only; macro PDF417, Data Matrix and Aztec sequences are not joined.\n");
+	fprintf(stderr, "Files are given as arguments, or listed one per line on stdin. One JSON line is written per joined message.\n");
+	fprintf(stderr, "With -f, sequences are gathered across frames until not extended for the given number of frames; by default\n");
+	fprintf(stderr, "all symbols of a sequence must be in one image.\n");
+}
+
+int main(int argc, char* argv[]) {
+	const char* licenseKey = "Add license key here";
+	long numThreads = sysconf(_SC_NPROCESSORS_ONLN);
+	long maxAgeFrames = 0;
+	char path[MAX_PATH_LENGTH];
+	char* const* files;
+	RecognizerSettings* settings;
+	RecognizerDeviceInfo* deviceInfo;
+	RecognizerProfile base;
+	RecognizerProfile* profiles;
+	RecognizerProfileCache cache;
+	RecognizerErrorStatus status;
+	StructuredAppend assembler;
+	unsigned long frame = 0, numFailed = 0, numSymbols = 0;
+	double recognitionMs = 0.0;
+	int index = 0, opt;
+	long t;
+	size_t s;
+
+	while ((opt = getopt(argc, argv, "j:f:k:h")) != -1) {
+		switch (opt) {
+		case 'j':
+			numThreads = atol(optarg);
+			break;
+		case 'f':
+			maxAgeFrames = atol(optarg);
+			break;
+		case 'k':
+			licenseKey = optarg;
+			break;
+		default:
+			usage(argv[0]);
+			return -1;
+		}
+	}
+	if (numThreads < 1) numThreads = 1;
+	if (maxAgeFrames < 0) {
+		usage(argv[0]);
+		return -1;
+	}
+	/* paths come from stdin only when no file is given */
+	files = optind < argc ? argv + optind : NULL;
+
+	recognizerSettingsCreate(&settings);
+	recognizerDeviceInfoCreate(&deviceInfo);
+	/* parallelism comes from decoding symbols on separate threads, so each recognizer gets one processor */
+	recognizerDeviceInfoSetNumberOfProcessors(deviceInfo, 1);
+	recognizerSettingsSetDeviceInfo(settings, deviceInfo);
+	recognizerSettingsSetLicenseKey(settings, licenseKey);
+
+	/* recognizeCodes2D takes one recognizer per symbology on each thread, and one reading all of them */
+	profiles = (RecognizerProfile*) malloc((size_t) numThreads * CODE2D_SYMBOLOGY_COUNT * sizeof(RecognizerProfile));
+	if (profiles == NULL) {
+		fprintf(stderr, "Out of memory\n");
+		return -1;
+	}
+	recognizerProfileInit(&base);
+	for (t = 0; t < numThreads; ++t) {
+		for (s = 0; s < CODE2D_SYMBOLOGY_COUNT; ++s) {
+			code2DProfile(&base, (Code2DSymbology) s, &profiles[(size_t) t * CODE2D_SYMBOLOGY_COUNT + s]);
+		}
+	}
+	status = recognizerProfileCacheInit(&cache, settings, profiles, (size_t) numThreads * CODE2D_SYMBOLOGY_COUNT);
+	free(profiles);
+	if (status != RECOGNIZER_ERROR_STATUS_SUCCESS) {
+		fprintf(stderr, "Error creating recognizers: %s\n", recognizerErrorToString(status));
+		return -1;
+	}
+
+	structuredAppendInit(&assembler, (unsigned long) maxAgeFrames);
+	while (demoNextPath(files, argc - optind, &index, path, sizeof(path))) {
+		RecognizerImage* image = NULL;
+		TiledResults results;
+		double start;
+		size_t i;
+
+		status = recognizerImageCreateFromFile(&image, path);
+		if (status == RECOGNIZER_ERROR_STATUS_SUCCESS) {
+			start = recognizeMonotonicMs();
+			status = recognizeCodes2D((const Recognizer* const*) cache.recognizers, (size_t) numThreads, image, NULL,
+					0.0, &results, NULL);
+			recognitionMs += recognizeMonotonicMs() - start;
+			recognizerImageDelete(&image);
+
+			for (i = 0; status == RECOGNIZER_ERROR_STATUS_SUCCESS && i < results.numResults; ++i) {
+				unsigned char* message = NULL;
+				size_t messageSize = 0;
+				RecognizerErrorStatus added;
+
+				++numSymbols;
+				added = structuredAppendAddResult(&assembler, results.results[i], &message, &messageSize);
+				if (added == RECOGNIZER_ERROR_STATUS_FAIL) {
+					printf("{\"frame\":%lu,\"file\":", frame);
+					jsonPrintString(path, strlen(path));
+					printf(",\"error\":\"parity mismatch\"}\n");
+				} else if (message != NULL) {
+					printf("{\"frame\":%lu,\"file\":", frame);
+					jsonPrintString(path, strlen(path));
+					printf(",\"message\":");
+					jsonPrintString((const char*) message, messageSize);
+					printf("}\n");
+					free(message);
+				}
+			}
+			tiledResultsTerm(&results);
+		}
+		if (status != RECOGNIZER_ERROR_STATUS_SUCCESS) {
+			++numFailed;
+			fprintf(stderr, "%s: %s\n", path, recognizerErrorToString(status));
+		}
+		structuredAppendNextFrame(&assembler);
+		++frame;
+	}
+
+	fprintf(stderr, "Recognized %lu frames (%lu failed) in %.1f ms, %lu symbols\n", frame, numFailed, recognitionMs,
+			numSymbols);
+	fprintf(stderr, "Segments: %lu, duplicates: %lu, messages: %lu, parity errors: %lu, expired sequences: %lu, incomplete: %lu\n",
+			assembler.numSegments, assembler.numDuplicates, assembler.numCompleted, assembler.numParityErrors,
+			assembler.numExpired, (unsigned long) assembler.numSets);
+	if (assembler.numDecodedRaw > 0) {
+		fprintf(stderr, "%lu QR symbols reported decoded text as raw data, structured append headers could not be read\n",
+				assembler.numDecodedRaw);
+	}
+
+	structuredAppendTerm(&assembler);
+	recognizerProfileCacheTerm(&cache);
+	recognizerDeviceInfoDelete(&deviceInfo);
+	recognizerSettingsDelete(&settings);
+	return 0;
+}
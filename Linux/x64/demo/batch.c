@@ -0,0 +1,463 @@
+#define _XOPEN_SOURCE 600
+
+#include <dirent.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "RecognizerApi.h"
+#include "RecognizeOptions.h"
+#include "BarcodeEffort.h"
+#include "RecognizerProfiles.h"
+#include "MRTDFields.h"
+#include "USDLFields.h"
+#include "DemoUtil.h"
+
+#define MAX_PATH_LENGTH 4096
+
+/* Source of image paths shared by all workers. Paths are taken one at a time, so arbitrarily long lists are
+never held in memory. */
+typedef struct PathSource {
+	pthread_mutex_t mutex;
+	/* directory being listed, or NULL when paths are read from list */
+	DIR* dir;
+	const char* dirPath;
+	/* file with one path per line */
+	FILE* list;
+} PathSource;
+
+typedef struct WorkerStats {
+	size_t numFiles;
+	size_t numFailed;
+	size_t numResults;
+	size_t numValid;
+	double recognitionMs;
+	double maxRecognitionMs;
+} WorkerStats;
+
+typedef struct Worker {
+	pthread_t thread;
+	Recognizer* recognizer;
+	/* ladder of barcode passes used instead of recognizer when useEffort is set */
+	BarcodeEffort effort;
+	int useEffort;
+	size_t maxLevel;
+	PathSource* source;
+	WorkerStats stats;
+} Worker;
+
+/* serializes lines written to stdout, so that lines of different workers are never interleaved */
+static pthread_mutex_t outputMutex = PTHREAD_MUTEX_INITIALIZER;
+
+static int nextPath(PathSource* source, char* path, size_t capacity) {
+	int found = 0;
+
+	pthread_mutex_lock(&source->mutex);
+	if (source->dir != NULL) {
+		struct dirent* entry;
+		while (!found && (entry = readdir(source->dir)) != NULL) {
+			int length;
+			if (entry->d_name[0] == '.') continue;
+			length = snprintf(path, capacity, "%s/%s", source->dirPath, entry->d_name);
+			if (length < 0 || (size_t) length >= capacity) {
+				fprintf(stderr, "%s/%s: path too long, skipped\n", source->dirPath, entry->d_name);
+				continue;
+			}
+			found = 1;
+		}
+	} else {
+		found = demoReadPath(source->list, path, capacity);
+	}
+	pthread_mutex_unlock(&source->mutex);
+	return found;
+}
+
+static StringView viewOf(const char* str) {
+	StringView view;
+	view.data = str != NULL ? str : "";
+	view.length = strlen(view.data);
+	return view;
+}
+
+static void appendMrtdFields(JsonBuffer* json, const RecognizerResult* result) {
+	MRTDFields f;
+	int first = 1;
+
+	if (mrtdFieldsFromResult(&f, result) != RECOGNIZER_ERROR_STATUS_SUCCESS) return;
+	jsonAppendField(json, &first, "documentCode", f.documentCode);
+	jsonAppendField(json, &first, "issuer", f.issuer);
+	jsonAppendField(json, &first, "documentNumber", f.documentNumber);
+	jsonAppendField(json, &first, "primaryID", f.primaryID);
+	jsonAppendField(json, &first, "secondaryID", f.secondaryID);
+	jsonAppendField(json, &first, "nationality", f.nationality);
+	jsonAppendField(json, &first, "sex", f.sex);
+	jsonAppendField(json, &first, "dateOfBirth", f.dateOfBirth);
+	jsonAppendField(json, &first, "dateOfExpiry", f.dateOfExpiry);
+	jsonAppendField(json, &first, "opt1", f.opt1);
+	jsonAppendField(json, &first, "opt2", f.opt2);
+	jsonAppendField(json, &first, "rawData", f.rawData);
+}
+
+static void appendUsdlFields(JsonBuffer* json, const RecognizerResult* result) {
+	USDLFieldTable table;
+	int first = 1;
+	int i;
+
+	if (usdlFieldTableFill(&table, result) != RECOGNIZER_ERROR_STATUS_SUCCESS) return;
+	for (i = 0; i < USDL_FIELD_COUNT; ++i) {
+		jsonAppendField(json, &first, usdlFieldKey((UsdlFieldId) i), table.fields[i]);
+	}
+}
+
+static void appendResult(JsonBuffer* json, const RecognizerResult* result, WorkerStats* stats) {
+	int is = 0;
+	int valid = 0;
+	int first = 1;
+	const char* type = "unknown";
+	const char* str = NULL;
+
+	recognizerResultIsResultValid(result, &valid);
+	if (valid) ++stats->numValid;
+
+	jsonAppendText(json, "{\"type\":");
+	if (recognizerResultIsMRTDResult(result, &is) == RECOGNIZER_ERROR_STATUS_SUCCESS && is) {
+		jsonAppendText(json, "\"mrtd\",\"fields\":{");
+		appendMrtdFields(json, result);
+	} else if (recognizerResultIsUSDLResult(result, &is) == RECOGNIZER_ERROR_STATUS_SUCCESS && is) {
+		jsonAppendText(json, "\"usdl\",\"fields\":{");
+		appendUsdlFields(json, result);
+	} else if (recognizerResultIsMyKadResult(result, &is) == RECOGNIZER_ERROR_STATUS_SUCCESS && is) {
+		jsonAppendText(json, "\"mykad\",\"fields\":{");
+		if (recognizerResultGetMyKadFullName(result, &str) == RECOGNIZER_ERROR_STATUS_SUCCESS) jsonAppendField(json, &first, "fullName", viewOf(str));
+		if (recognizerResultGetMyKadAddress(result, &str) == RECOGNIZER_ERROR_STATUS_SUCCESS) jsonAppendField(json, &first, "address", viewOf(str));
+		if (recognizerResultGetMyKadReligion(result, &str) == RECOGNIZER_ERROR_STATUS_SUCCESS) jsonAppendField(json, &first, "religion", viewOf(str));
+		if (recognizerResultGetMyKadSex(result, &str) == RECOGNIZER_ERROR_STATUS_SUCCESS) jsonAppendField(json, &first, "sex", viewOf(str));
+		if (recognizerResultGetMyKadBirthDate(result, &str) == RECOGNIZER_ERROR_STATUS_SUCCESS) jsonAppendField(json, &first, "birthDate", viewOf(str));
+		if (recognizerResultGetMyKadNricNumber(result, &str) == RECOGNIZER_ERROR_STATUS_SUCCESS) jsonAppendField(json, &first, "nricNumber", viewOf(str));
+	} else {
+		if (recognizerResultIsPdf417Result(result, &is) == RECOGNIZER_ERROR_STATUS_SUCCESS && is) type = "pdf417";
+		else if (recognizerResultIsZXingResult(result, &is) == RECOGNIZER_ERROR_STATUS_SUCCESS && is) type = "zxing";
+		else if (recognizerResultIsBardecoderResult(result, &is) == RECOGNIZER_ERROR_STATUS_SUCCESS && is) type = "bardecoder";
+		jsonAppendString(json, type, strlen(type));
+		jsonAppendText(json, ",\"fields\":{");
+		if (recognizerResultGetBarcodeStringData(result, &str) == RECOGNIZER_ERROR_STATUS_SUCCESS) {
+			jsonAppendField(json, &first, "stringData", viewOf(str));
+		}
+	}
+	jsonAppendText(json, valid ? "},\"valid\":true}" : "},\"valid\":false}");
+}
+
+static void writeLine(JsonBuffer* json, const char* path, const char* error) {
+	pthread_mutex_lock(&outputMutex);
+	if (json->failed || error != NULL) {
+		JsonBuffer line;
+		memset(&line, 0, sizeof(line));
+		jsonAppendText(&line, "{\"file\":");
+		jsonAppendString(&line, path, strlen(path));
+		jsonAppendText(&line, ",\"error\":");
+		jsonAppendString(&line, error != NULL ? error : "out of memory", strlen(error != NULL ? error : "out of memory"));
+		jsonAppendText(&line, "}");
+		if (!line.failed) puts(line.data);
+		free(line.data);
+	} else {
+		puts(json->data);
+	}
+	pthread_mutex_unlock(&outputMutex);
+}
+
+static void* workerRun(void* arg) {
+	Worker* worker = (Worker*) arg;
+	char path[MAX_PATH_LENGTH];
+	JsonBuffer json;
+
+	memset(&json, 0, sizeof(json));
+
+	while (nextPath(worker->source, path, sizeof(path))) {
+		RecognizerImage* image = NULL;
+		RecognizerResultList* resultList = NULL;
+		RecognizerErrorStatus status;
+		size_t numResults = 0;
+		size_t level = 0;
+		size_t i;
+		unsigned long rejected = 0;
+		double start, elapsed;
+		char timing[96];
+
+		++worker->stats.numFiles;
+		json.size = 0;
+		json.failed = 0;
+
+		status = recognizerImageCreateFromFile(&image, path);
+		if (status != RECOGNIZER_ERROR_STATUS_SUCCESS) {
+			++worker->stats.numFailed;
+			writeLine(&json, path, recognizerErrorToString(status));
+			continue;
+		}
+
+		start = recognizeMonotonicMs();
+		if (worker->useEffort) {
+			rejected = worker->effort.screenStats.numRejectedImages;
+			status = recognizeWithEffort(&worker->effort, worker->maxLevel, &resultList, image, NULL, &level);
+		} else {
+			status = recognizerRecognizeFromImage(worker->recognizer, &resultList, image, 0, NULL);
+		}
+		elapsed = recognizeMonotonicMs() - start;
+		recognizerImageDelete(&image);
+		if (worker->useEffort && worker->effort.screenStats.numRejectedImages > rejected) {
+			/* screening found no bar texture, so no level was run */
+			worker->stats.recognitionMs += elapsed;
+			jsonAppendText(&json, "{\"file\":");
+			jsonAppendString(&json, path, strlen(path));
+			snprintf(timing, sizeof(timing), ",\"ms\":%.3f,\"rejected\":true,\"results\":[]}", elapsed);
+			jsonAppendText(&json, timing);
+			writeLine(&json, path, NULL);
+			continue;
+		}
+		if (status == RECOGNIZER_ERROR_STATUS_SUCCESS && resultList == NULL) {
+			/* no level of the barcode ladder produced a result list */
+			status = RECOGNIZER_ERROR_STATUS_FAIL;
+		}
+		if (status != RECOGNIZER_ERROR_STATUS_SUCCESS) {
+			++worker->stats.numFailed;
+			writeLine(&json, path, recognizerErrorToString(status));
+			continue;
+		}
+
+		worker->stats.recognitionMs += elapsed;
+		if (elapsed > worker->stats.maxRecognitionMs) worker->stats.maxRecognitionMs = elapsed;
+
+		recognizerResultListGetNumOfResults(resultList, &numResults);
+		jsonAppendText(&json, "{\"file\":");
+		jsonAppendString(&json, path, strlen(path));
+		/* an empty list of the ladder comes from no particular level, so it gets none */
+		if (worker->useEffort && numResults > 0) {
+			snprintf(timing, sizeof(timing), ",\"ms\":%.3f,\"level\":%lu,\"results\":[", elapsed, (unsigned long) level);
+		} else {
+			snprintf(timing, sizeof(timing), ",\"ms\":%.3f,\"results\":[", elapsed);
+		}
+		jsonAppendText(&json, timing);
+		for (i = 0; i < numResults; ++i) {
+			RecognizerResult* result;
+			if (recognizerResultListGetResultAtIndex(resultList, i, &result) != RECOGNIZER_ERROR_STATUS_SUCCESS) continue;
+			if (i > 0) jsonAppend(&json, ",", 1);
+			appendResult(&json, result, &worker->stats);
+		}
+		jsonAppendText(&json, "]}");
+		worker->stats.numResults += numResults;
+		recognizerResultListDelete(&resultList);
+
+		writeLine(&json, path, NULL);
+	}
+
+	free(json.data);
+	return NULL;
+}
+
+static void usage(const char* program) {
+	fprintf(stderr, "usage %s [-j threads] [-t mrtd,usdl,pdf417,zxing,bardecoder,mykad] [-e max_effort_level] [-s] [-m ocr_model] [-k license_key] [dir]\n", program);
+	fprintf(stderr, "Recognizes all images in dir, or images listed one per line on stdin, and writes one JSON line per image.\n");
+	fprintf(stderr, "With -e, barcodes are scanned with increasing effort (0 plain, 1 rotated, 2 inverse, 3 thorough) up to the given level.\n");
+	fprintf(stderr, "With -s, images are first screened for bar texture; images without it are not decoded, and the others are\n");
+	fprintf(stderr, "decoded only within the screened region. Requires -e and barcode types only.\n");
+}
+
+int main(int argc, char* argv[]) {
+	const char* modelPath = "../libRecognizerApi/res/ocr_model.zzip";
+	const char* licenseKey = "Add license key here";
+	const char* types = "mrtd";
+	long numWorkers = sysconf(_SC_NPROCESSORS_ONLN);
+	long maxEffortLevel = -1;
+	unsigned long levelSuccesses[BARCODE_EFFORT_MAX_LEVELS];
+	unsigned long levelAttempts[BARCODE_EFFORT_MAX_LEVELS];
+	unsigned long effortFailures = 0;
+	unsigned long inverseImages = 0;
+	BarcodeScreenStats screenStats;
+	int screen = 0;
+	size_t numLevels = 0, l;
+	char* ocrModel;
+	int ocrModelLength;
+	RecognizerSettings* settings;
+	RecognizerDeviceInfo* deviceInfo;
+	RecognizerProfile profile;
+	RecognizerErrorStatus status;
+	PathSource source;
+	Worker* workers;
+	WorkerStats total;
+	double start, wallMs;
+	long i;
+	int opt;
+
+	while ((opt = getopt(argc, argv, "j:t:e:sm:k:h")) != -1) {
+		switch (opt) {
+		case 'j':
+			numWorkers = atol(optarg);
+			break;
+		case 'e':
+			maxEffortLevel = atol(optarg);
+			break;
+		case 's':
+			screen = 1;
+			break;
+		case 't':
+			types = optarg;
+			break;
+		case 'm':
+			modelPath = optarg;
+			break;
+		case 'k':
+			licenseKey = optarg;
+			break;
+		default:
+			usage(argv[0]);
+			return -1;
+		}
+	}
+	if (numWorkers < 1) numWorkers = 1;
+	if (screen && maxEffortLevel < 0) {
+		usage(argv[0]);
+		return -1;
+	}
+
+	recognizerProfileInit(&profile);
+	if (!recognizerProfileParseTypes(&profile, types)) {
+		usage(argv[0]);
+		return -1;
+	}
+
+	memset(&source, 0, sizeof(source));
+	pthread_mutex_init(&source.mutex, NULL);
+	if (optind < argc) {
+		source.dirPath = argv[optind];
+		source.dir = opendir(source.dirPath);
+		if (source.dir == NULL) {
+			fprintf(stderr, "Could not open directory %s\n", source.dirPath);
+			return -1;
+		}
+	} else {
+		source.list = stdin;
+	}
+
+	/* OCR model is loaded once and shared by recognizers of all workers */
+	status = recognizerLoadFileToBuffer(modelPath, &ocrModel, &ocrModelLength);
+	if (status != RECOGNIZER_ERROR_STATUS_SUCCESS) {
+		fprintf(stderr, "Could not load file %s\n", modelPath);
+		return -1;
+	}
+
+	recognizerSettingsCreate(&settings);
+	recognizerDeviceInfoCreate(&deviceInfo);
+	/* parallelism comes from workers, so each recognizer gets its share of processors to avoid oversubscription */
+	recognizerDeviceInfoSetNumberOfProcessors(deviceInfo, numWorkers > 1 ? 1 : (unsigned int) sysconf(_SC_NPROCESSORS_ONLN));
+	recognizerSettingsSetDeviceInfo(settings, deviceInfo);
+	recognizerSettingsSetZicerModel(settings, ocrModel, ocrModelLength);
+	recognizerSettingsSetLicenseKey(settings, licenseKey);
+	recognizerProfileApply(&profile, settings);
+
+	workers = (Worker*) calloc((size_t) numWorkers, sizeof(Worker));
+	if (workers == NULL) {
+		fprintf(stderr, "Out of memory\n");
+		return -1;
+	}
+
+	/* every worker owns a recognizer, so recognitions never contend for the same object */
+	for (i = 0; i < numWorkers; ++i) {
+		if (maxEffortLevel >= 0) {
+			workers[i].useEffort = 1;
+			workers[i].maxLevel = (size_t) maxEffortLevel;
+			status = barcodeEffortInit(&workers[i].effort, settings, &profile, NULL, 0);
+			workers[i].effort.detectPolarity = 1;
+			if (status == RECOGNIZER_ERROR_STATUS_SUCCESS && screen
+					&& barcodeEffortEnableScreen(&workers[i].effort, &profile) != RECOGNIZER_ERROR_STATUS_SUCCESS) {
+				fprintf(stderr, "Screening applies only to barcode types (usdl, pdf417, zxing, bardecoder)\n");
+				return -1;
+			}
+		} else {
+			status = recognizerCreate(&workers[i].recognizer, settings);
+		}
+		if (status != RECOGNIZER_ERROR_STATUS_SUCCESS) {
+			fprintf(stderr, "Error creating recognizer: %s\n", recognizerErrorToString(status));
+			return -1;
+		}
+		workers[i].source = &source;
+	}
+
+	start = recognizeMonotonicMs();
+	for (i = 0; i < numWorkers; ++i) {
+		pthread_create(&workers[i].thread, NULL, workerRun, &workers[i]);
+	}
+
+	memset(&total, 0, sizeof(total));
+	memset(levelSuccesses, 0, sizeof(levelSuccesses));
+	memset(levelAttempts, 0, sizeof(levelAttempts));
+	memset(&screenStats, 0, sizeof(screenStats));
+	for (i = 0; i < numWorkers; ++i) {
+		pthread_join(workers[i].thread, NULL);
+		if (workers[i].useEffort) {
+			numLevels = workers[i].effort.numLevels;
+			for (l = 0; l < numLevels; ++l) {
+				levelSuccesses[l] += workers[i].effort.successes[l];
+				levelAttempts[l] += workers[i].effort.attempts[l];
+			}
+			effortFailures += workers[i].effort.failures;
+			inverseImages += workers[i].effort.inverseImages;
+			for (l = 0; l < BARCODE_SCREEN_VERDICT_COUNT; ++l) {
+				screenStats.cells[l] += workers[i].effort.screenStats.cells[l];
+			}
+			screenStats.numImages += workers[i].effort.screenStats.numImages;
+			screenStats.numRejectedImages += workers[i].effort.screenStats.numRejectedImages;
+			screenStats.screenMs += workers[i].effort.screenStats.screenMs;
+		}
+		total.numFiles += workers[i].stats.numFiles;
+		total.numFailed += workers[i].stats.numFailed;
+		total.numResults += workers[i].stats.numResults;
+		total.numValid += workers[i].stats.numValid;
+		total.recognitionMs += workers[i].stats.recognitionMs;
+		if (workers[i].stats.maxRecognitionMs > total.maxRecognitionMs) total.maxRecognitionMs = workers[i].stats.maxRecognitionMs;
+	}
+	wallMs = recognizeMonotonicMs() - start;
+
+	/* statistics go to stderr, so that stdout stays valid newline delimited JSON */
+	fprintf(stderr, "Processed %lu files (%lu failed) with %ld workers in %.1f s, %.2f files/s\n",
+			(unsigned long) total.numFiles, (unsigned long) total.numFailed, numWorkers, wallMs / 1000.0,
+			wallMs > 0.0 ? total.numFiles * 1000.0 / wallMs : 0.0);
+	fprintf(stderr, "Results: %lu, valid: %lu\n", (unsigned long) total.numResults, (unsigned long) total.numValid);
+	if (total.numFiles > total.numFailed) {
+		fprintf(stderr, "Recognition time: average %.1f ms, max %.1f ms\n",
+				total.recognitionMs / (total.numFiles - total.numFailed), total.maxRecognitionMs);
+	}
+	for (l = 0; l < numLevels && l <= (size_t) maxEffortLevel; ++l) {
+		fprintf(stderr, "Effort level %lu: run on %lu images, first valid result on %lu\n", (unsigned long) l,
+				levelAttempts[l], levelSuccesses[l]);
+	}
+	if (numLevels > 0) {
+		fprintf(stderr, "No valid result at any level: %lu\n", effortFailures);
+		fprintf(stderr, "Images with inverse codes: %lu\n", inverseImages);
+	}
+	if (screenStats.numImages > 0) {
+		fprintf(stderr, "Screened %lu images in %.1f ms, rejected without decoding: %lu\n", screenStats.numImages,
+				screenStats.screenMs, screenStats.numRejectedImages);
+		fprintf(stderr, "Screened cells:");
+		for (l = 0; l < BARCODE_SCREEN_VERDICT_COUNT; ++l) {
+			fprintf(stderr, " %s %lu", barcodeScreenVerdictToString((BarcodeScreenVerdict) l), screenStats.cells[l]);
+		}
+		fprintf(stderr, "\n");
+	}
+
+	for (i = 0; i < numWorkers; ++i) {
+		if (workers[i].useEffort) {
+			barcodeEffortTerm(&workers[i].effort);
+		} else {
+			recognizerDelete(&workers[i].recognizer);
+		}
+	}
+	free(workers);
+	if (source.dir != NULL) closedir(source.dir);
+	pthread_mutex_destroy(&source.mutex);
+	recognizerDeviceInfoDelete(&deviceInfo);
+	recognizerSettingsDelete(&settings);
+	recognizerFreeFileBuffer(&ocrModel);
+
+	return 0;
+}
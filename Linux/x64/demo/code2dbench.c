@@ -0,0 +1,239 @@
+#define _XOPEN_SOURCE 600
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "Code2DLocator.h"
+#include "RecognizeOptions.h"
+
+#define MAX_CANDIDATES 32
+#define NUM_SYMBOLS 3
+
+static const char* const symbologyNames[] = { "QR", "Aztec", "DataMatrix" };
+
+/* Symbol in modules: one byte per module, non-zero for dark modules */
+typedef struct Symbol {
+	unsigned char modules[64 * 64];
+	int size;
+} Symbol;
+
+/* Symbol placed on the image */
+typedef struct Placement {
+	const Symbol* symbol;
+	Code2DSymbology symbology;
+	double x;
+	double y;
+	double module;
+	double angle;
+} Placement;
+
+static void fillRandom(Symbol* symbol) {
+	int i;
+	for (i = 0; i < symbol->size * symbol->size; ++i) symbol->modules[i] = (unsigned char) (rand() % 2);
+}
+
+static void setModule(Symbol* symbol, int x, int y, int dark) {
+	symbol->modules[y * symbol->size + x] = (unsigned char) dark;
+}
+
+/* QR finder pattern with its light separator, top left corner of the 7x7 pattern at (x, y) */
+static void drawFinder(Symbol* symbol, int x, int y) {
+	int i, j;
+
+	for (j = -1; j <= 7; ++j) {
+		for (i = -1; i <= 7; ++i) {
+			/* distance from the border of the pattern: 0 dark frame, 1 light ring, 2 and 3 dark centre */
+			int ringX = i < 3 ? i : 6 - i, ringY = j < 3 ? j : 6 - j;
+			int ring = i < 0 || j < 0 || i > 6 || j > 6 ? 1 : (ringX < ringY ? ringX : ringY);
+			if (x + i < 0 || y + j < 0 || x + i >= symbol->size || y + j >= symbol->size) continue;
+			setModule(symbol, x + i, y + j, ring != 1);
+		}
+	}
+}
+
+/* QR symbol of given version with random data */
+static void buildQR(Symbol* symbol, int version) {
+	int i;
+
+	symbol->size = 17 + 4 * version;
+	fillRandom(symbol);
+	drawFinder(symbol, 0, 0);
+	drawFinder(symbol, symbol->size - 7, 0);
+	drawFinder(symbol, 0, symbol->size - 7);
+	for (i = 8; i < symbol->size - 8; ++i) {
+		setModule(symbol, i, 6, i % 2 == 0);
+		setModule(symbol, 6, i, i % 2 == 0);
+	}
+}
+
+/* Compact Aztec symbol of given layers with random data around a 9x9 bullseye */
+static void buildAztec(Symbol* symbol, int layers) {
+	int centre, i, j;
+
+	symbol->size = 11 + 4 * layers;
+	centre = symbol->size / 2;
+	fillRandom(symbol);
+	for (j = -5; j <= 5; ++j) {
+		for (i = -5; i <= 5; ++i) {
+			int ring = abs(i) > abs(j) ? abs(i) : abs(j);
+			/* the ring around the bullseye holds the mode message */
+			if (ring <= 4) setModule(symbol, centre + i, centre + j, ring % 2 == 0);
+		}
+	}
+}
+
+/* Square DataMatrix symbol with solid left and bottom edges and alternating top and right edges */
+static void buildDataMatrix(Symbol* symbol, int size) {
+	int i;
+
+	symbol->size = size;
+	fillRandom(symbol);
+	for (i = 0; i < size; ++i) {
+		setModule(symbol, 0, i, 1);
+		setModule(symbol, i, size - 1, 1);
+		setModule(symbol, i, 0, i % 2 == 0);
+		setModule(symbol, size - 1, i, i % 2 == 1);
+	}
+}
+
+/* Renders placed symbols into a gray image with noise, by mapping every pixel back into the symbols */
+static void render(const Placement* placements, size_t numPlacements, unsigned char* pixels, int width,
+		int height) {
+	int x, y;
+	size_t p;
+
+	for (y = 0; y < height; ++y) {
+		for (x = 0; x < width; ++x) {
+			int value = 190;
+
+			for (p = 0; p < numPlacements; ++p) {
+				const Placement* placement = &placements[p];
+				double dx = x + 0.5 - placement->x;
+				double dy = y + 0.5 - placement->y;
+				double u = (dx * cos(placement->angle) + dy * sin(placement->angle)) / placement->module
+						+ placement->symbol->size / 2.0;
+				double v = (-dx * sin(placement->angle) + dy * cos(placement->angle)) / placement->module
+						+ placement->symbol->size / 2.0;
+
+				if (u >= 0.0 && v >= 0.0 && u < placement->symbol->size && v < placement->symbol->size
+						&& placement->symbol->modules[(int) v * placement->symbol->size + (int) u]) {
+					value = 50;
+				}
+			}
+			value += rand() % 41 - 20;
+			pixels[(size_t) y * width + x] = (unsigned char) value;
+		}
+	}
+}
+
+/* Non-zero if a candidate of the symbology holds the centre of the placed symbol */
+static int isLocated(const Placement* placement, const Code2DCandidate* candidates, size_t numCandidates) {
+	size_t i;
+
+	for (i = 0; i < numCandidates; ++i) {
+		const PPRectangle* region = &candidates[i].region;
+		if (candidates[i].symbology == placement->symbology && placement->x >= region->x
+				&& placement->y >= region->y && placement->x <= region->x + region->width
+				&& placement->y <= region->y + region->height) {
+			return 1;
+		}
+	}
+	return 0;
+}
+
+static void usage(const char* program) {
+	fprintf(stderr, "usage %s [-w width] [-h height] [-m module_pixels]\n", program);
+	fprintf(stderr, "Measures localisation of QR, Aztec and DataMatrix symbols placed together on synthetic images.\n");
+}
+
+int main(int argc, char* argv[]) {
+	static const double angles[] = { 0.0, 15.0, 30.0, 45.0, 60.0, 90.0 };
+	int width = 1600, height = 1200;
+	double module = 4.0;
+	unsigned char* pixels;
+	Symbol symbols[NUM_SYMBOLS];
+	Code2DLocatorOptions options;
+	Code2DCandidate candidates[MAX_CANDIDATES];
+	size_t a, misses = 0;
+	int opt;
+
+	while ((opt = getopt(argc, argv, "w:h:m:")) != -1) {
+		switch (opt) {
+		case 'w':
+			width = atoi(optarg);
+			break;
+		case 'h':
+			height = atoi(optarg);
+			break;
+		case 'm':
+			module = atof(optarg);
+			break;
+		default:
+			usage(argv[0]);
+			return -1;
+		}
+	}
+	if (width < 64 || height < 64 || module < 2.0) {
+		usage(argv[0]);
+		return -1;
+	}
+
+	pixels = (unsigned char*) malloc((size_t) width * height);
+	if (pixels == NULL) {
+		fprintf(stderr, "Out of memory\n");
+		return -1;
+	}
+	srand(1);
+	buildQR(&symbols[CODE2D_SYMBOLOGY_QR], 3);
+	buildAztec(&symbols[CODE2D_SYMBOLOGY_AZTEC], 2);
+	buildDataMatrix(&symbols[CODE2D_SYMBOLOGY_DATA_MATRIX], 24);
+	code2DLocatorOptionsInit(&options);
+
+	printf("%dx%d image, %.1f pixels per module\n", width, height, module);
+	printf("angle      ms  candidates  QR  Aztec  DataMatrix\n");
+	for (a = 0; a < sizeof(angles) / sizeof(angles[0]); ++a) {
+		Placement placements[NUM_SYMBOLS];
+		ScanlineImage image;
+		size_t numCandidates = 0, s;
+		int located[NUM_SYMBOLS];
+		double start, elapsed;
+
+		for (s = 0; s < NUM_SYMBOLS; ++s) {
+			placements[s].symbol = &symbols[s];
+			placements[s].symbology = (Code2DSymbology) s;
+			placements[s].x = width * (s + 1) / (NUM_SYMBOLS + 1.0);
+			placements[s].y = height * (s % 2 == 0 ? 0.35 : 0.65);
+			placements[s].module = module;
+			placements[s].angle = angles[a] * 3.14159265358979 / 180.0;
+		}
+		render(placements, NUM_SYMBOLS, pixels, width, height);
+		image.data = pixels;
+		image.width = width;
+		image.height = height;
+		image.bytesPerRow = (size_t) width;
+		image.type = RAW_IMAGE_TYPE_GRAY;
+
+		start = recognizeMonotonicMs();
+		code2DLocate(&image, &options, candidates, MAX_CANDIDATES, &numCandidates);
+		elapsed = recognizeMonotonicMs() - start;
+
+		for (s = 0; s < NUM_SYMBOLS; ++s) {
+			located[s] = isLocated(&placements[s], candidates, numCandidates);
+			if (!located[s]) ++misses;
+		}
+		printf("%5.0f %7.3f %11lu %3s %6s %11s\n", angles[a], elapsed, (unsigned long) numCandidates,
+				located[CODE2D_SYMBOLOGY_QR] ? "yes" : "no", located[CODE2D_SYMBOLOGY_AZTEC] ? "yes" : "no",
+				located[CODE2D_SYMBOLOGY_DATA_MATRIX] ? "yes" : "no");
+		for (s = 0; s < numCandidates; ++s) {
+			const PPRectangle* region = &candidates[s].region;
+			printf("      %-10s %4.0f,%4.0f %4.0fx%-4.0f strength %lu\n", symbologyNames[candidates[s].symbology],
+					region->x, region->y, region->width, region->height, (unsigned long) candidates[s].strength);
+		}
+	}
+
+	free(pixels);
+	return misses == 0 ? 0 : 1;
+}
@@ -0,0 +1,105 @@
+#define _XOPEN_SOURCE 600
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "RecognizeOptions.h"
+#include "MRTDFields.h"
+#include "DemoUtil.h"
+
+/* longest line accepted, an MRZ with separators is far shorter */
+#define MAX_LINE_LENGTH 1024
+
+/* Name of each MRZCheck bit, from the lowest */
+static const char* const checkNames[] = {
+	"documentNumber",
+	"dateOfBirth",
+	"dateOfExpiry",
+	"optionalData",
+	"composite"
+};
+
+static void printField(int* first, const char* name, StringView value) {
+	if (value.length == 0) return;
+	if (!*first) putchar(',');
+	*first = 0;
+	printf("\"%s\":", name);
+	jsonPrintString(value.data, value.length);
+}
+
+static void printFields(const MRTDFields* f) {
+	int first = 1;
+
+	printField(&first, "documentCode", f->documentCode);
+	printField(&first, "issuer", f->issuer);
+	printField(&first, "documentNumber", f->documentNumber);
+	printField(&first, "primaryID", f->primaryID);
+	printField(&first, "secondaryID", f->secondaryID);
+	printField(&first, "nationality", f->nationality);
+	printField(&first, "sex", f->sex);
+	printField(&first, "dateOfBirth", f->dateOfBirth);
+	printField(&first, "dateOfExpiry", f->dateOfExpiry);
+	printField(&first, "opt1", f->opt1);
+	printField(&first, "opt2", f->opt2);
+}
+
+static void usage(const char* program) {
+	fprintf(stderr, "usage %s\n", program);
+	fprintf(stderr, "Parses MRZ texts read from stdin, one per line with MRZ lines concatenated or separated by spaces,\n");
+	fprintf(stderr, "and verifies their check digits without image recognition. One JSON line is written per MRZ.\n");
+}
+
+int main(int argc, char* argv[]) {
+	char line[MAX_LINE_LENGTH];
+	char buffer[MAX_LINE_LENGTH];
+	unsigned long lineNumber = 0, numParsed = 0, numValid = 0;
+	double parseMs = 0.0;
+
+	if (getopt(argc, argv, "h") != -1 || optind < argc) {
+		usage(argv[0]);
+		return -1;
+	}
+
+	while (fgets(line, sizeof(line), stdin) != NULL) {
+		MRTDFields fields;
+		unsigned int failed = 0;
+		RecognizerErrorStatus status;
+		double start;
+		size_t length = strlen(line), i;
+
+		++lineNumber;
+		while (length > 0 && (line[length - 1] == '\n' || line[length - 1] == '\r')) line[--length] = '\0';
+		if (length == 0) continue;
+
+		start = recognizeMonotonicMs();
+		status = mrtdFieldsParse(&fields, line, buffer, sizeof(buffer), &failed);
+		parseMs += recognizeMonotonicMs() - start;
+
+		printf("{\"line\":%lu,", lineNumber);
+		if (status != RECOGNIZER_ERROR_STATUS_SUCCESS) {
+			printf("\"error\":\"%s\"}\n", status == RECOGNIZER_ERROR_STATUS_INVALID_TYPE ? "unknown MRZ layout"
+					: recognizerErrorToString(status));
+			continue;
+		}
+		++numParsed;
+		if (failed == 0) ++numValid;
+
+		printf("\"type\":\"%s\",\"valid\":%s,\"failedChecks\":[", mrtdDocumentTypeToString(fields.documentType),
+				failed == 0 ? "true" : "false");
+		for (i = 0; i < sizeof(checkNames) / sizeof(checkNames[0]); ++i) {
+			if (failed & (1u << i)) {
+				printf("\"%s\"", checkNames[i]);
+				if (failed >> (i + 1)) putchar(',');
+			}
+		}
+		printf("],\"fields\":{");
+		printFields(&fields);
+		printf("}}\n");
+	}
+
+	fprintf(stderr, "Parsed %lu MRZs, %lu with valid check digits, parsing took %.3f ms, %.2f us per MRZ\n", numParsed,
+			numValid, parseMs, numParsed > 0 ? parseMs * 1000.0 / numParsed : 0.0);
+	return 0;
+}
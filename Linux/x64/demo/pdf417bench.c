@@ -0,0 +1,203 @@
+#define _XOPEN_SOURCE 600
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "Pdf417Locator.h"
+#include "RecognizeOptions.h"
+
+#define MAX_CANDIDATES 16
+#define QUIET_ZONE 2
+
+/* Symbol in modules: one byte per module, non-zero for bars */
+typedef struct Symbol {
+	unsigned char* modules;
+	int columns;
+	int rows;
+	int rowHeight;
+} Symbol;
+
+static int drawPattern(unsigned char* row, int x, const int* widths, int length) {
+	int i, j;
+	for (i = 0; i < length; ++i) {
+		for (j = 0; j < widths[i]; ++j) row[x++] = (unsigned char) (i % 2 == 0);
+	}
+	return x;
+}
+
+/* Random codeword: 4 bars and 4 spaces of 1 to 6 modules, 17 modules in total */
+static int drawCodeword(unsigned char* row, int x) {
+	int widths[8] = { 1, 1, 1, 1, 1, 1, 1, 1 };
+	int extra = 17 - 8;
+
+	while (extra > 0) {
+		int i = rand() % 8;
+		if (widths[i] < 6) {
+			++widths[i];
+			--extra;
+		}
+	}
+	return drawPattern(row, x, widths, 8);
+}
+
+/* Builds a symbol of start pattern, left and right row indicators, data codewords and stop pattern */
+static int buildSymbol(Symbol* symbol, int dataColumns, int rows) {
+	static const int start[] = { 8, 1, 1, 1, 1, 1, 1, 3 };
+	static const int stop[] = { 7, 1, 1, 3, 1, 1, 1, 2, 1 };
+	int r, c;
+
+	symbol->columns = QUIET_ZONE + 17 + 17 * (dataColumns + 2) + 18 + QUIET_ZONE;
+	symbol->rowHeight = 3;
+	symbol->rows = rows * symbol->rowHeight + 2 * QUIET_ZONE;
+	symbol->modules = (unsigned char*) calloc((size_t) symbol->columns * symbol->rows, 1);
+	if (symbol->modules == NULL) return 0;
+
+	for (r = 0; r < rows; ++r) {
+		unsigned char* row = symbol->modules + (size_t) (QUIET_ZONE + r * symbol->rowHeight) * symbol->columns;
+		int x = drawPattern(row, QUIET_ZONE, start, 8);
+		for (c = 0; c < dataColumns + 2; ++c) x = drawCodeword(row, x);
+		drawPattern(row, x, stop, 9);
+		for (c = 1; c < symbol->rowHeight; ++c) memcpy(row + (size_t) c * symbol->columns, row, (size_t) symbol->columns);
+	}
+	return 1;
+}
+
+/* Maps symbol coordinates in modules to image coordinates: shear, scale, rotate and move to the image centre */
+static void symbolToImage(const Symbol* symbol, double u, double v, double module, double angle, double shear,
+		int width, int height, double* x, double* y) {
+	double su = (u - symbol->columns / 2.0 + shear * (v - symbol->rows / 2.0)) * module;
+	double sv = (v - symbol->rows / 2.0) * module;
+	*x = width / 2.0 + su * cos(angle) - sv * sin(angle);
+	*y = height / 2.0 + su * sin(angle) + sv * cos(angle);
+}
+
+/* Renders symbol into a gray image with noise, by mapping every pixel back into the symbol */
+static void renderSymbol(const Symbol* symbol, unsigned char* pixels, int width, int height, double module,
+		double angle, double shear) {
+	int x, y;
+
+	for (y = 0; y < height; ++y) {
+		for (x = 0; x < width; ++x) {
+			double dx = x + 0.5 - width / 2.0;
+			double dy = y + 0.5 - height / 2.0;
+			double su = dx * cos(angle) + dy * sin(angle);
+			double sv = -dx * sin(angle) + dy * cos(angle);
+			double v = sv / module + symbol->rows / 2.0;
+			double u = su / module + symbol->columns / 2.0 - shear * (v - symbol->rows / 2.0);
+			int value = 190;
+
+			if (u >= 0.0 && v >= 0.0 && u < symbol->columns && v < symbol->rows
+					&& symbol->modules[(size_t) v * symbol->columns + (size_t) u]) {
+				value = 50;
+			}
+			value += rand() % 41 - 20;
+			pixels[(size_t) y * width + x] = (unsigned char) value;
+		}
+	}
+}
+
+static void usage(const char* program) {
+	fprintf(stderr, "usage %s [-w width] [-h height] [-m module_pixels] [-c data_columns] [-r rows]\n", program);
+	fprintf(stderr, "Measures PDF417 localisation on synthetic rotated and skewed symbols.\n");
+}
+
+int main(int argc, char* argv[]) {
+	static const double angles[] = { 0.0, 10.0, 30.0, 45.0, 60.0, 90.0, 135.0, 180.0 };
+	static const double shears[] = { 0.0, 0.2 };
+	int width = 1600, height = 1200, dataColumns = 5, rows = 12;
+	double module = 3.0;
+	unsigned char* pixels;
+	Symbol symbol;
+	Pdf417LocatorOptions options;
+	Pdf417Candidate candidates[MAX_CANDIDATES];
+	size_t a, s, misses = 0;
+	int opt;
+
+	while ((opt = getopt(argc, argv, "w:h:m:c:r:")) != -1) {
+		switch (opt) {
+		case 'w':
+			width = atoi(optarg);
+			break;
+		case 'h':
+			height = atoi(optarg);
+			break;
+		case 'm':
+			module = atof(optarg);
+			break;
+		case 'c':
+			dataColumns = atoi(optarg);
+			break;
+		case 'r':
+			rows = atoi(optarg);
+			break;
+		default:
+			usage(argv[0]);
+			return -1;
+		}
+	}
+	if (width < 64 || height < 64 || module < 1.0 || dataColumns < 1 || rows < 3) {
+		usage(argv[0]);
+		return -1;
+	}
+
+	pixels = (unsigned char*) malloc((size_t) width * height);
+	if (pixels == NULL || !buildSymbol(&symbol, dataColumns, rows)) {
+		fprintf(stderr, "Out of memory\n");
+		return -1;
+	}
+	srand(1);
+	pdf417LocatorOptionsInit(&options);
+
+	printf("%dx%d image, %dx%d module symbol, %.1f pixels per module\n", width, height, symbol.columns, symbol.rows,
+			module);
+	printf("angle shear      ms  start  stop  covered  area\n");
+	for (s = 0; s < sizeof(shears) / sizeof(shears[0]); ++s) {
+		for (a = 0; a < sizeof(angles) / sizeof(angles[0]); ++a) {
+			double angle = angles[a] * 3.14159265358979 / 180.0;
+			ScanlineImage image;
+			size_t numCandidates = 0;
+			int covered = 0, corner;
+			double start, elapsed;
+
+			renderSymbol(&symbol, pixels, width, height, module, angle, shears[s]);
+			image.data = pixels;
+			image.width = width;
+			image.height = height;
+			image.bytesPerRow = (size_t) width;
+			image.type = RAW_IMAGE_TYPE_GRAY;
+
+			start = recognizeMonotonicMs();
+			pdf417Locate(&image, &options, candidates, MAX_CANDIDATES, &numCandidates);
+			elapsed = recognizeMonotonicMs() - start;
+
+			if (numCandidates > 0) {
+				const PPRectangle* region = &candidates[0].region;
+				/* the strongest candidate must hold all corners of the symbol without its quiet zone */
+				covered = 1;
+				for (corner = 0; corner < 4; ++corner) {
+					double x, y;
+					symbolToImage(&symbol, corner % 2 ? symbol.columns - QUIET_ZONE : QUIET_ZONE,
+							corner / 2 ? symbol.rows - QUIET_ZONE : QUIET_ZONE, module, angle, shears[s], width, height,
+							&x, &y);
+					if (x < region->x - 1.0 || y < region->y - 1.0 || x > region->x + region->width + 1.0
+							|| y > region->y + region->height + 1.0) {
+						covered = 0;
+					}
+				}
+			}
+			if (!covered) ++misses;
+
+			printf("%5.0f %5.1f %7.3f %6lu %5lu %8s %5.2f\n", angles[a], shears[s], elapsed,
+					(unsigned long) (numCandidates > 0 ? candidates[0].numStartHits : 0),
+					(unsigned long) (numCandidates > 0 ? candidates[0].numStopHits : 0), covered ? "yes" : "no",
+					numCandidates > 0 ? candidates[0].region.width * candidates[0].region.height / width / height : 0.0);
+		}
+	}
+
+	free(symbol.modules);
+	free(pixels);
+	return misses == 0 ? 0 : 1;
+}
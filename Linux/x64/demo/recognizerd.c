@@ -0,0 +1,489 @@
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "RecognizerApi.h"
+#include "RecognizerProfiles.h"
+#include "RecognizerdProtocol.h"
+#include "ResultSerializer.h"
+#include "DemoUtil.h"
+
+/* file descriptors accepted with one request at most; all but the first are closed */
+#define MAX_REQUEST_FDS 4
+
+/* Warm recognizer, lent to one request at a time */
+typedef struct PooledRecognizer {
+	Recognizer* recognizer;
+	/* non-zero while a request uses the recognizer */
+	int busy;
+	/* connection whose video frames the recognizer last saw, zero if it holds no video frame state */
+	unsigned long videoConnection;
+} PooledRecognizer;
+
+/* Recognizers shared by all connections. Connections borrow one per request, so idle connections hold none. */
+typedef struct RecognizerPool {
+	pthread_mutex_t mutex;
+	pthread_cond_t available;
+	PooledRecognizer* entries;
+	size_t numEntries;
+	/* connections being served, at most numEntries */
+	unsigned long numConnections;
+	/* identifier of the next connection, never zero */
+	unsigned long nextConnection;
+	/* signalled whenever a connection ends */
+	pthread_cond_t connectionEnded;
+} RecognizerPool;
+
+typedef struct Connection {
+	RecognizerPool* pool;
+	int socket;
+	unsigned long id;
+	/* buffer for serialized results, reused between requests */
+	unsigned char* reply;
+	size_t replyCapacity;
+} Connection;
+
+static int writeFully(int fd, const void* data, size_t size) {
+	const unsigned char* p = (const unsigned char*) data;
+	while (size > 0) {
+		ssize_t n = send(fd, p, size, MSG_NOSIGNAL);
+		if (n < 0 && errno == EINTR) continue;
+		if (n <= 0) return 0;
+		p += n;
+		size -= (size_t) n;
+	}
+	return 1;
+}
+
+/* Receives request and the memfd attached to it. Returns zero when connection is closed or broken. */
+static int receiveRequest(int socket, RecognizerdRequest* request, int* fd) {
+	struct msghdr message;
+	struct iovec iov;
+	struct cmsghdr* cmsg;
+	union {
+		char buffer[CMSG_SPACE(MAX_REQUEST_FDS * sizeof(int))];
+		struct cmsghdr align;
+	} control;
+	ssize_t n;
+
+	*fd = -1;
+	memset(&message, 0, sizeof(message));
+	iov.iov_base = request;
+	iov.iov_len = sizeof(*request);
+	message.msg_iov = &iov;
+	message.msg_iovlen = 1;
+	message.msg_control = control.buffer;
+	message.msg_controllen = sizeof(control.buffer);
+
+	do {
+		n = recvmsg(socket, &message, MSG_CMSG_CLOEXEC);
+	} while (n < 0 && errno == EINTR);
+
+	/* the first descriptor is kept and every further one is closed, so a client cannot leak descriptors into the
+	daemon; descriptors beyond the control buffer are discarded by the kernel */
+	for (cmsg = CMSG_FIRSTHDR(&message); n > 0 && cmsg != NULL; cmsg = CMSG_NXTHDR(&message, cmsg)) {
+		if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS) {
+			size_t count = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int), i;
+			for (i = 0; i < count; ++i) {
+				int received;
+				memcpy(&received, CMSG_DATA(cmsg) + i * sizeof(int), sizeof(int));
+				if (*fd < 0) {
+					*fd = received;
+				} else {
+					close(received);
+				}
+			}
+		}
+	}
+	if (n != (ssize_t) sizeof(*request) || request->magic != RECOGNIZERD_REQUEST_MAGIC) {
+		if (*fd >= 0) close(*fd);
+		*fd = -1;
+		return 0;
+	}
+	return 1;
+}
+
+/* Size of pixels described by request, or zero if the request does not describe a valid image */
+static size_t requestImageSize(const RecognizerdRequest* request) {
+	size_t size;
+
+	if (request->width == 0 || request->height == 0 || request->rawType > RAW_IMAGE_TYPE_NV21) return 0;
+	/* dimensions are passed to the library as int */
+	if (request->width > INT_MAX || request->height > INT_MAX) return 0;
+	if (request->bytesPerRow / (unsigned int) demoBytesPerPixel((RawImageType) request->rawType) < request->width) return 0;
+	if (request->height > (size_t) -1 / request->bytesPerRow) return 0;
+	size = (size_t) request->bytesPerRow * request->height;
+	if (request->rawType == RAW_IMAGE_TYPE_NV21) {
+		/* interleaved chroma plane of half height follows the luma plane */
+		if (size / 2 > (size_t) -1 - size) return 0;
+		size += size / 2;
+	}
+	return size;
+}
+
+/* Recognizes image held by memfd and serializes results into the reply buffer of connection */
+static RecognizerErrorStatus recognize(const Recognizer* recognizer, Connection* connection,
+		const RecognizerdRequest* request, int fd, size_t* replySize) {
+	RecognizerErrorStatus status;
+	RecognizerImage* image = NULL;
+	RecognizerResultList* resultList = NULL;
+	struct stat st;
+	size_t size;
+	int seals;
+	void* pixels;
+
+	*replySize = 0;
+	size = requestImageSize(request);
+	if (size == 0) return RECOGNIZER_ERROR_STATUS_INVALID_TYPE;
+	/* without these seals the client could shrink the memfd while the library reads it, raising SIGBUS here */
+	seals = fcntl(fd, F_GET_SEALS);
+	if (seals < 0 || (seals & (F_SEAL_SHRINK | F_SEAL_GROW)) != (F_SEAL_SHRINK | F_SEAL_GROW)) {
+		return RECOGNIZER_ERROR_STATUS_INVALID_TYPE;
+	}
+	if (fstat(fd, &st) != 0 || st.st_size < 0 || (unsigned long long) st.st_size < (unsigned long long) size) {
+		return RECOGNIZER_ERROR_STATUS_INDEX_OUT_OF_RANGE;
+	}
+
+	pixels = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+	if (pixels == MAP_FAILED) return RECOGNIZER_ERROR_STATUS_FAIL;
+
+	status = recognizerImageCreateFromRawImage(&image, pixels, (int) request->width, (int) request->height,
+			request->bytesPerRow, (RawImageType) request->rawType);
+	if (status == RECOGNIZER_ERROR_STATUS_SUCCESS) {
+		status = recognizerRecognizeFromImage(recognizer, &resultList, image, (int) request->imageIsVideoFrame, NULL);
+		recognizerImageDelete(&image);
+	}
+	munmap(pixels, size);
+	if (status != RECOGNIZER_ERROR_STATUS_SUCCESS) return status;
+
+	status = resultListSerialize(resultList, connection->reply, connection->replyCapacity, replySize);
+	if (status == RECOGNIZER_ERROR_STATUS_FAIL && *replySize > connection->replyCapacity) {
+		unsigned char* grown = (unsigned char*) realloc(connection->reply, *replySize);
+		if (grown != NULL) {
+			connection->reply = grown;
+			connection->replyCapacity = *replySize;
+			status = resultListSerialize(resultList, connection->reply, connection->replyCapacity, replySize);
+		}
+	}
+	recognizerResultListDelete(&resultList);
+	if (status != RECOGNIZER_ERROR_STATUS_SUCCESS) *replySize = 0;
+	return status;
+}
+
+/* Waits for a free recognizer. The one holding video frames of the connection is preferred, then one without video
+frame state. A recognizer holding video frames of another connection is reset before it is lent. */
+static PooledRecognizer* poolAcquire(RecognizerPool* pool, unsigned long connection) {
+	PooledRecognizer* chosen;
+	int reset;
+	size_t i;
+
+	pthread_mutex_lock(&pool->mutex);
+	for (;;) {
+		chosen = NULL;
+		for (i = 0; i < pool->numEntries; ++i) {
+			PooledRecognizer* entry = &pool->entries[i];
+			if (entry->busy) continue;
+			if (entry->videoConnection == connection) {
+				chosen = entry;
+				break;
+			}
+			if (chosen == NULL || (chosen->videoConnection != 0 && entry->videoConnection == 0)) chosen = entry;
+		}
+		if (chosen != NULL) break;
+		pthread_cond_wait(&pool->available, &pool->mutex);
+	}
+	chosen->busy = 1;
+	reset = chosen->videoConnection != 0 && chosen->videoConnection != connection;
+	if (reset) chosen->videoConnection = 0;
+	pthread_mutex_unlock(&pool->mutex);
+
+	if (reset) recognizerReset(chosen->recognizer);
+	return chosen;
+}
+
+static void poolRelease(RecognizerPool* pool, PooledRecognizer* entry) {
+	pthread_mutex_lock(&pool->mutex);
+	entry->busy = 0;
+	pthread_cond_signal(&pool->available);
+	pthread_mutex_unlock(&pool->mutex);
+}
+
+/* Resets recognizers left with video frames of a closed connection, so its frames never mix with frames of a later
+one. Called by the thread of the connection, which holds no recognizer at that point. */
+static void poolForget(RecognizerPool* pool, unsigned long connection) {
+	size_t i;
+
+	pthread_mutex_lock(&pool->mutex);
+	for (i = 0; i < pool->numEntries; ++i) {
+		PooledRecognizer* entry = &pool->entries[i];
+		if (entry->busy || entry->videoConnection != connection) continue;
+		entry->busy = 1;
+		pthread_mutex_unlock(&pool->mutex);
+		recognizerReset(entry->recognizer);
+		pthread_mutex_lock(&pool->mutex);
+		entry->busy = 0;
+		entry->videoConnection = 0;
+		pthread_cond_signal(&pool->available);
+	}
+	pthread_mutex_unlock(&pool->mutex);
+}
+
+/* Serves requests of one connection, borrowing a recognizer from the pool for each request only */
+static void* connectionRun(void* arg) {
+	Connection* connection = (Connection*) arg;
+	RecognizerPool* pool = connection->pool;
+	RecognizerdRequest request;
+	RecognizerdReply reply;
+	size_t replySize;
+	int fd;
+
+	while (receiveRequest(connection->socket, &request, &fd)) {
+		if (fd < 0) {
+			reply.status = RECOGNIZER_ERROR_STATUS_POINTER_IS_NULL;
+			replySize = 0;
+		} else {
+			PooledRecognizer* entry = poolAcquire(pool, connection->id);
+			reply.status = (unsigned int) recognize(entry->recognizer, connection, &request, fd, &replySize);
+			if (request.imageIsVideoFrame) entry->videoConnection = connection->id;
+			poolRelease(pool, entry);
+			close(fd);
+		}
+		reply.size = (unsigned int) replySize;
+		if (!writeFully(connection->socket, &reply, sizeof(reply))
+				|| !writeFully(connection->socket, connection->reply, replySize)) {
+			break;
+		}
+	}
+
+	poolForget(pool, connection->id);
+	close(connection->socket);
+	free(connection->reply);
+	free(connection);
+
+	pthread_mutex_lock(&pool->mutex);
+	--pool->numConnections;
+	pthread_cond_broadcast(&pool->connectionEnded);
+	pthread_mutex_unlock(&pool->mutex);
+	return NULL;
+}
+
+/* Non-zero if peer runs as the user of the daemon or as root. Socket permissions already keep other users out, this
+also holds if the socket is placed in a directory where they could replace it. */
+static int peerAllowed(int socket) {
+	struct ucred credentials;
+	socklen_t length = sizeof(credentials);
+
+	if (getsockopt(socket, SOL_SOCKET, SO_PEERCRED, &credentials, &length) != 0) return 0;
+	return credentials.uid == geteuid() || credentials.uid == 0;
+}
+
+/* Accepts connections and serves each on a thread of its own. At most one connection per recognizer is served at a
+time; further clients wait in the listen backlog. Returns when accepting fails. */
+static void acceptConnections(RecognizerPool* pool, int listenSocket) {
+	pthread_attr_t attributes;
+
+	pthread_attr_init(&attributes);
+	pthread_attr_setdetachstate(&attributes, PTHREAD_CREATE_DETACHED);
+	for (;;) {
+		pthread_t thread;
+		Connection* connection;
+		int socket;
+
+		pthread_mutex_lock(&pool->mutex);
+		while (pool->numConnections >= pool->numEntries) pthread_cond_wait(&pool->connectionEnded, &pool->mutex);
+		pthread_mutex_unlock(&pool->mutex);
+
+		socket = accept4(listenSocket, NULL, NULL, SOCK_CLOEXEC);
+		if (socket < 0) {
+			if (errno == EINTR || errno == ECONNABORTED) continue;
+			perror("accept");
+			break;
+		}
+		if (!peerAllowed(socket)) {
+			close(socket);
+			continue;
+		}
+		connection = (Connection*) calloc(1, sizeof(Connection));
+		if (connection == NULL) {
+			close(socket);
+			continue;
+		}
+		connection->pool = pool;
+		connection->socket = socket;
+
+		pthread_mutex_lock(&pool->mutex);
+		connection->id = pool->nextConnection++;
+		if (pool->nextConnection == 0) pool->nextConnection = 1;
+		++pool->numConnections;
+		pthread_mutex_unlock(&pool->mutex);
+
+		if (pthread_create(&thread, &attributes, connectionRun, connection) != 0) {
+			pthread_mutex_lock(&pool->mutex);
+			--pool->numConnections;
+			pthread_mutex_unlock(&pool->mutex);
+			close(socket);
+			free(connection);
+		}
+	}
+	pthread_attr_destroy(&attributes);
+}
+
+/* Removes socket left behind by a previous run, which would make bind fail. Returns zero if the path is in use by
+a running daemon or is not a socket, so that neither is taken over. */
+static int removeStaleSocket(const struct sockaddr_un* address) {
+	struct stat st;
+	int probe, stale;
+
+	if (lstat(address->sun_path, &st) != 0) return errno == ENOENT;
+	if (!S_ISSOCK(st.st_mode)) return 0;
+
+	probe = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+	if (probe < 0) return 0;
+	stale = connect(probe, (const struct sockaddr*) address, sizeof(*address)) != 0 && errno == ECONNREFUSED;
+	close(probe);
+	return stale && unlink(address->sun_path) == 0;
+}
+
+static void usage(const char* program) {
+	fprintf(stderr, "usage %s [-s socket] [-j recognizers] [-t mrtd,usdl,pdf417,zxing,bardecoder,mykad] [-m ocr_model] [-k license_key]\n", program);
+	fprintf(stderr, "Keeps recognizers loaded and serves recognition requests of RecognizerClient on a Unix domain socket.\n");
+	fprintf(stderr, "Each connection is served by a thread of its own and borrows one of the given number of recognizers\n");
+	fprintf(stderr, "per request. As many connections as recognizers are served at a time, further clients wait. Only the\n");
+	fprintf(stderr, "user running the daemon and root may connect.\n");
+}
+
+int main(int argc, char* argv[]) {
+	const char* socketPath = RECOGNIZERD_DEFAULT_SOCKET;
+	const char* modelPath = "../libRecognizerApi/res/ocr_model.zzip";
+	const char* licenseKey = "Add license key here";
+	const char* types = "mrtd";
+	long numWorkers = sysconf(_SC_NPROCESSORS_ONLN);
+	char* ocrModel;
+	int ocrModelLength;
+	RecognizerSettings* settings;
+	RecognizerDeviceInfo* deviceInfo;
+	RecognizerProfile profile;
+	RecognizerErrorStatus status;
+	struct sockaddr_un address;
+	int listenSocket;
+	RecognizerPool pool;
+	mode_t mask;
+	long i;
+	int opt;
+
+	while ((opt = getopt(argc, argv, "s:j:t:m:k:h")) != -1) {
+		switch (opt) {
+		case 's':
+			socketPath = optarg;
+			break;
+		case 'j':
+			numWorkers = atol(optarg);
+			break;
+		case 't':
+			types = optarg;
+			break;
+		case 'm':
+			modelPath = optarg;
+			break;
+		case 'k':
+			licenseKey = optarg;
+			break;
+		default:
+			usage(argv[0]);
+			return -1;
+		}
+	}
+	if (numWorkers < 1) numWorkers = 1;
+
+	recognizerProfileInit(&profile);
+	if (!recognizerProfileParseTypes(&profile, types) || strlen(socketPath) >= sizeof(address.sun_path)) {
+		usage(argv[0]);
+		return -1;
+	}
+
+	status = recognizerLoadFileToBuffer(modelPath, &ocrModel, &ocrModelLength);
+	if (status != RECOGNIZER_ERROR_STATUS_SUCCESS) {
+		fprintf(stderr, "Could not load file %s\n", modelPath);
+		return -1;
+	}
+
+	recognizerSettingsCreate(&settings);
+	recognizerDeviceInfoCreate(&deviceInfo);
+	/* parallelism comes from concurrent requests, so each recognizer gets its share of processors to avoid oversubscription */
+	recognizerDeviceInfoSetNumberOfProcessors(deviceInfo, numWorkers > 1 ? 1 : (unsigned int) sysconf(_SC_NPROCESSORS_ONLN));
+	recognizerSettingsSetDeviceInfo(settings, deviceInfo);
+	recognizerSettingsSetZicerModel(settings, ocrModel, ocrModelLength);
+	recognizerSettingsSetLicenseKey(settings, licenseKey);
+	recognizerProfileApply(&profile, settings);
+
+	listenSocket = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+	memset(&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+	strcpy(address.sun_path, socketPath);
+	if (!removeStaleSocket(&address)) {
+		fprintf(stderr, "%s is in use or is not a socket\n", socketPath);
+		return -1;
+	}
+	/* socket is created accessible to the owner only, so other users cannot use the licensed recognizers */
+	mask = umask(077);
+	if (listenSocket < 0 || bind(listenSocket, (struct sockaddr*) &address, sizeof(address)) != 0
+			|| listen(listenSocket, 64) != 0) {
+		perror(socketPath);
+		return -1;
+	}
+	umask(mask);
+
+	memset(&pool, 0, sizeof(pool));
+	pthread_mutex_init(&pool.mutex, NULL);
+	pthread_cond_init(&pool.available, NULL);
+	pthread_cond_init(&pool.connectionEnded, NULL);
+	pool.nextConnection = 1;
+	pool.numEntries = (size_t) numWorkers;
+	pool.entries = (PooledRecognizer*) calloc(pool.numEntries, sizeof(PooledRecognizer));
+	if (pool.entries == NULL) {
+		fprintf(stderr, "Out of memory\n");
+		return -1;
+	}
+
+	/* all recognizers are created before the first connection is accepted, so no request pays warm-up */
+	for (i = 0; i < numWorkers; ++i) {
+		status = recognizerCreate(&pool.entries[i].recognizer, settings);
+		if (status != RECOGNIZER_ERROR_STATUS_SUCCESS) {
+			fprintf(stderr, "Error creating recognizer: %s\n", recognizerErrorToString(status));
+			return -1;
+		}
+	}
+
+	fprintf(stderr, "Serving on %s with %ld recognizers\n", socketPath, numWorkers);
+	acceptConnections(&pool, listenSocket);
+
+	close(listenSocket);
+	unlink(socketPath);
+	/* recognizers are deleted only after every connection has finished with them */
+	pthread_mutex_lock(&pool.mutex);
+	while (pool.numConnections > 0) pthread_cond_wait(&pool.connectionEnded, &pool.mutex);
+	pthread_mutex_unlock(&pool.mutex);
+	for (i = 0; i < numWorkers; ++i) {
+		recognizerDelete(&pool.entries[i].recognizer);
+	}
+	free(pool.entries);
+	pthread_cond_destroy(&pool.connectionEnded);
+	pthread_cond_destroy(&pool.available);
+	pthread_mutex_destroy(&pool.mutex);
+	recognizerDeviceInfoDelete(&deviceInfo);
+	recognizerSettingsDelete(&settings);
+	recognizerFreeFileBuffer(&ocrModel);
+
+	return 0;
+}
@@ -0,0 +1,118 @@
+#define _XOPEN_SOURCE 600
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "RecognizerApi.h"
+#include "RecognizeOptions.h"
+#include "ScanlineRuns.h"
+#include "BarcodeScreen.h"
+
+/* one character per verdict in cell maps */
+static const char verdictMarks[BARCODE_SCREEN_VERDICT_COUNT] = { '.', 's', 'i', 'p', 'L', 'M' };
+
+/* Prints verdict of every cell, one row of cells per line */
+static void printCellMap(const ScanlineImage* image, const BarcodeScreenOptions* options) {
+	int size = options->cellSize, cx, cy;
+
+	if (image->width < size || image->height < size) return;
+	/* partial strips are screened by cells ending at the image edge, as in barcodeScreen */
+	for (cy = 0; cy < (image->height + size - 1) / size; ++cy) {
+		int y = cy * size + size > image->height ? image->height - size : cy * size;
+		for (cx = 0; cx < (image->width + size - 1) / size; ++cx) {
+			int x = cx * size + size > image->width ? image->width - size : cx * size;
+			putchar(verdictMarks[barcodeScreenCell(image, x, y, options)]);
+		}
+		putchar('\n');
+	}
+}
+
+static void usage(const char* program) {
+	fprintf(stderr, "usage %s [-c cell_size] [-r min_runs] [-t min_contrast] [-x] [-v] file...\n", program);
+	fprintf(stderr, "Screens images for bar texture and prints the screened region, verdicts of cells and screening time.\n");
+	fprintf(stderr, "With -x, cells looking like matrix codes are accepted too. With -v, a map of cell verdicts is printed\n");
+	fprintf(stderr, "(. flat, s sparse, i isotropic, p periodic, L linear, M matrix).\n");
+}
+
+int main(int argc, char* argv[]) {
+	BarcodeScreenOptions options;
+	BarcodeScreenStats total;
+	int printMap = 0, numFailed = 0, opt, i;
+	size_t v;
+
+	barcodeScreenOptionsInit(&options);
+	while ((opt = getopt(argc, argv, "c:r:t:xvh")) != -1) {
+		switch (opt) {
+		case 'c':
+			options.cellSize = atoi(optarg);
+			break;
+		case 'r':
+			options.minRuns = atoi(optarg);
+			break;
+		case 't':
+			options.minContrast = atoi(optarg);
+			break;
+		case 'x':
+			options.acceptMatrix = 1;
+			break;
+		case 'v':
+			printMap = 1;
+			break;
+		default:
+			usage(argv[0]);
+			return -1;
+		}
+	}
+	if (optind >= argc || options.cellSize < 8 || options.minRuns < 1) {
+		usage(argv[0]);
+		return -1;
+	}
+
+	memset(&total, 0, sizeof(total));
+	for (i = optind; i < argc; ++i) {
+		RecognizerImage* image = NULL;
+		ScanlineImage scanlineImage;
+		BarcodeScreenStats stats;
+		PPRectangle region;
+		RecognizerErrorStatus status;
+		int found = 0;
+
+		memset(&stats, 0, sizeof(stats));
+		status = recognizerImageCreateFromFile(&image, argv[i]);
+		if (status == RECOGNIZER_ERROR_STATUS_SUCCESS) status = scanlineImageInit(&scanlineImage, image);
+		if (status == RECOGNIZER_ERROR_STATUS_SUCCESS) {
+			status = barcodeScreen(&scanlineImage, &options, &region, &found, &stats);
+		}
+		if (status != RECOGNIZER_ERROR_STATUS_SUCCESS) {
+			++numFailed;
+			fprintf(stderr, "%s: %s\n", argv[i], recognizerErrorToString(status));
+			if (image != NULL) recognizerImageDelete(&image);
+			continue;
+		}
+
+		if (found) {
+			printf("%s: %.2f ms, region %.0f,%.0f %.0fx%.0f, cells", argv[i], stats.screenMs, region.x, region.y,
+					region.width, region.height);
+		} else {
+			printf("%s: %.2f ms, rejected, cells", argv[i], stats.screenMs);
+		}
+		for (v = 0; v < BARCODE_SCREEN_VERDICT_COUNT; ++v) {
+			printf(" %s %lu", barcodeScreenVerdictToString((BarcodeScreenVerdict) v), stats.cells[v]);
+			total.cells[v] += stats.cells[v];
+		}
+		printf("\n");
+		if (printMap) printCellMap(&scanlineImage, &options);
+		total.numImages += stats.numImages;
+		total.numRejectedImages += stats.numRejectedImages;
+		total.screenMs += stats.screenMs;
+		recognizerImageDelete(&image);
+	}
+
+	if (total.numImages > 0) {
+		printf("%lu images (%d failed), %lu rejected, average %.2f ms per image\n", total.numImages, numFailed,
+				total.numRejectedImages, total.screenMs / total.numImages);
+	}
+	return 0;
+}
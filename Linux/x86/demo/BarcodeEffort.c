@@ -0,0 +1,258 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "BarcodeEffort.h"
+#include "DemoUtil.h"
+
+static const BarcodeEffortStep defaultSteps[] = {
+	BARCODE_EFFORT_STEP_PLAIN,
+	BARCODE_EFFORT_STEP_ROTATED,
+	BARCODE_EFFORT_STEP_INVERSE,
+	BARCODE_EFFORT_STEP_THOROUGH
+};
+
+/* Rotates image by 90 degrees clockwise into *buffer. NV21 is reduced to its luma plane. */
+static RecognizerErrorStatus rotateImage(const RecognizerImage* image, RecognizerImage** rotated, unsigned char** buffer) {
+	const unsigned char* src;
+	void* data;
+	int width, height, bytesPerRow, channels, x, y;
+	RawImageType type;
+	RecognizerErrorStatus status;
+
+	status = recognizerImageGetRawBytes(image, &data);
+	if (status == RECOGNIZER_ERROR_STATUS_SUCCESS) status = recognizerImageGetWidth(image, &width);
+	if (status == RECOGNIZER_ERROR_STATUS_SUCCESS) status = recognizerImageGetHeight(image, &height);
+	if (status == RECOGNIZER_ERROR_STATUS_SUCCESS) status = recognizerImageGetBytesPerRow(image, &bytesPerRow);
+	if (status == RECOGNIZER_ERROR_STATUS_SUCCESS) status = recognizerImageGetRawImageType(image, &type);
+	if (status != RECOGNIZER_ERROR_STATUS_SUCCESS) return status;
+	src = (const unsigned char*) data;
+	channels = demoBytesPerPixel(type);
+	if (type == RAW_IMAGE_TYPE_NV21) type = RAW_IMAGE_TYPE_GRAY;
+
+	*buffer = (unsigned char*) malloc((size_t) width * height * channels);
+	if (*buffer == NULL) return RECOGNIZER_ERROR_STATUS_FAIL;
+
+	/* row y of the rotated image is column y of the source read bottom up */
+	for (y = 0; y < width; ++y) {
+		unsigned char* out = *buffer + (size_t) y * height * channels;
+		for (x = 0; x < height; ++x) {
+			memcpy(out + (size_t) x * channels, src + (size_t) (height - 1 - x) * bytesPerRow + (size_t) y * channels,
+					(size_t) channels);
+		}
+	}
+	return recognizerImageCreateFromRawImage(rotated, *buffer, height, width, (size_t) height * channels, type);
+}
+
+/* Inverts image into *buffer. NV21 is reduced to its luma plane and alpha of BGRA is kept. */
+static RecognizerErrorStatus invertImage(const RecognizerImage* image, RecognizerImage** inverted, unsigned char** buffer) {
+	const unsigned char* src;
+	void* data;
+	int width, height, bytesPerRow, rowSize, x, y;
+	RawImageType type;
+	RecognizerErrorStatus status;
+
+	status = recognizerImageGetRawBytes(image, &data);
+	if (status == RECOGNIZER_ERROR_STATUS_SUCCESS) status = recognizerImageGetWidth(image, &width);
+	if (status == RECOGNIZER_ERROR_STATUS_SUCCESS) status = recognizerImageGetHeight(image, &height);
+	if (status == RECOGNIZER_ERROR_STATUS_SUCCESS) status = recognizerImageGetBytesPerRow(image, &bytesPerRow);
+	if (status == RECOGNIZER_ERROR_STATUS_SUCCESS) status = recognizerImageGetRawImageType(image, &type);
+	if (status != RECOGNIZER_ERROR_STATUS_SUCCESS) return status;
+	src = (const unsigned char*) data;
+	rowSize = width * demoBytesPerPixel(type);
+	if (type == RAW_IMAGE_TYPE_NV21) type = RAW_IMAGE_TYPE_GRAY;
+
+	*buffer = (unsigned char*) malloc((size_t) rowSize * height);
+	if (*buffer == NULL) return RECOGNIZER_ERROR_STATUS_FAIL;
+
+	for (y = 0; y < height; ++y) {
+		const unsigned char* in = src + (size_t) y * bytesPerRow;
+		unsigned char* out = *buffer + (size_t) y * rowSize;
+		/* plain byte loop, which compilers vectorize */
+		for (x = 0; x < rowSize; ++x) out[x] = (unsigned char) ~in[x];
+		if (type == RAW_IMAGE_TYPE_BGRA) {
+			for (x = 3; x < rowSize; x += 4) out[x] = in[x];
+		}
+	}
+	return recognizerImageCreateFromRawImage(inverted, *buffer, width, height, (size_t) rowSize, type);
+}
+
+/* Profile of level: base profile with the steps of all levels up to and including it */
+static void levelProfile(const RecognizerProfile* base, const BarcodeEffortStep* steps, size_t level,
+		RecognizerProfile* profile) {
+	size_t i;
+
+	*profile = *base;
+	profile->pdf417.shouldScanInverse = 0;
+	profile->barDecoder.shouldScanInverse = 0;
+	profile->barDecoder.tryHarder = 0;
+	profile->zxing.shouldScanInverse = 0;
+	profile->zxing.slowThoroughScan = 0;
+
+	for (i = 0; i <= level; ++i) {
+		if (steps[i] == BARCODE_EFFORT_STEP_INVERSE) {
+			profile->pdf417.shouldScanInverse = 1;
+			profile->barDecoder.shouldScanInverse = 1;
+			profile->zxing.shouldScanInverse = 1;
+		} else if (steps[i] == BARCODE_EFFORT_STEP_THOROUGH) {
+			profile->barDecoder.tryHarder = 1;
+			profile->zxing.slowThoroughScan = 1;
+		}
+	}
+}
+
+RecognizerErrorStatus barcodeEffortInit(BarcodeEffort* effort, RecognizerSettings* settings,
+		const RecognizerProfile* base, const BarcodeEffortStep* steps, size_t numLevels) {
+	RecognizerProfile profiles[BARCODE_EFFORT_MAX_LEVELS];
+	size_t i;
+
+	if (effort == NULL) return RECOGNIZER_ERROR_STATUS_POINTER_IS_NULL;
+	memset(effort, 0, sizeof(*effort));
+	if (settings == NULL || base == NULL) return RECOGNIZER_ERROR_STATUS_POINTER_IS_NULL;
+
+	if (steps == NULL) {
+		steps = defaultSteps;
+		numLevels = sizeof(defaultSteps) / sizeof(defaultSteps[0]);
+	}
+	if (numLevels == 0 || numLevels > BARCODE_EFFORT_MAX_LEVELS) return RECOGNIZER_ERROR_STATUS_INDEX_OUT_OF_RANGE;
+
+	for (i = 0; i < numLevels; ++i) {
+		effort->steps[i] = steps[i];
+		levelProfile(base, steps, i, &profiles[i]);
+	}
+	effort->numLevels = numLevels;
+	barcodeScreenOptionsInit(&effort->screenOptions);
+	/* levels whose profiles are equal (e.g. ROTATED after PLAIN) share settings but get recognizers of their own;
+	recognizer creation is paid once here, not per image */
+	return recognizerProfileCacheInit(&effort->cache, settings, profiles, numLevels);
+}
+
+RecognizerErrorStatus barcodeEffortEnableScreen(BarcodeEffort* effort, const RecognizerProfile* base) {
+	if (effort == NULL || base == NULL) return RECOGNIZER_ERROR_STATUS_POINTER_IS_NULL;
+	if (base->useMRTD || base->useMyKad) return RECOGNIZER_ERROR_STATUS_INVALID_TYPE;
+	if (!base->usePdf417 && !base->useUsdl && !base->useBarDecoder && !base->useZXing) {
+		return RECOGNIZER_ERROR_STATUS_INVALID_TYPE;
+	}
+
+	effort->screenOptions.acceptMatrix = base->useZXing
+			&& (base->zxing.scanQRCode || base->zxing.scanAztec || base->zxing.scanDataMatrix);
+	effort->screen = 1;
+	return RECOGNIZER_ERROR_STATUS_SUCCESS;
+}
+
+RecognizerErrorStatus recognizeWithEffort(BarcodeEffort* effort, size_t maxLevel, RecognizerResultList** resultList,
+		const RecognizerImage* image, const RecognizeOptions* options, size_t* level) {
+	RecognizerResultList* best = NULL;
+	int bestQuality = -1;
+	size_t bestLevel = 0;
+	RecognizerErrorStatus status = RECOGNIZER_ERROR_STATUS_SUCCESS;
+	/* image the levels work on, the inverted copy when codes are inverse */
+	const RecognizerImage* source = image;
+	RecognizerImage* inverted = NULL;
+	unsigned char* invertedBuffer = NULL;
+	ScanlineImage scanlineImage;
+	int haveScanlineImage = 0;
+	/* with screening, options of the levels carry the screened region, turned with the image by the ROTATED level */
+	RecognizeOptions screenedOptions;
+	PPRectangle screened, screenedRotated;
+	size_t i;
+
+	if (resultList == NULL) return RECOGNIZER_ERROR_STATUS_POINTER_IS_NULL;
+	*resultList = NULL;
+	if (effort == NULL || image == NULL) return RECOGNIZER_ERROR_STATUS_POINTER_IS_NULL;
+	if (effort->numLevels == 0) return RECOGNIZER_ERROR_STATUS_INDEX_OUT_OF_RANGE;
+	if (maxLevel >= effort->numLevels) maxLevel = effort->numLevels - 1;
+
+	if (effort->screen || effort->detectPolarity) {
+		haveScanlineImage = scanlineImageInit(&scanlineImage, image) == RECOGNIZER_ERROR_STATUS_SUCCESS;
+	}
+	if (effort->screen && haveScanlineImage && (options == NULL || options->roi == NULL)) {
+		int found = 0;
+
+		if (barcodeScreen(&scanlineImage, &effort->screenOptions, &screened, &found, &effort->screenStats)
+				== RECOGNIZER_ERROR_STATUS_SUCCESS) {
+			/* nothing to decode; counted by screenStats rather than as a failure of the levels */
+			if (!found) {
+				if (level != NULL) *level = 0;
+				return RECOGNIZER_ERROR_STATUS_SUCCESS;
+			}
+
+			screened.x /= scanlineImage.width;
+			screened.width /= scanlineImage.width;
+			screened.y /= scanlineImage.height;
+			screened.height /= scanlineImage.height;
+			/* clockwise rotation takes relative (x, y) to (1 - y, x) */
+			screenedRotated.x = 1.f - (screened.y + screened.height);
+			screenedRotated.y = screened.x;
+			screenedRotated.width = screened.height;
+			screenedRotated.height = screened.width;
+			if (options != NULL) {
+				screenedOptions = *options;
+			} else {
+				recognizeOptionsInit(&screenedOptions);
+			}
+			options = &screenedOptions;
+		}
+	}
+
+	if (effort->detectPolarity && haveScanlineImage && scanlinePolarity(&scanlineImage, 8) == SCANLINE_POLARITY_INVERSE
+			&& invertImage(image, &inverted, &invertedBuffer) == RECOGNIZER_ERROR_STATUS_SUCCESS) {
+		++effort->inverseImages;
+		source = inverted;
+	}
+
+	for (i = 0; i <= maxLevel && bestQuality < 3; ++i) {
+		const Recognizer* recognizer;
+		RecognizerResultList* current = NULL;
+		RecognizerImage* rotated = NULL;
+		unsigned char* buffer = NULL;
+		int quality;
+
+		if (options != NULL && options->deadlineMs > 0.0 && recognizeMonotonicMs() >= options->deadlineMs) break;
+
+		status = recognizerProfileCacheGet(&effort->cache, i, &recognizer);
+		if (status == RECOGNIZER_ERROR_STATUS_SUCCESS && effort->steps[i] == BARCODE_EFFORT_STEP_ROTATED) {
+			status = rotateImage(source, &rotated, &buffer);
+		}
+		if (options == &screenedOptions) {
+			screenedOptions.roi = effort->steps[i] == BARCODE_EFFORT_STEP_ROTATED ? &screenedRotated : &screened;
+		}
+		if (status == RECOGNIZER_ERROR_STATUS_SUCCESS) {
+			++effort->attempts[i];
+			status = recognizeWithOptions(recognizer, &current, rotated != NULL ? rotated : source, options);
+		}
+		if (rotated != NULL) recognizerImageDelete(&rotated);
+		free(buffer);
+		if (status != RECOGNIZER_ERROR_STATUS_SUCCESS) {
+			if (best != NULL) break;
+			continue;
+		}
+
+		quality = recognizeResultListQuality(current);
+		if (quality > bestQuality) {
+			if (best != NULL) recognizerResultListDelete(&best);
+			best = current;
+			bestQuality = quality;
+			bestLevel = i;
+		} else {
+			recognizerResultListDelete(&current);
+		}
+	}
+
+	if (bestQuality == 3) {
+		++effort->successes[bestLevel];
+	} else {
+		++effort->failures;
+	}
+	if (inverted != NULL) recognizerImageDelete(&inverted);
+	free(invertedBuffer);
+	if (level != NULL) *level = bestLevel;
+	if (best == NULL) return status;
+
+	*resultList = best;
+	return RECOGNIZER_ERROR_STATUS_SUCCESS;
+}
+
+RecognizerErrorStatus barcodeEffortTerm(BarcodeEffort* effort) {
+	if (effort == NULL) return RECOGNIZER_ERROR_STATUS_POINTER_IS_NULL;
+	return recognizerProfileCacheTerm(&effort->cache);
+}
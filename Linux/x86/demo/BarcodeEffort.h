@@ -0,0 +1,125 @@
+#ifndef BARCODEEFFORT_H_
+#define BARCODEEFFORT_H_
+
+#include <stddef.h>
+
+#include "RecognizerApi.h"
+#include "RecognizeOptions.h"
+#include "RecognizerProfiles.h"
+#include "ScanlineRuns.h"
+#include "BarcodeScreen.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define BARCODE_EFFORT_MAX_LEVELS 8
+
+/**
+ * What a level of barcode effort adds to the level before it.
+ */
+typedef enum BarcodeEffortStep {
+	/* base profile with tryHarder, slowThoroughScan and inverse scanning disabled */
+	BARCODE_EFFORT_STEP_PLAIN,
+	/* image rotated by 90 degrees, so that vertical 1D codes are crossed by scan rows. Applies to its own level only. */
+	BARCODE_EFFORT_STEP_ROTATED,
+	/* shouldScanInverse of PDF417, BarDecoder and ZXing */
+	BARCODE_EFFORT_STEP_INVERSE,
+	/* tryHarder of BarDecoder and slowThoroughScan of ZXing */
+	BARCODE_EFFORT_STEP_THOROUGH
+} BarcodeEffortStep;
+
+/**
+ * Ladder of increasingly expensive barcode passes, used instead of enabling tryHarder or slowThoroughScan for every
+ * image. Level 0 is the cheapest; each further level adds its step to the settings of the previous ones. Scanning
+ * stops at the first level which yields a valid and certain result, and counters record which level succeeded, so
+ * the maximum level can be tuned to the traffic.
+ *
+ * Recognizers of all levels are created upfront. A ladder must be used from one thread at a time.
+ */
+typedef struct BarcodeEffort {
+	RecognizerProfileCache cache;
+	BarcodeEffortStep steps[BARCODE_EFFORT_MAX_LEVELS];
+	size_t numLevels;
+	/* number of images on which each level was run */
+	unsigned long attempts[BARCODE_EFFORT_MAX_LEVELS];
+	/* number of images for which each level produced the first valid and certain result */
+	unsigned long successes[BARCODE_EFFORT_MAX_LEVELS];
+	/* number of images for which no level produced a valid and certain result */
+	unsigned long failures;
+	/* if non-zero, polarity of codes is estimated from scanlines before the first level, and images with inverse
+	codes are inverted once, so that every level reads them as normal codes. Zero after barcodeEffortInit. */
+	int detectPolarity;
+	/* number of images found to hold inverse codes */
+	unsigned long inverseImages;
+	/* if non-zero, images are screened with barcodeScreen before the first level. Images without bar texture are
+	rejected without running any level, and the others are recognized only within the screened region. Images whose
+	options already carry a region of interest are not screened. Zero after barcodeEffortInit; set by
+	barcodeEffortEnableScreen. */
+	int screen;
+	/* options of screening, set to defaults by barcodeEffortInit */
+	BarcodeScreenOptions screenOptions;
+	/* verdicts, rejected images and time of screening */
+	BarcodeScreenStats screenStats;
+} BarcodeEffort;
+
+/**
+ * Creates recognizers for all levels.
+ *
+ *  @param effort       ladder to initialize
+ *  @param settings     base settings with license key, device info and OCR model. Must outlive the ladder.
+ *  @param base         profile with enabled barcode recognizers and symbologies
+ *  @param steps        step of each level, or NULL for PLAIN, ROTATED, INVERSE, THOROUGH
+ *  @param numLevels    number of levels, at most BARCODE_EFFORT_MAX_LEVELS. Ignored if steps is NULL.
+ *
+ *  @return status of the operation
+ */
+RecognizerErrorStatus barcodeEffortInit(BarcodeEffort* effort, RecognizerSettings* settings,
+		const RecognizerProfile* base, const BarcodeEffortStep* steps, size_t numLevels);
+
+/**
+ * Enables screening of images before the first level. Screening rejects everything without bar texture, including
+ * MRZ text and card faces, so it is enabled only if every recognizer enabled in base reads bar codes: PDF417, USDL,
+ * which reads PDF417, BarDecoder and ZXing. Cells with edges both ways are accepted as matrix codes if ZXing scans
+ * QR, Aztec or DataMatrix codes.
+ *
+ *  @param effort       ladder initialized with base
+ *  @param base         profile the ladder was initialized with
+ *
+ *  @return status of the operation. RECOGNIZER_ERROR_STATUS_INVALID_TYPE if base enables MRTD or MyKad recognizers,
+ *          or no barcode recognizer at all.
+ */
+RecognizerErrorStatus barcodeEffortEnableScreen(BarcodeEffort* effort, const RecognizerProfile* base);
+
+/**
+ * Recognizes image running levels from 0 up to maxLevel, until one yields a valid and certain result or the
+ * deadline in options is reached. Results of the ROTATED level refer to the rotated image, and with detectPolarity
+ * results of inverse images refer to the inverted image. With screen, results refer to the screened region, and
+ * images rejected by screening return success with no result list.
+ *
+ *  @param effort       ladder
+ *  @param maxLevel     highest level to run
+ *  @param resultList   destination of the best result list found. Set to NULL if no level succeeded.
+ *  @param image        image to recognize
+ *  @param options      per-call options shared by all levels, or NULL for defaults
+ *  @param level        if non-NULL, set to the level which produced returned result list
+ *
+ *  @return status of the operation. Error of a level is returned only if no earlier level produced a result list.
+ */
+RecognizerErrorStatus recognizeWithEffort(BarcodeEffort* effort, size_t maxLevel, RecognizerResultList** resultList,
+		const RecognizerImage* image, const RecognizeOptions* options, size_t* level);
+
+/**
+ * Deletes recognizers of all levels.
+ *
+ *  @param effort ladder
+ *
+ *  @return status of the operation
+ */
+RecognizerErrorStatus barcodeEffortTerm(BarcodeEffort* effort);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,230 @@
+#include <string.h>
+
+#include "BarcodeScreen.h"
+#include "RecognizeOptions.h"
+
+/* limits of options, which keep all buffers of a cell on the stack */
+#define MAX_CELL_SIZE 256
+#define MAX_LINES_PER_CELL 16
+/* runs wider than this are counted as this wide; widths of codes are compared well below it */
+#define MAX_WIDTH 63
+/* horizontal, main diagonal, vertical, anti-diagonal; direction i + 2 is perpendicular to direction i */
+#define NUM_DIRECTIONS 4
+
+static const int directionX[NUM_DIRECTIONS] = { 1, 1, 0, -1 };
+static const int directionY[NUM_DIRECTIONS] = { 0, 1, 1, 1 };
+
+static const char* const verdictNames[BARCODE_SCREEN_VERDICT_COUNT] = {
+	"flat",
+	"sparse",
+	"isotropic",
+	"periodic",
+	"linear",
+	"matrix"
+};
+
+/* Runs seen in one direction of a cell */
+typedef struct DirectionRuns {
+	/* inner runs of all scanlines, without the cut runs at both ends */
+	unsigned long numRuns;
+	/* scanlines with at least minRuns inner runs */
+	int numDenseLines;
+	/* histogram of inner run widths, dark runs first */
+	unsigned int widths[2][MAX_WIDTH + 1];
+} DirectionRuns;
+
+void barcodeScreenOptionsInit(BarcodeScreenOptions* options) {
+	options->cellSize = 48;
+	options->linesPerCell = 4;
+	options->minContrast = 80;
+	options->minRuns = 8;
+	options->minAnisotropy = 2.f;
+	options->minWidthSpread = 1.8f;
+	options->acceptMatrix = 0;
+	options->marginCells = 1;
+}
+
+const char* barcodeScreenVerdictToString(BarcodeScreenVerdict verdict) {
+	return verdict >= 0 && verdict < BARCODE_SCREEN_VERDICT_COUNT ? verdictNames[verdict] : "unknown";
+}
+
+/* Width below which given fraction of runs in histogram lie */
+static int widthPercentile(const unsigned int* histogram, float fraction) {
+	unsigned long total = 0, sum = 0;
+	int w;
+
+	for (w = 0; w <= MAX_WIDTH; ++w) total += histogram[w];
+	for (w = 0; w <= MAX_WIDTH; ++w) {
+		sum += histogram[w];
+		if (sum > 0 && sum >= fraction * total) return w;
+	}
+	return MAX_WIDTH;
+}
+
+/* Non-zero if both dark and light runs come in several widths. Widths are smoothed by one sample, so that single
+pixel jitter of equal lines does not count as spread. */
+static int hasWidthSpread(const DirectionRuns* runs, float minSpread) {
+	int colour;
+
+	for (colour = 0; colour < 2; ++colour) {
+		int narrow = widthPercentile(runs->widths[colour], 0.1f);
+		int wide = widthPercentile(runs->widths[colour], 0.9f);
+		if (wide + 1 < minSpread * (narrow + 1)) return 0;
+	}
+	return 1;
+}
+
+/* Splits scanlines of one direction crossing the cell into runs. Returns number of scanlines with enough contrast. */
+static int scanDirection(const ScanlineImage* image, int x, int y, int direction, const BarcodeScreenOptions* options,
+		DirectionRuns* out) {
+	unsigned char samples[2 * MAX_CELL_SIZE];
+	unsigned int runs[2 * MAX_CELL_SIZE];
+	int dx = directionX[direction], dy = directionY[direction];
+	int half = options->cellSize / 2;
+	int spacing = options->cellSize / (options->linesPerCell + 1);
+	int centreX = x + half, centreY = y + half;
+	int numLines = 0, line;
+
+	/* diagonal steps are one pixel along each axis, so diagonal lines span the cell with half as many steps */
+	if (dx != 0 && dy != 0) half = half * 5 / 7;
+
+	for (line = 0; line < options->linesPerCell; ++line) {
+		int offset = (2 * line + 1 - options->linesPerCell) * spacing / 2;
+		/* offset perpendicular to the direction */
+		int x0 = centreX - dy * offset - dx * half, y0 = centreY + dx * offset - dy * half;
+		int x1 = centreX - dy * offset + dx * half, y1 = centreY + dx * offset + dy * half;
+		unsigned char darkest = 255, brightest = 0;
+		size_t numSamples, numRuns, i;
+		int firstDark = 0;
+
+		if (x0 < 0 || x1 < 0 || x0 >= image->width || x1 >= image->width || y0 < 0 || y1 >= image->height) continue;
+		numSamples = scanlineSample(image, x0, y0, x1, y1, samples, sizeof(samples));
+		/* plain min and max loop, which compilers vectorize */
+		for (i = 0; i < numSamples; ++i) {
+			if (samples[i] < darkest) darkest = samples[i];
+			if (samples[i] > brightest) brightest = samples[i];
+		}
+		if (numSamples < 2 || brightest - darkest < options->minContrast) continue;
+		++numLines;
+
+		numRuns = scanlineRuns(samples, numSamples, (unsigned char) ((darkest + brightest + 1) / 2), runs,
+				sizeof(runs) / sizeof(runs[0]), &firstDark);
+		if (numRuns >= (size_t) options->minRuns + 2) ++out->numDenseLines;
+		for (i = 1; i + 1 < numRuns; ++i) {
+			/* runs alternate in colour starting with the colour of the first sample */
+			int dark = ((i % 2 == 0) == (firstDark != 0));
+			++out->widths[dark ? 0 : 1][runs[i] < MAX_WIDTH ? runs[i] : MAX_WIDTH];
+			++out->numRuns;
+		}
+	}
+	return numLines;
+}
+
+BarcodeScreenVerdict barcodeScreenCell(const ScanlineImage* image, int x, int y, const BarcodeScreenOptions* options) {
+	BarcodeScreenOptions defaults;
+	DirectionRuns directions[NUM_DIRECTIONS];
+	float across, along;
+	int numLines = 0, best = 0, d;
+
+	if (options == NULL) {
+		barcodeScreenOptionsInit(&defaults);
+		options = &defaults;
+	}
+	if (options->cellSize > MAX_CELL_SIZE || options->linesPerCell > MAX_LINES_PER_CELL) {
+		defaults = *options;
+		if (defaults.cellSize > MAX_CELL_SIZE) defaults.cellSize = MAX_CELL_SIZE;
+		if (defaults.linesPerCell > MAX_LINES_PER_CELL) defaults.linesPerCell = MAX_LINES_PER_CELL;
+		options = &defaults;
+	}
+
+	memset(directions, 0, sizeof(directions));
+	for (d = 0; d < NUM_DIRECTIONS; ++d) {
+		numLines += scanDirection(image, x, y, d, options, &directions[d]);
+		if (directions[d].numRuns > directions[best].numRuns) best = d;
+	}
+	if (numLines == 0) return BARCODE_SCREEN_FLAT;
+
+	/* averaged over all scanlines of a direction, so that one noisy line does not carry a flat cell */
+	across = (float) directions[best].numRuns / options->linesPerCell;
+	along = (float) directions[(best + 2) % NUM_DIRECTIONS].numRuns / options->linesPerCell;
+	/* bars cross the whole cell, while a line of text or a curve crosses only some of its scanlines */
+	if (across < options->minRuns || directions[best].numDenseLines * 4 < options->linesPerCell * 3) {
+		return BARCODE_SCREEN_SPARSE;
+	}
+
+	if (across < options->minAnisotropy * (along > 1.f ? along : 1.f)) {
+		if (!options->acceptMatrix) return BARCODE_SCREEN_ISOTROPIC;
+		return hasWidthSpread(&directions[best], options->minWidthSpread) ? BARCODE_SCREEN_MATRIX
+				: BARCODE_SCREEN_PERIODIC;
+	}
+	return hasWidthSpread(&directions[best], options->minWidthSpread) ? BARCODE_SCREEN_LINEAR
+			: BARCODE_SCREEN_PERIODIC;
+}
+
+/* Left or top edge of cell index along an image side. Cells of the last partial strip are moved back inside the
+image, so that they overlap their neighbours instead of leaving the strip unscreened. */
+static int cellOrigin(int index, int cellSize, int side) {
+	int origin = index * cellSize;
+	return origin + cellSize > side ? side - cellSize : origin;
+}
+
+RecognizerErrorStatus barcodeScreen(const ScanlineImage* image, const BarcodeScreenOptions* options,
+		PPRectangle* region, int* found, BarcodeScreenStats* stats) {
+	BarcodeScreenOptions defaults;
+	int x0 = 0, y0 = 0, x1 = 0, y1 = 0;
+	int cellsX, cellsY, cx, cy, cellSize;
+	double start = recognizeMonotonicMs();
+
+	if (image == NULL || region == NULL || found == NULL) return RECOGNIZER_ERROR_STATUS_POINTER_IS_NULL;
+	if (options == NULL) {
+		barcodeScreenOptionsInit(&defaults);
+		options = &defaults;
+	}
+	cellSize = options->cellSize < MAX_CELL_SIZE ? options->cellSize : MAX_CELL_SIZE;
+	if (cellSize < 8 || options->linesPerCell < 1) return RECOGNIZER_ERROR_STATUS_INDEX_OUT_OF_RANGE;
+
+	*found = 0;
+	if (image->width < cellSize || image->height < cellSize) {
+		/* no cell fits, as in tightly cropped codes, so the whole image is passed on unscreened */
+		*found = 1;
+		x1 = image->width;
+		y1 = image->height;
+		cellsX = cellsY = 0;
+	} else {
+		cellsX = (image->width + cellSize - 1) / cellSize;
+		cellsY = (image->height + cellSize - 1) / cellSize;
+	}
+	for (cy = 0; cy < cellsY; ++cy) {
+		for (cx = 0; cx < cellsX; ++cx) {
+			int x = cellOrigin(cx, cellSize, image->width), y = cellOrigin(cy, cellSize, image->height);
+			BarcodeScreenVerdict verdict = barcodeScreenCell(image, x, y, options);
+
+			if (stats != NULL) ++stats->cells[verdict];
+			if (verdict != BARCODE_SCREEN_LINEAR && verdict != BARCODE_SCREEN_MATRIX) continue;
+			if (!*found || x < x0) x0 = x;
+			if (!*found || y < y0) y0 = y;
+			if (x + cellSize > x1) x1 = x + cellSize;
+			if (y + cellSize > y1) y1 = y + cellSize;
+			*found = 1;
+		}
+	}
+
+	if (*found) {
+		int margin = options->marginCells * cellSize;
+
+		x0 -= margin;
+		y0 -= margin;
+		x1 += margin;
+		y1 += margin;
+		region->x = (float) (x0 > 0 ? x0 : 0);
+		region->y = (float) (y0 > 0 ? y0 : 0);
+		region->width = (float) (x1 < image->width ? x1 : image->width) - region->x;
+		region->height = (float) (y1 < image->height ? y1 : image->height) - region->y;
+	}
+	if (stats != NULL) {
+		++stats->numImages;
+		if (!*found) ++stats->numRejectedImages;
+		stats->screenMs += recognizeMonotonicMs() - start;
+	}
+	return RECOGNIZER_ERROR_STATUS_SUCCESS;
+}
@@ -0,0 +1,877 @@
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "Code2DLocator.h"
+
+/* hits kept per image; more only come from dense false matches */
+#define MAX_HITS 8192
+/* finder patterns and texture regions examined per image */
+#define MAX_FINDERS 256
+#define MAX_REGIONS 256
+/* directions in which solid edges of DataMatrix symbols are searched, over half a turn. Lines within half a step of
+an edge stay on it for 1 / sin(90 / EDGE_ANGLES degrees), about 20 modules. */
+#define EDGE_ANGLES 32
+/* modules between centres of the farthest QR finder patterns, of version 40 */
+#define QR_MAX_FINDER_DISTANCE 170.f
+/* half of the side of the largest Aztec symbol in modules */
+#define AZTEC_MAX_RADIUS 76.f
+/* half of the side of the smallest compact Aztec symbol in modules */
+#define AZTEC_MIN_RADIUS 8.f
+/* difference of the darkest and brightest sample below which a line crosses only background, whose noise would
+otherwise be split into runs */
+#define MIN_CONTRAST 48
+
+typedef enum FinderKind {
+	FINDER_QR,
+	FINDER_AZTEC
+} FinderKind;
+
+/* Pattern of alternating bars and spaces starting with a bar, centred on its middle run */
+typedef struct FinderPattern {
+	FinderKind kind;
+	/* non-zero if lines matching the pattern pass through the centre module of the finder */
+	int centred;
+	int widths[9];
+	int length;
+	int modules;
+} FinderPattern;
+
+static const FinderPattern patterns[] = {
+	{ FINDER_QR, 1, { 1, 1, 3, 1, 1 }, 5, 7 },
+	/* line through the centre of a bullseye */
+	{ FINDER_AZTEC, 1, { 1, 1, 1, 1, 1, 1, 1, 1, 1 }, 9, 9 },
+	/* line one module off the centre, crossing the light ring around it */
+	{ FINDER_AZTEC, 0, { 1, 1, 1, 3, 1, 1, 1 }, 7, 9 }
+};
+
+/* Match of a finder pattern at the centre of its middle run */
+typedef struct FinderHit {
+	FinderKind kind;
+	float x;
+	float y;
+	/* module size in pixels */
+	float module;
+	/* 0 horizontal, 1 vertical, 2 and 3 diagonal */
+	int orientation;
+	int centred;
+	/* union-find parent, hits of one finder pattern share the root */
+	size_t parent;
+} FinderHit;
+
+typedef struct Finder {
+	FinderKind kind;
+	float x;
+	float y;
+	float module;
+	size_t numHits;
+	/* sums of centres of hits on lines through the centre module, which locate the finder more precisely */
+	float centredX;
+	float centredY;
+	size_t numCentred;
+	/* bit per orientation of the scanlines which crossed the finder */
+	unsigned int orientations;
+	/* non-zero once the finder is part of a located symbol */
+	int used;
+} Finder;
+
+/* Connected cells dense in edges, in cells */
+typedef struct TextureRegion {
+	int left;
+	int top;
+	int right;
+	int bottom;
+	size_t numCells;
+	/* non-zero if a QR or Aztec symbol lies in the region */
+	int claimed;
+} TextureRegion;
+
+typedef struct LocatorState {
+	const ScanlineImage* image;
+	int cellSize;
+	int cellsX;
+	int cellsY;
+	/* edges counted in each cell by horizontal and vertical scanlines, and the number of such scanlines */
+	unsigned int* edgesX;
+	unsigned int* edgesY;
+	unsigned int* linesX;
+	unsigned int* linesY;
+	unsigned char* samples;
+	unsigned int* runs;
+	size_t capacity;
+	FinderHit* hits;
+	size_t numHits;
+} LocatorState;
+
+static size_t findRoot(FinderHit* hits, size_t i) {
+	while (hits[i].parent != i) {
+		/* path halving keeps trees flat without recursion */
+		hits[i].parent = hits[hits[i].parent].parent;
+		i = hits[i].parent;
+	}
+	return i;
+}
+
+static void unite(FinderHit* hits, size_t a, size_t b) {
+	a = findRoot(hits, a);
+	b = findRoot(hits, b);
+	if (a != b) hits[b].parent = a;
+}
+
+/* Non-zero if runs match pattern within tolerance. Module width is derived from the total width of the runs. */
+static int matchPattern(const unsigned int* runs, const FinderPattern* pattern, float* module) {
+	unsigned int total = 0;
+	float variance = 0.f;
+	int i;
+
+	for (i = 0; i < pattern->length; ++i) total += runs[i];
+	if (total < (unsigned int) pattern->modules) return 0;
+	*module = (float) total / pattern->modules;
+
+	for (i = 0; i < pattern->length; ++i) {
+		float diff = runs[i] / *module - pattern->widths[i];
+		if (diff < 0.f) diff = -diff;
+		if (diff > 0.7f) return 0;
+		variance += diff;
+	}
+	return variance <= 0.25f * pattern->modules;
+}
+
+static int hasContrast(const unsigned char* samples, size_t length) {
+	unsigned char darkest = 255, brightest = 0;
+	size_t i;
+
+	for (i = 0; i < length; ++i) {
+		if (samples[i] < darkest) darkest = samples[i];
+		if (samples[i] > brightest) brightest = samples[i];
+	}
+	return brightest - darkest >= MIN_CONTRAST;
+}
+
+static int addHit(LocatorState* state, const FinderPattern* pattern, float x, float y, float module,
+		int orientation) {
+	FinderHit* hit;
+
+	if (state->numHits == MAX_HITS) return 0;
+	hit = &state->hits[state->numHits];
+	hit->kind = pattern->kind;
+	hit->centred = pattern->centred;
+	hit->x = x;
+	hit->y = y;
+	hit->module = module;
+	hit->orientation = orientation;
+	hit->parent = state->numHits++;
+	return 1;
+}
+
+/* Adds edges of a horizontal (stepX) or vertical scanline at coordinate c to the cells it crosses */
+static void countEdges(LocatorState* state, const unsigned int* runs, size_t numRuns, int stepX, int c) {
+	unsigned int* edges = stepX ? state->edgesX : state->edgesY;
+	unsigned int* lines = stepX ? state->linesX : state->linesY;
+	int band = c / state->cellSize;
+	int numCells = stepX ? state->cellsX : state->cellsY;
+	size_t position = 0, k;
+	int i;
+
+	for (i = 0; i < numCells; ++i) ++lines[stepX ? band * state->cellsX + i : i * state->cellsX + band];
+	for (k = 0; k + 1 < numRuns; ++k) {
+		int cell;
+		position += runs[k];
+		cell = (int) position / state->cellSize;
+		++edges[stepX ? band * state->cellsX + cell : cell * state->cellsX + band];
+	}
+}
+
+/* Matches finder patterns on the scanline of length samples starting at (x0, y0) and advancing by (stepX, stepY) */
+static void scanLine(LocatorState* state, int x0, int y0, int stepX, int stepY, int length, int orientation) {
+	size_t numSamples, numRuns, k, position;
+	/* diagonal samples are a pixel apart on both axes */
+	float pixelsPerSample = stepX != 0 && stepY != 0 ? 1.41421356f : 1.f;
+	int firstDark;
+
+	if (length < 7) return;
+	numSamples = scanlineSample(state->image, x0, y0, x0 + (length - 1) * stepX, y0 + (length - 1) * stepY,
+			state->samples, state->capacity);
+	if (!hasContrast(state->samples, numSamples)) numSamples = 0;
+	numRuns = scanlineRuns(state->samples, numSamples, scanlineThreshold(state->samples, numSamples), state->runs,
+			state->capacity, &firstDark);
+	if (orientation < 2) countEdges(state, state->runs, numRuns, stepX, stepX ? y0 : x0);
+
+	for (k = 0, position = 0; k + 5 <= numRuns; position += state->runs[k++]) {
+		size_t p;
+
+		/* runs alternate in colour and every pattern starts with a bar */
+		if ((k % 2 == 0) != (firstDark != 0)) continue;
+
+		for (p = 0; p < sizeof(patterns) / sizeof(patterns[0]); ++p) {
+			const FinderPattern* pattern = &patterns[p];
+			int middle = pattern->length / 2, i;
+			float module, centre;
+
+			if (k + pattern->length > numRuns) continue;
+			if (!matchPattern(state->runs + k, pattern, &module)) continue;
+			centre = (float) position;
+			for (i = 0; i < middle; ++i) centre += state->runs[k + i];
+			centre += state->runs[k + middle] / 2.f;
+
+			if (!addHit(state, pattern, x0 + centre * stepX, y0 + centre * stepY, module * pixelsPerSample,
+					orientation)) {
+				return;
+			}
+			break;
+		}
+	}
+}
+
+/* Runs scanlines in four orientations over the whole image */
+static void scanImage(LocatorState* state, int spacing) {
+	int width = state->image->width;
+	int height = state->image->height;
+	int c;
+
+	for (c = spacing / 2; c < height; c += spacing) scanLine(state, 0, c, 1, 0, width, 0);
+	for (c = spacing / 2; c < width; c += spacing) scanLine(state, c, 0, 0, 1, height, 1);
+	/* down-right diagonals, indexed by x - y */
+	for (c = -(height - 1) + spacing / 2; c < width; c += spacing) {
+		int x0 = c >= 0 ? c : 0;
+		int y0 = c >= 0 ? 0 : -c;
+		scanLine(state, x0, y0, 1, 1, width - x0 < height - y0 ? width - x0 : height - y0, 2);
+	}
+	/* up-right diagonals, indexed by x + y */
+	for (c = spacing / 2; c < width + height - 1; c += spacing) {
+		int x0 = c < height ? 0 : c - height + 1;
+		int y0 = c < height ? c : height - 1;
+		scanLine(state, x0, y0, 1, -1, width - x0 < y0 + 1 ? width - x0 : y0 + 1, 3);
+	}
+}
+
+/* Joins hits of one kind and similar module size closer than three modules, so that scanlines crossing one finder
+pattern form one group. Centres of neighbouring QR finders are at least 14 modules apart. */
+static void groupHits(FinderHit* hits, size_t numHits) {
+	size_t i, j;
+
+	for (i = 0; i < numHits; ++i) {
+		for (j = i + 1; j < numHits; ++j) {
+			float dx = hits[i].x - hits[j].x;
+			float dy = hits[i].y - hits[j].y;
+			float module = hits[i].module > hits[j].module ? hits[i].module : hits[j].module;
+
+			if (hits[i].kind != hits[j].kind) continue;
+			if (hits[i].module > 1.5f * hits[j].module || hits[j].module > 1.5f * hits[i].module) continue;
+			if (dx * dx + dy * dy <= 9.f * module * module) unite(hits, i, j);
+		}
+	}
+}
+
+static int countBits(unsigned int bits) {
+	int count = 0;
+	for (; bits != 0; bits &= bits - 1) ++count;
+	return count;
+}
+
+/* Non-zero if line through (x, y) in direction (dx, dy) crosses pattern centred there, i.e. with the point in its
+middle run */
+static int crossesPattern(LocatorState* state, const FinderPattern* pattern, int x, int y, int dx, int dy,
+		float module) {
+	int half = (int) (pattern->modules * module + 0.5f);
+	int middle = pattern->length / 2;
+	size_t numSamples, numRuns, k, position = 0;
+	int firstDark;
+	float found;
+
+	numSamples = scanlineSample(state->image, x - half * dx, y - half * dy, x + half * dx, y + half * dy,
+			state->samples, state->capacity);
+	if (numSamples == 0 || !hasContrast(state->samples, numSamples)) return 0;
+	numRuns = scanlineRuns(state->samples, numSamples, scanlineThreshold(state->samples, numSamples), state->runs,
+			state->capacity, &firstDark);
+
+	for (k = 0; k + pattern->length <= numRuns; position += state->runs[k++]) {
+		size_t start = position;
+		int i;
+
+		if ((k % 2 == 0) != (firstDark != 0)) continue;
+		if (!matchPattern(state->runs + k, pattern, &found)) continue;
+		for (i = 0; i < middle; ++i) start += state->runs[k + i];
+		if (start <= (size_t) half && (size_t) half < start + state->runs[k + middle]) return 1;
+	}
+	return 0;
+}
+
+/* Number of the four orientations in which lines through (x, y) cross pattern centred there */
+static int countCrossings(LocatorState* state, const FinderPattern* pattern, int x, int y, float module) {
+	/* module size is measured along the line, on diagonals it spans √2 as many pixels */
+	float diagonal = module / 1.41421356f;
+
+	return crossesPattern(state, pattern, x, y, 1, 0, module) + crossesPattern(state, pattern, x, y, 0, 1, module)
+			+ crossesPattern(state, pattern, x, y, 1, 1, diagonal)
+			+ crossesPattern(state, pattern, x, y, 1, -1, diagonal);
+}
+
+/* Confirms a finder on lines through its centre, in at least two of the four orientations. The QR finder and the
+Aztec bullseye are concentric squares, so any line through their centre crosses them in the same proportions, while
+random data matches them along one scanline, rarely across. Lines through the corners of the squares are the least
+reliable, hence two orientations and not all. Scanlines of rotated finders may miss the centre, so points up to three
+modules around the estimate are tried, and the finder is moved to the best one. */
+static int isFinder(LocatorState* state, Finder* finder) {
+	/* a bullseye is confirmed by lines through its centre module */
+	const FinderPattern* pattern = &patterns[finder->kind == FINDER_QR ? 0 : 1];
+	int step = (int) (finder->module / 2.f) > 1 ? (int) (finder->module / 2.f) : 1;
+	int radius = (int) (3.f * finder->module + 0.5f);
+	int cx = (int) (finder->x + 0.5f), cy = (int) (finder->y + 0.5f);
+	int best = countCrossings(state, pattern, cx, cy, finder->module), bestX = cx, bestY = cy;
+	int dx, dy;
+
+	for (dy = -radius; dy <= radius && best < 4; dy += step) {
+		for (dx = -radius; dx <= radius && best < 4; dx += step) {
+			int crossed = countCrossings(state, pattern, cx + dx, cy + dy, finder->module);
+			/* nearer points are preferred on ties, the scan order keeps the first one */
+			if (crossed > best || (crossed == best && dx * dx + dy * dy < (bestX - cx) * (bestX - cx)
+					+ (bestY - cy) * (bestY - cy))) {
+				best = crossed;
+				bestX = cx + dx;
+				bestY = cy + dy;
+			}
+		}
+	}
+	finder->x = (float) bestX;
+	finder->y = (float) bestY;
+	return best >= 2;
+}
+
+/* Builds one finder per group of hits crossed in at least two orientations */
+static size_t buildFinders(LocatorState* state, const Code2DLocatorOptions* options, size_t* finderOf,
+		Finder* finders) {
+	FinderHit* hits = state->hits;
+	size_t numFinders = 0, i;
+
+	for (i = 0; i < state->numHits; ++i) finderOf[i] = (size_t) -1;
+	for (i = 0; i < state->numHits; ++i) {
+		size_t root = findRoot(hits, i);
+		Finder* finder;
+
+		if (finderOf[root] == (size_t) -1) {
+			if (numFinders == MAX_FINDERS) continue;
+			finder = &finders[numFinders];
+			memset(finder, 0, sizeof(*finder));
+			finder->kind = hits[i].kind;
+			finderOf[root] = numFinders++;
+		}
+		finder = &finders[finderOf[root]];
+		++finder->numHits;
+		finder->orientations |= 1u << hits[i].orientation;
+		finder->x += hits[i].x;
+		finder->y += hits[i].y;
+		finder->module += hits[i].module;
+		if (hits[i].centred) {
+			finder->centredX += hits[i].x;
+			finder->centredY += hits[i].y;
+			++finder->numCentred;
+		}
+	}
+
+	for (i = 0; i < numFinders; ++i) {
+		if (finders[i].numCentred > 0) {
+			finders[i].x = finders[i].centredX / finders[i].numCentred;
+			finders[i].y = finders[i].centredY / finders[i].numCentred;
+		} else {
+			finders[i].x /= finders[i].numHits;
+			finders[i].y /= finders[i].numHits;
+		}
+		finders[i].module /= finders[i].numHits;
+		if (finders[i].numHits < (size_t) options->minHits || countBits(finders[i].orientations) < 2
+				|| !isFinder(state, &finders[i])) {
+			/* rejected finders are never used in a symbol */
+			finders[i].used = 1;
+		}
+	}
+	return numFinders;
+}
+
+/* Region of width x height pixels around the points, each side extended by extend, clipped to the image */
+static PPRectangle boundingRegion(const float* xs, const float* ys, int numPoints, float extend, int width,
+		int height) {
+	PPRectangle region;
+	float left = xs[0], top = ys[0], right = xs[0], bottom = ys[0];
+	int i;
+
+	for (i = 1; i < numPoints; ++i) {
+		if (xs[i] < left) left = xs[i];
+		if (xs[i] > right) right = xs[i];
+		if (ys[i] < top) top = ys[i];
+		if (ys[i] > bottom) bottom = ys[i];
+	}
+	left = left - extend < 0.f ? 0.f : left - extend;
+	top = top - extend < 0.f ? 0.f : top - extend;
+	right = right + extend + 1.f > width ? (float) width : right + extend + 1.f;
+	bottom = bottom + extend + 1.f > height ? (float) height : bottom + extend + 1.f;
+	region.x = left;
+	region.y = top;
+	region.width = right - left;
+	region.height = bottom - top;
+	return region;
+}
+
+static int appendCandidate(Code2DCandidate* candidates, size_t maxCandidates, size_t* numCandidates,
+		Code2DSymbology symbology, PPRectangle region, size_t strength) {
+	if (*numCandidates == maxCandidates) return 0;
+	candidates[*numCandidates].symbology = symbology;
+	candidates[*numCandidates].region = region;
+	candidates[*numCandidates].strength = strength;
+	++*numCandidates;
+	return 1;
+}
+
+static int insideCandidate(const Code2DCandidate* candidates, size_t numCandidates, float x, float y) {
+	size_t i;
+
+	for (i = 0; i < numCandidates; ++i) {
+		const PPRectangle* region = &candidates[i].region;
+		if (x >= region->x && y >= region->y && x < region->x + region->width && y < region->y + region->height) {
+			return 1;
+		}
+	}
+	return 0;
+}
+
+/* Texture region holding point (x, y), or NULL */
+static TextureRegion* regionAt(LocatorState* state, TextureRegion* regions, size_t numRegions, const int* labels,
+		float x, float y) {
+	int cx = (int) x / state->cellSize, cy = (int) y / state->cellSize;
+	int label;
+
+	if (cx < 0 || cy < 0 || cx >= state->cellsX || cy >= state->cellsY) return NULL;
+	label = labels[cy * state->cellsX + cx];
+	return label >= 0 && (size_t) label < numRegions ? &regions[label] : NULL;
+}
+
+/* Fraction of textured cells on the segment from (x0, y0) to (x1, y1), sampled every half cell */
+static float texturedFraction(const LocatorState* state, const int* labels, float x0, float y0, float x1, float y1) {
+	float length = (float) sqrt((x1 - x0) * (x1 - x0) + (y1 - y0) * (y1 - y0));
+	int steps = (int) (2.f * length / state->cellSize) + 1, textured = 0, i;
+
+	for (i = 0; i <= steps; ++i) {
+		int cx = (int) (x0 + (x1 - x0) * i / steps) / state->cellSize;
+		int cy = (int) (y0 + (y1 - y0) * i / steps) / state->cellSize;
+		if (cx >= 0 && cy >= 0 && cx < state->cellsX && cy < state->cellsY && labels[cy * state->cellsX + cx] >= 0) {
+			++textured;
+		}
+	}
+	return (float) textured / (steps + 1);
+}
+
+/* Non-zero if the middle half of the segment between two finders is mostly textured. The finders themselves are
+large solid areas with few edges, so they are left out. */
+static int isTexturedBetween(const LocatorState* state, const int* labels, const Finder* a, const Finder* b) {
+	float dx = (b->x - a->x) / 4.f, dy = (b->y - a->y) / 4.f;
+	return texturedFraction(state, labels, a->x + dx, a->y + dy, b->x - dx, b->y - dy) >= 0.7f;
+}
+
+/* Pairs QR finders into symbols. Of the three finders of a symbol, the corner one sees the other two at equal
+distance and a right angle, and the symbol between them is textured. Triangles of finders crossed by the most
+scanlines are taken first, and finders inside a taken symbol are not used again, so that a false finder in the data
+of a symbol does not make a second, overlapping symbol. */
+static void collectQR(LocatorState* state, Finder* finders, size_t numFinders, const Code2DLocatorOptions* options,
+		TextureRegion* regions, size_t numRegions, const int* labels, Code2DCandidate* candidates,
+		size_t maxCandidates, size_t* numCandidates) {
+	for (;;) {
+		size_t a, b, c, bestA = 0, bestB = 0, bestC = 0, bestHits = 0, i;
+		float bestSide = 0.f, xs[4], ys[4], module, side;
+		TextureRegion* region;
+
+		for (a = 0; a < numFinders; ++a) {
+			if (finders[a].used || finders[a].kind != FINDER_QR) continue;
+			for (b = 0; b < numFinders; ++b) {
+				if (b == a || finders[b].used || finders[b].kind != FINDER_QR) continue;
+				for (c = b + 1; c < numFinders; ++c) {
+					float abx, aby, acx, acy, ab, ac, m;
+					size_t hits = finders[a].numHits + finders[b].numHits + finders[c].numHits;
+
+					if (c == a || finders[c].used || finders[c].kind != FINDER_QR) continue;
+					m = finders[a].module;
+					if (finders[b].module > 1.5f * m || m > 1.5f * finders[b].module) continue;
+					if (finders[c].module > 1.5f * m || m > 1.5f * finders[c].module) continue;
+					abx = finders[b].x - finders[a].x;
+					aby = finders[b].y - finders[a].y;
+					acx = finders[c].x - finders[a].x;
+					acy = finders[c].y - finders[a].y;
+					ab = (float) sqrt(abx * abx + aby * aby);
+					ac = (float) sqrt(acx * acx + acy * acy);
+					/* version 1 symbols have finders 14 modules apart */
+					if (ab < 14.f * m * 0.8f || ab > QR_MAX_FINDER_DISTANCE * m * 1.2f) continue;
+					if (ab > 1.2f * ac || ac > 1.2f * ab) continue;
+					/* within about 15 degrees of a right angle, which leaves room for perspective */
+					if (fabs(abx * acx + aby * acy) > 0.25f * ab * ac) continue;
+					if (bestSide != 0.f && (hits < bestHits || (hits == bestHits && ab >= bestSide))) continue;
+					/* finders of unrelated symbols, or false ones, have background between them */
+					if (!isTexturedBetween(state, labels, &finders[a], &finders[b])
+							|| !isTexturedBetween(state, labels, &finders[a], &finders[c])
+							|| !isTexturedBetween(state, labels, &finders[b], &finders[c])) {
+						continue;
+					}
+					bestSide = ab;
+					bestHits = hits;
+					bestA = a;
+					bestB = b;
+					bestC = c;
+				}
+			}
+		}
+		if (bestSide == 0.f) return;
+
+		finders[bestA].used = finders[bestB].used = finders[bestC].used = 1;
+		xs[0] = finders[bestA].x;
+		ys[0] = finders[bestA].y;
+		xs[1] = finders[bestB].x;
+		ys[1] = finders[bestB].y;
+		xs[2] = finders[bestC].x;
+		ys[2] = finders[bestC].y;
+		/* fourth corner completes the parallelogram */
+		xs[3] = xs[1] + xs[2] - xs[0];
+		ys[3] = ys[1] + ys[2] - ys[0];
+		module = (finders[bestA].module + finders[bestB].module + finders[bestC].module) / 3.f;
+		side = bestSide + 7.f * module;
+
+		/* finder centres lie 3.5 modules inside the symbol, √2 as far along the diagonal */
+		region = regionAt(state, regions, numRegions, labels, (xs[1] + xs[2]) / 2.f, (ys[1] + ys[2]) / 2.f);
+		if (region != NULL) region->claimed = 1;
+		if (!appendCandidate(candidates, maxCandidates, numCandidates, CODE2D_SYMBOLOGY_QR,
+				boundingRegion(xs, ys, 4, 5.f * module + options->margin * side, state->image->width,
+						state->image->height),
+				bestHits)) {
+			return;
+		}
+		for (i = 0; i < numFinders; ++i) {
+			if (insideCandidate(candidates + *numCandidates - 1, 1, finders[i].x, finders[i].y)) finders[i].used = 1;
+		}
+	}
+}
+
+/* Turns confirmed bullseyes into Aztec symbols. The size of a symbol is only known from its mode message, so it is
+taken from the texture region around the bullseye, bounded by the smallest and largest Aztec symbols. */
+static void collectAztec(LocatorState* state, Finder* finders, size_t numFinders, const Code2DLocatorOptions* options,
+		TextureRegion* regions, size_t numRegions, const int* labels, Code2DCandidate* candidates,
+		size_t maxCandidates, size_t* numCandidates) {
+	size_t i;
+
+	for (i = 0; i < numFinders; ++i) {
+		const Finder* finder = &finders[i];
+		TextureRegion* region;
+		float radius, xs[1], ys[1];
+
+		if (finder->used || finder->kind != FINDER_AZTEC) continue;
+		/* data of a QR symbol may look like a bullseye */
+		if (insideCandidate(candidates, *numCandidates, finder->x, finder->y)) continue;
+		radius = AZTEC_MIN_RADIUS * finder->module;
+		region = regionAt(state, regions, numRegions, labels, finder->x, finder->y);
+		if (region != NULL) {
+			float cellSize = (float) state->cellSize;
+			float dx = finder->x - region->left * cellSize, dy = finder->y - region->top * cellSize;
+
+			/* farthest side of the texture region from the bullseye */
+			if ((region->right + 1) * cellSize - finder->x > dx) dx = (region->right + 1) * cellSize - finder->x;
+			if ((region->bottom + 1) * cellSize - finder->y > dy) dy = (region->bottom + 1) * cellSize - finder->y;
+			if (dx > radius) radius = dx;
+			if (dy > radius) radius = dy;
+			if (radius > AZTEC_MAX_RADIUS * finder->module) radius = AZTEC_MAX_RADIUS * finder->module;
+			region->claimed = 1;
+		}
+
+		xs[0] = finder->x;
+		ys[0] = finder->y;
+		if (!appendCandidate(candidates, maxCandidates, numCandidates, CODE2D_SYMBOLOGY_AZTEC,
+				boundingRegion(xs, ys, 1, radius * (1.f + 2.f * options->margin), state->image->width,
+						state->image->height),
+				finder->numHits)) {
+			return;
+		}
+	}
+}
+
+/* Non-zero if cell holds edges both ways, on average at least one per cell side on the scanlines crossing it and its
+eight neighbours. Edges of random modules are two modules apart on average, so this holds for cells of at least two
+modules; the neighbours smooth out cells smaller than a few modules. */
+static int isTextured(const LocatorState* state, size_t cell) {
+	unsigned int edgesX = 0, edgesY = 0, linesX = 0, linesY = 0;
+	int x = (int) (cell % state->cellsX), y = (int) (cell / state->cellsX), nx, ny;
+
+	for (ny = y - 1; ny <= y + 1; ++ny) {
+		for (nx = x - 1; nx <= x + 1; ++nx) {
+			size_t neighbour = (size_t) ny * state->cellsX + nx;
+			if (nx < 0 || ny < 0 || nx >= state->cellsX || ny >= state->cellsY) continue;
+			edgesX += state->edgesX[neighbour];
+			edgesY += state->edgesY[neighbour];
+			linesX += state->linesX[neighbour];
+			linesY += state->linesY[neighbour];
+		}
+	}
+	return state->edgesX[cell] > 0 && state->edgesY[cell] > 0 && edgesX >= linesX && edgesY >= linesY;
+}
+
+/* Labels 8-connected textured cells with region indices, -1 for other cells. Regions beyond MAX_REGIONS are not
+labelled. */
+static size_t labelTexture(const LocatorState* state, int* labels, int* stack, TextureRegion* regions) {
+	size_t numCells = (size_t) state->cellsX * state->cellsY, numRegions = 0, i;
+
+	for (i = 0; i < numCells; ++i) labels[i] = isTextured(state, i) ? MAX_REGIONS : -1;
+	for (i = 0; i < numCells && numRegions < MAX_REGIONS; ++i) {
+		TextureRegion* region = &regions[numRegions];
+		size_t top = 0;
+
+		if (labels[i] != MAX_REGIONS) continue;
+		memset(region, 0, sizeof(*region));
+		region->left = region->right = (int) (i % state->cellsX);
+		region->top = region->bottom = (int) (i / state->cellsX);
+		labels[i] = (int) numRegions;
+		stack[top++] = (int) i;
+
+		while (top > 0) {
+			int cell = stack[--top];
+			int x = cell % state->cellsX, y = cell / state->cellsX, nx, ny;
+
+			++region->numCells;
+			if (x < region->left) region->left = x;
+			if (x > region->right) region->right = x;
+			if (y < region->top) region->top = y;
+			if (y > region->bottom) region->bottom = y;
+			for (ny = y - 1; ny <= y + 1; ++ny) {
+				for (nx = x - 1; nx <= x + 1; ++nx) {
+					int neighbour = ny * state->cellsX + nx;
+					if (nx < 0 || ny < 0 || nx >= state->cellsX || ny >= state->cellsY) continue;
+					if (labels[neighbour] != MAX_REGIONS) continue;
+					/* each cell is pushed once, so the stack never holds more than all cells */
+					labels[neighbour] = (int) numRegions;
+					stack[top++] = neighbour;
+				}
+			}
+		}
+		++numRegions;
+	}
+	return numRegions;
+}
+
+/* Longest dark run in pixels on any line of direction angle across the square of half side half centred at (cx, cy) */
+static float longestDarkRun(LocatorState* state, float cx, float cy, float half, double angle) {
+	float dx = (float) cos(angle), dy = (float) sin(angle);
+	/* scanlineSample takes one sample per pixel of the longer axis */
+	float pixelsPerSample = 1.f / (fabs(dx) > fabs(dy) ? (float) fabs(dx) : (float) fabs(dy));
+	int maxX = state->image->width - 1, maxY = state->image->height - 1;
+	unsigned int longest = 0;
+	float offset;
+
+	for (offset = -half; offset <= half; offset += 1.f) {
+		float px = cx - dy * offset, py = cy + dx * offset;
+		int x0 = (int) (px - dx * half + 0.5f), y0 = (int) (py - dy * half + 0.5f);
+		int x1 = (int) (px + dx * half + 0.5f), y1 = (int) (py + dy * half + 0.5f);
+		size_t numSamples, numRuns, k;
+		int firstDark;
+
+		/* clamping near the image border bends lines slightly, which only shortens runs */
+		x0 = x0 < 0 ? 0 : (x0 > maxX ? maxX : x0);
+		x1 = x1 < 0 ? 0 : (x1 > maxX ? maxX : x1);
+		y0 = y0 < 0 ? 0 : (y0 > maxY ? maxY : y0);
+		y1 = y1 < 0 ? 0 : (y1 > maxY ? maxY : y1);
+		numSamples = scanlineSample(state->image, x0, y0, x1, y1, state->samples, state->capacity);
+		if (numSamples < 2 || !hasContrast(state->samples, numSamples)) continue;
+		numRuns = scanlineRuns(state->samples, numSamples, scanlineThreshold(state->samples, numSamples),
+				state->runs, state->capacity, &firstDark);
+		for (k = firstDark ? 0 : 1; k < numRuns; k += 2) {
+			if (state->runs[k] > longest) longest = state->runs[k];
+		}
+	}
+	return longest * pixelsPerSample;
+}
+
+/* Non-zero if the texture region has two long solid edges at a right angle, the L finder of DataMatrix symbols */
+static int hasSolidEdges(LocatorState* state, const TextureRegion* region) {
+	float cellSize = (float) state->cellSize;
+	float width = (region->right - region->left + 1) * cellSize;
+	float height = (region->bottom - region->top + 1) * cellSize;
+	float cx = region->left * cellSize + width / 2.f, cy = region->top * cellSize + height / 2.f;
+	/* lines reach a cell beyond the region, into the quiet zone */
+	float half = (float) sqrt(width * width + height * height) / 2.f + cellSize;
+	/* edges of a rotated symbol are at least 1 / √2 of the region side, less the cells the region is rounded to */
+	float minEdge = 0.7f * ((width < height ? width : height) - cellSize);
+	float lengths[EDGE_ANGLES];
+	int a;
+
+	for (a = 0; a < EDGE_ANGLES; ++a) {
+		lengths[a] = longestDarkRun(state, cx, cy, half, a * 3.14159265358979 / EDGE_ANGLES);
+	}
+	for (a = 0; a < EDGE_ANGLES / 2; ++a) {
+		int b = a + EDGE_ANGLES / 2;
+		/* a step either way allows for skew */
+		float perpendicular = lengths[b];
+		if (lengths[b - 1] > perpendicular) perpendicular = lengths[b - 1];
+		if (lengths[(b + 1) % EDGE_ANGLES] > perpendicular) perpendicular = lengths[(b + 1) % EDGE_ANGLES];
+		if (lengths[a] >= minEdge && perpendicular >= minEdge) return 1;
+	}
+	return 0;
+}
+
+/* Takes unclaimed texture regions of symbol size and shape, which have the L finder, as DataMatrix symbols */
+static void collectDataMatrix(LocatorState* state, const TextureRegion* regions, size_t numRegions,
+		const Code2DLocatorOptions* options, Code2DCandidate* candidates, size_t maxCandidates,
+		size_t* numCandidates) {
+	size_t i;
+
+	for (i = 0; i < numRegions; ++i) {
+		const TextureRegion* region = &regions[i];
+		int cellsX = region->right - region->left + 1, cellsY = region->bottom - region->top + 1;
+		float xs[2], ys[2], size;
+
+		if (region->claimed || cellsX < 2 || cellsY < 2) continue;
+		/* texture of a QR or Aztec symbol may be split into several regions around the one holding its centre */
+		if (insideCandidate(candidates, *numCandidates, (region->left + region->right + 1) * state->cellSize / 2.f,
+				(region->top + region->bottom + 1) * state->cellSize / 2.f)) {
+			continue;
+		}
+		/* rectangular symbols are at most 1:4, squares rotated by 45 degrees fill half of their bounding box */
+		if (cellsX > 4 * cellsY || cellsY > 4 * cellsX || region->numCells * 5 < (size_t) cellsX * cellsY * 2) continue;
+		size = (float) ((cellsX > cellsY ? cellsX : cellsY) * state->cellSize);
+		if (size > options->maxDataMatrixSize || !hasSolidEdges(state, region)) continue;
+
+		xs[0] = (float) (region->left * state->cellSize);
+		ys[0] = (float) (region->top * state->cellSize);
+		xs[1] = (float) ((region->right + 1) * state->cellSize - 1);
+		ys[1] = (float) ((region->bottom + 1) * state->cellSize - 1);
+		/* cells only partly covered by the symbol may not be textured, so one more cell is taken */
+		if (!appendCandidate(candidates, maxCandidates, numCandidates, CODE2D_SYMBOLOGY_DATA_MATRIX,
+				boundingRegion(xs, ys, 2, state->cellSize + options->margin * size, state->image->width,
+						state->image->height),
+				region->numCells)) {
+			return;
+		}
+	}
+}
+
+void code2DLocatorOptionsInit(Code2DLocatorOptions* options) {
+	options->spacing = 4;
+	options->cellSize = 16;
+	options->minHits = 2;
+	options->maxDataMatrixSize = 512;
+	options->margin = 0.1f;
+}
+
+RecognizerErrorStatus code2DLocate(const ScanlineImage* image, const Code2DLocatorOptions* options,
+		Code2DCandidate* candidates, size_t maxCandidates, size_t* numCandidates) {
+	Code2DLocatorOptions defaults;
+	LocatorState state;
+	size_t* finderOf;
+	Finder* finders;
+	TextureRegion* regions;
+	int* labels;
+	int* stack;
+	size_t numCells, numFinders, numRegions;
+	RecognizerErrorStatus status = RECOGNIZER_ERROR_STATUS_SUCCESS;
+
+	if (image == NULL || candidates == NULL || numCandidates == NULL) return RECOGNIZER_ERROR_STATUS_POINTER_IS_NULL;
+	*numCandidates = 0;
+	if (options == NULL) {
+		code2DLocatorOptionsInit(&defaults);
+		options = &defaults;
+	}
+	if (options->spacing < 1 || options->cellSize < 1 || image->width <= 0 || image->height <= 0) {
+		return RECOGNIZER_ERROR_STATUS_INVALID_TYPE;
+	}
+
+	memset(&state, 0, sizeof(state));
+	state.image = image;
+	state.cellSize = options->cellSize;
+	state.cellsX = (image->width + options->cellSize - 1) / options->cellSize;
+	state.cellsY = (image->height + options->cellSize - 1) / options->cellSize;
+	numCells = (size_t) state.cellsX * state.cellsY;
+	/* lines of solid edge search are longer than the image is wide only by their diagonal slack */
+	state.capacity = (size_t) (image->width + image->height);
+	state.samples = (unsigned char*) malloc(state.capacity);
+	state.runs = (unsigned int*) malloc(state.capacity * sizeof(unsigned int));
+	state.hits = (FinderHit*) malloc(MAX_HITS * sizeof(FinderHit));
+	state.edgesX = (unsigned int*) calloc(numCells, sizeof(unsigned int));
+	state.edgesY = (unsigned int*) calloc(numCells, sizeof(unsigned int));
+	state.linesX = (unsigned int*) calloc(numCells, sizeof(unsigned int));
+	state.linesY = (unsigned int*) calloc(numCells, sizeof(unsigned int));
+	finderOf = (size_t*) malloc(MAX_HITS * sizeof(size_t));
+	finders = (Finder*) malloc(MAX_FINDERS * sizeof(Finder));
+	regions = (TextureRegion*) malloc(MAX_REGIONS * sizeof(TextureRegion));
+	labels = (int*) malloc(numCells * sizeof(int));
+	stack = (int*) malloc(numCells * sizeof(int));
+
+	if (state.samples == NULL || state.runs == NULL || state.hits == NULL || state.edgesX == NULL
+			|| state.edgesY == NULL || state.linesX == NULL || state.linesY == NULL || finderOf == NULL
+			|| finders == NULL || regions == NULL || labels == NULL || stack == NULL) {
+		status = RECOGNIZER_ERROR_STATUS_FAIL;
+	} else {
+		scanImage(&state, options->spacing);
+		groupHits(state.hits, state.numHits);
+		numFinders = buildFinders(&state, options, finderOf, finders);
+		numRegions = labelTexture(&state, labels, stack, regions);
+		collectQR(&state, finders, numFinders, options, regions, numRegions, labels, candidates, maxCandidates,
+				numCandidates);
+		collectAztec(&state, finders, numFinders, options, regions, numRegions, labels, candidates, maxCandidates,
+				numCandidates);
+		collectDataMatrix(&state, regions, numRegions, options, candidates, maxCandidates, numCandidates);
+	}
+
+	free(state.samples);
+	free(state.runs);
+	free(state.hits);
+	free(state.edgesX);
+	free(state.edgesY);
+	free(state.linesX);
+	free(state.linesY);
+	free(finderOf);
+	free(finders);
+	free(regions);
+	free(labels);
+	free(stack);
+	return status;
+}
+
+void code2DProfile(const RecognizerProfile* base, Code2DSymbology symbology, RecognizerProfile* profile) {
+	recognizerProfileInit(profile);
+	profile->useZXing = 1;
+	profile->zxing.shouldScanInverse = base->zxing.shouldScanInverse;
+	profile->zxing.slowThoroughScan = base->zxing.slowThoroughScan;
+	profile->zxing.scanQRCode = symbology == CODE2D_SYMBOLOGY_QR || symbology == CODE2D_SYMBOLOGY_ANY;
+	profile->zxing.scanAztec = symbology == CODE2D_SYMBOLOGY_AZTEC || symbology == CODE2D_SYMBOLOGY_ANY;
+	profile->zxing.scanDataMatrix = symbology == CODE2D_SYMBOLOGY_DATA_MATRIX || symbology == CODE2D_SYMBOLOGY_ANY;
+	profile->outputMultipleResults = 1;
+}
+
+RecognizerErrorStatus recognizeCodes2D(const Recognizer* const* recognizers, size_t numRecognizers,
+		const RecognizerImage* image, const Code2DLocatorOptions* options, double deadlineMs, TiledResults* results,
+		Code2DSymbology* symbologies) {
+	Code2DCandidate candidates[CODE2D_MAX_SYMBOLS];
+	PPRectangle regions[CODE2D_MAX_SYMBOLS];
+	size_t classes[CODE2D_MAX_SYMBOLS];
+	ScanlineImage scanlineImage;
+	size_t numCandidates = 0, i;
+	RecognizerErrorStatus status;
+
+	if (results == NULL) return RECOGNIZER_ERROR_STATUS_POINTER_IS_NULL;
+	memset(results, 0, sizeof(*results));
+
+	status = scanlineImageInit(&scanlineImage, image);
+	if (status == RECOGNIZER_ERROR_STATUS_SUCCESS) {
+		status = code2DLocate(&scanlineImage, options, candidates, CODE2D_MAX_SYMBOLS, &numCandidates);
+	}
+	if (status != RECOGNIZER_ERROR_STATUS_SUCCESS) return status;
+
+	for (i = 0; i < numCandidates; ++i) {
+		regions[i] = candidates[i].region;
+		classes[i] = (size_t) candidates[i].symbology;
+	}
+	if (numCandidates == 0) {
+		/* one pass reading every symbology costs less than a pass per symbology over the same pixels */
+		regions[0].x = 0.f;
+		regions[0].y = 0.f;
+		regions[0].width = (float) scanlineImage.width;
+		regions[0].height = (float) scanlineImage.height;
+		classes[0] = CODE2D_SYMBOLOGY_ANY;
+		numCandidates = 1;
+	}
+	if (symbologies != NULL) {
+		for (i = 0; i < numCandidates; ++i) symbologies[i] = (Code2DSymbology) classes[i];
+	}
+	return recognizeClassifiedRegions(recognizers, numRecognizers, CODE2D_SYMBOLOGY_COUNT, image, regions, classes,
+			numCandidates, deadlineMs, results);
+}
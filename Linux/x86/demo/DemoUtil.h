@@ -0,0 +1,118 @@
+#ifndef DEMOUTIL_H_
+#define DEMOUTIL_H_
+
+#include <stddef.h>
+#include <stdio.h>
+
+#include "RecognizerApi.h"
+#include "StringView.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Growable buffer for one line of JSON output. Zero-initialize before the first append.
+ */
+typedef struct JsonBuffer {
+	char* data;
+	size_t size;
+	size_t capacity;
+	/* set when memory ran out; further appends are ignored */
+	int failed;
+} JsonBuffer;
+
+/**
+ * Returns number of bytes per pixel in a row of an image of given type. NV21 rows are rows of its luma plane, one
+ * byte per pixel.
+ *
+ *  @param type type of the image
+ *
+ *  @return 4 for BGRA, 3 for BGR, 1 otherwise
+ */
+int demoBytesPerPixel(RawImageType type);
+
+/**
+ * Returns luma of a pixel with integer BT.601 weights. NV21 luma plane comes first, so it is read like GRAY.
+ *
+ *  @param pixel    first byte of the pixel
+ *  @param type     type of the image
+ *
+ *  @return luma from 0 to 255
+ */
+unsigned int demoLuma(const unsigned char* pixel, RawImageType type);
+
+/**
+ * Reads next non-empty line of list into path, without line terminator.
+ *
+ *  @param list     file with one path per line
+ *  @param path     destination
+ *  @param capacity size of path in bytes
+ *
+ *  @return non-zero if a path has been read, zero at the end of list
+ */
+int demoReadPath(FILE* list, char* path, size_t capacity);
+
+/**
+ * Copies next path of files into path, or reads it from stdin when files is NULL.
+ *
+ *  @param files    paths given on command line, or NULL
+ *  @param numFiles number of paths in files
+ *  @param index    index of the next path in files, advanced by the call
+ *  @param path     destination
+ *  @param capacity size of path in bytes
+ *
+ *  @return non-zero if a path has been obtained, zero when there are no more
+ */
+int demoNextPath(char* const* files, int numFiles, int* index, char* path, size_t capacity);
+
+/**
+ * Appends bytes to buffer, keeping it zero-terminated.
+ *
+ *  @param json buffer
+ *  @param data bytes to append
+ *  @param size number of bytes
+ */
+void jsonAppend(JsonBuffer* json, const char* data, size_t size);
+
+/**
+ * Appends zero-terminated text to buffer as it is.
+ *
+ *  @param json buffer
+ *  @param text text to append
+ */
+void jsonAppendText(JsonBuffer* json, const char* text);
+
+/**
+ * Appends quoted JSON string. Quotes, backslashes and control characters are escaped; other bytes, including UTF-8
+ * sequences, are copied as they are.
+ *
+ *  @param json     buffer
+ *  @param data     string, not necessarily zero-terminated
+ *  @param length   length of string in bytes
+ */
+void jsonAppendString(JsonBuffer* json, const char* data, size_t length);
+
+/**
+ * Appends "name":"value" member, preceded by a comma unless it is the first one. Empty values are skipped.
+ *
+ *  @param json     buffer
+ *  @param first    non-zero if no member has been appended yet, cleared when one is
+ *  @param name     name of the member
+ *  @param value    value of the member
+ */
+void jsonAppendField(JsonBuffer* json, int* first, const char* name, StringView value);
+
+/**
+ * Writes quoted JSON string to stdout, escaped like jsonAppendString.
+ *
+ *  @param data     string, not necessarily zero-terminated
+ *  @param length   length of string in bytes
+ */
+void jsonPrintString(const char* data, size_t length);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
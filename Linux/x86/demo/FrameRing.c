@@ -0,0 +1,285 @@
+#define _GNU_SOURCE
+
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "FrameRing.h"
+#include "DemoUtil.h"
+
+#define CACHE_LINE 64
+
+/* "FRG1" */
+#define FRAME_RING_MAGIC 0x31475246u
+
+/* Layout at the start of shared memory. Producer and consumer indices live on separate cache lines, so that
+the two processes do not invalidate each other's line on every frame. All fields are 32 bit, so 32-bit and
+64-bit processes can share a ring. */
+typedef struct FrameRingHeader {
+	unsigned int magic;
+	unsigned int numSlots;
+	unsigned int slotCapacity;
+	unsigned int slotStride;
+	unsigned char pad0[CACHE_LINE - 4 * sizeof(unsigned int)];
+	/* number of frames published by producer, written by producer only */
+	unsigned int head;
+	unsigned char pad1[CACHE_LINE - sizeof(unsigned int)];
+	/* number of frames released by consumer, written by consumer only */
+	unsigned int tail;
+	unsigned char pad2[CACHE_LINE - sizeof(unsigned int)];
+} FrameRingHeader;
+
+/* Descriptor at the start of each slot, pixels follow at CACHE_LINE offset */
+typedef struct FrameRingSlot {
+	unsigned int width;
+	unsigned int height;
+	unsigned int bytesPerRow;
+	unsigned int rawType;
+} FrameRingSlot;
+
+struct FrameRing {
+	int fd;
+	unsigned char* memory;
+	size_t size;
+	FrameRingHeader* header;
+	/* geometry validated at create or attach. Shared memory is writable by the other process, so it is never read
+	from the header again. */
+	unsigned int numSlots;
+	size_t slotCapacity;
+	size_t slotStride;
+	/* index of the next frame wrapped by consumer. Frames between tail and readIndex are held in images or dropped. */
+	unsigned int readIndex;
+	/* images held by consumer */
+	unsigned int numHeld;
+};
+
+/* Size of a frame in bytes, or zero if the frame is not valid. Computed in 64 bits, so it cannot wrap on x86. */
+static unsigned long long frameSize(unsigned long long width, unsigned long long height, unsigned long long bytesPerRow,
+		unsigned int rawType) {
+	unsigned long long size;
+
+	if (width == 0 || height == 0 || width > 0x7FFFFFFF || height > 0x7FFFFFFF || rawType > RAW_IMAGE_TYPE_NV21) return 0;
+	if (bytesPerRow < width * demoBytesPerPixel((RawImageType) rawType)) return 0;
+	size = bytesPerRow * height;
+	/* NV21 has interleaved chroma plane of half height after the luma plane */
+	if (rawType == RAW_IMAGE_TYPE_NV21) size += size / 2;
+	return size;
+}
+
+static FrameRingSlot* slotAt(const FrameRing* ring, unsigned int index) {
+	/* numSlots is a power of two, so consecutive indices map to consecutive slots also across the wrap of index */
+	size_t offset = sizeof(FrameRingHeader) + (size_t) (index & (ring->numSlots - 1)) * ring->slotStride;
+	return (FrameRingSlot*) (ring->memory + offset);
+}
+
+static unsigned char* slotPixels(FrameRingSlot* slot) {
+	return (unsigned char*) slot + CACHE_LINE;
+}
+
+static RecognizerErrorStatus mapRing(FrameRing** ring, int fd, size_t size, const FrameRingHeader* geometry) {
+	FrameRing* r = (FrameRing*) calloc(1, sizeof(FrameRing));
+	if (r == NULL) return RECOGNIZER_ERROR_STATUS_FAIL;
+
+	r->memory = (unsigned char*) mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	if (r->memory == MAP_FAILED) {
+		free(r);
+		return RECOGNIZER_ERROR_STATUS_FAIL;
+	}
+	r->fd = fd;
+	r->size = size;
+	r->header = (FrameRingHeader*) r->memory;
+	r->numSlots = geometry->numSlots;
+	r->slotCapacity = geometry->slotCapacity;
+	r->slotStride = geometry->slotStride;
+	*ring = r;
+	return RECOGNIZER_ERROR_STATUS_SUCCESS;
+}
+
+RecognizerErrorStatus frameRingCreate(FrameRing** ring, unsigned int numSlots, size_t slotCapacity) {
+	RecognizerErrorStatus status;
+	FrameRingHeader geometry;
+	size_t stride, size;
+	int fd;
+
+	if (ring == NULL) return RECOGNIZER_ERROR_STATUS_POINTER_IS_NULL;
+	*ring = NULL;
+	if (numSlots == 0 || (numSlots & (numSlots - 1)) != 0 || slotCapacity == 0
+			|| slotCapacity > 0xFFFFFFFFu - 2 * CACHE_LINE) {
+		return RECOGNIZER_ERROR_STATUS_INDEX_OUT_OF_RANGE;
+	}
+
+	stride = (CACHE_LINE + slotCapacity + CACHE_LINE - 1) & ~(size_t) (CACHE_LINE - 1);
+	if (stride > ((size_t) -1 - sizeof(FrameRingHeader)) / numSlots) return RECOGNIZER_ERROR_STATUS_INDEX_OUT_OF_RANGE;
+	size = sizeof(FrameRingHeader) + stride * numSlots;
+	geometry.numSlots = numSlots;
+	geometry.slotCapacity = (unsigned int) slotCapacity;
+	geometry.slotStride = (unsigned int) stride;
+
+	/* size is sealed, so that neither side can shrink the ring under the other's mapping and raise SIGBUS there */
+	fd = memfd_create("frame-ring", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+	if (fd < 0) return RECOGNIZER_ERROR_STATUS_FAIL;
+	if (ftruncate(fd, (off_t) size) != 0 || fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW) != 0) {
+		close(fd);
+		return RECOGNIZER_ERROR_STATUS_FAIL;
+	}
+
+	status = mapRing(ring, fd, size, &geometry);
+	if (status != RECOGNIZER_ERROR_STATUS_SUCCESS) {
+		close(fd);
+		return status;
+	}
+
+	/* memory of a new memfd is zeroed, so indices start at zero */
+	(*ring)->header->numSlots = geometry.numSlots;
+	(*ring)->header->slotCapacity = geometry.slotCapacity;
+	(*ring)->header->slotStride = geometry.slotStride;
+	__atomic_store_n(&(*ring)->header->magic, FRAME_RING_MAGIC, __ATOMIC_RELEASE);
+	return RECOGNIZER_ERROR_STATUS_SUCCESS;
+}
+
+RecognizerErrorStatus frameRingAttach(FrameRing** ring, int fd) {
+	FrameRingHeader header;
+	RecognizerErrorStatus status;
+	struct stat st;
+	int ownFd, seals;
+
+	if (ring == NULL) return RECOGNIZER_ERROR_STATUS_POINTER_IS_NULL;
+	*ring = NULL;
+
+	/* an unsealed ring could be truncated by the producer while frames are read from it */
+	seals = fcntl(fd, F_GET_SEALS);
+	if (seals < 0 || (seals & (F_SEAL_SHRINK | F_SEAL_GROW)) != (F_SEAL_SHRINK | F_SEAL_GROW)) {
+		return RECOGNIZER_ERROR_STATUS_INVALID_TYPE;
+	}
+	if (fstat(fd, &st) != 0 || (size_t) st.st_size < sizeof(FrameRingHeader)
+			|| pread(fd, &header, sizeof(header), 0) != (ssize_t) sizeof(header)
+			|| header.magic != FRAME_RING_MAGIC || header.numSlots == 0 || (header.numSlots & (header.numSlots - 1)) != 0
+			|| (unsigned long long) st.st_size
+					< sizeof(FrameRingHeader) + (unsigned long long) header.slotStride * header.numSlots
+			|| header.slotStride < CACHE_LINE + (unsigned long long) header.slotCapacity) {
+		return RECOGNIZER_ERROR_STATUS_INVALID_TYPE;
+	}
+
+	ownFd = fcntl(fd, F_DUPFD_CLOEXEC, 0);
+	if (ownFd < 0) return RECOGNIZER_ERROR_STATUS_FAIL;
+	status = mapRing(ring, ownFd, (size_t) st.st_size, &header);
+	if (status != RECOGNIZER_ERROR_STATUS_SUCCESS) {
+		close(ownFd);
+		return status;
+	}
+	(*ring)->readIndex = __atomic_load_n(&(*ring)->header->tail, __ATOMIC_ACQUIRE);
+	return RECOGNIZER_ERROR_STATUS_SUCCESS;
+}
+
+RecognizerErrorStatus frameRingGetFd(const FrameRing* ring, int* fd) {
+	if (ring == NULL || fd == NULL) return RECOGNIZER_ERROR_STATUS_POINTER_IS_NULL;
+	*fd = ring->fd;
+	return RECOGNIZER_ERROR_STATUS_SUCCESS;
+}
+
+RecognizerErrorStatus frameRingBeginWrite(FrameRing* ring, void** pixels, size_t* capacity) {
+	unsigned int head, tail;
+
+	if (ring == NULL || pixels == NULL) return RECOGNIZER_ERROR_STATUS_POINTER_IS_NULL;
+
+	/* head is written by this side only, tail must be acquired so that consumer is done reading the slot */
+	head = ring->header->head;
+	tail = __atomic_load_n(&ring->header->tail, __ATOMIC_ACQUIRE);
+	if (head - tail >= ring->numSlots) return RECOGNIZER_ERROR_STATUS_FAIL;
+
+	*pixels = slotPixels(slotAt(ring, head));
+	if (capacity != NULL) *capacity = ring->slotCapacity;
+	return RECOGNIZER_ERROR_STATUS_SUCCESS;
+}
+
+RecognizerErrorStatus frameRingEndWrite(FrameRing* ring, int width, int height, size_t bytesPerRow, RawImageType rawType) {
+	FrameRingSlot* slot;
+	unsigned int head;
+	unsigned long long size;
+
+	if (ring == NULL) return RECOGNIZER_ERROR_STATUS_POINTER_IS_NULL;
+
+	size = width > 0 && height > 0 && bytesPerRow <= 0xFFFFFFFFu
+			? frameSize((unsigned long long) width, (unsigned long long) height, bytesPerRow, (unsigned int) rawType) : 0;
+	if (size == 0 || size > ring->slotCapacity) return RECOGNIZER_ERROR_STATUS_INDEX_OUT_OF_RANGE;
+
+	head = ring->header->head;
+	if (head - __atomic_load_n(&ring->header->tail, __ATOMIC_ACQUIRE) >= ring->numSlots) {
+		return RECOGNIZER_ERROR_STATUS_FAIL;
+	}
+
+	slot = slotAt(ring, head);
+	slot->width = (unsigned int) width;
+	slot->height = (unsigned int) height;
+	slot->bytesPerRow = (unsigned int) bytesPerRow;
+	slot->rawType = (unsigned int) rawType;
+	/* release makes pixels and descriptor visible before the consumer sees the new head */
+	__atomic_store_n(&ring->header->head, head + 1, __ATOMIC_RELEASE);
+	return RECOGNIZER_ERROR_STATUS_SUCCESS;
+}
+
+/* Releases slots of deleted images and dropped frames. With no image held, every slot up to readIndex is free;
+otherwise the oldest held slot is the one being released, or one after it. */
+static void releaseSlots(FrameRing* ring) {
+	unsigned int tail = ring->numHeld == 0 ? ring->readIndex : ring->header->tail + 1;
+	__atomic_store_n(&ring->header->tail, tail, __ATOMIC_RELEASE);
+}
+
+RecognizerErrorStatus frameRingImageCreate(FrameRing* ring, RecognizerImage** image) {
+	FrameRingSlot* slot;
+	FrameRingSlot descriptor;
+	RecognizerErrorStatus status;
+	unsigned long long size;
+
+	if (ring == NULL || image == NULL) return RECOGNIZER_ERROR_STATUS_POINTER_IS_NULL;
+
+	if (ring->readIndex == __atomic_load_n(&ring->header->head, __ATOMIC_ACQUIRE)) return RECOGNIZER_ERROR_STATUS_FAIL;
+
+	/* descriptor is copied before it is checked, so that the producer cannot change it between check and use */
+	slot = slotAt(ring, ring->readIndex);
+	memcpy(&descriptor, slot, sizeof(descriptor));
+	size = frameSize(descriptor.width, descriptor.height, descriptor.bytesPerRow, descriptor.rawType);
+	if (size == 0 || size > ring->slotCapacity) {
+		/* frame is dropped, so that one bad frame does not stall the ring */
+		++ring->readIndex;
+		if (ring->numHeld == 0) releaseSlots(ring);
+		return RECOGNIZER_ERROR_STATUS_INVALID_TYPE;
+	}
+
+	status = recognizerImageCreateFromRawImage(image, slotPixels(slot), (int) descriptor.width, (int) descriptor.height,
+			descriptor.bytesPerRow, (RawImageType) descriptor.rawType);
+	if (status != RECOGNIZER_ERROR_STATUS_SUCCESS) return status;
+
+	++ring->readIndex;
+	++ring->numHeld;
+	return RECOGNIZER_ERROR_STATUS_SUCCESS;
+}
+
+RecognizerErrorStatus frameRingImageDelete(FrameRing* ring, RecognizerImage** image) {
+	RecognizerErrorStatus status;
+
+	if (ring == NULL || image == NULL || *image == NULL) return RECOGNIZER_ERROR_STATUS_POINTER_IS_NULL;
+
+	status = recognizerImageDelete(image);
+	if (status != RECOGNIZER_ERROR_STATUS_SUCCESS) return status;
+
+	/* images are deleted in creation order */
+	if (ring->numHeld > 0) {
+		--ring->numHeld;
+		releaseSlots(ring);
+	}
+	return RECOGNIZER_ERROR_STATUS_SUCCESS;
+}
+
+RecognizerErrorStatus frameRingDelete(FrameRing** ring) {
+	if (ring == NULL || *ring == NULL) return RECOGNIZER_ERROR_STATUS_POINTER_IS_NULL;
+
+	munmap((*ring)->memory, (*ring)->size);
+	close((*ring)->fd);
+	free(*ring);
+	*ring = NULL;
+	return RECOGNIZER_ERROR_STATUS_SUCCESS;
+}
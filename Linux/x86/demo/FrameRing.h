@@ -0,0 +1,118 @@
+#ifndef FRAMERING_H_
+#define FRAMERING_H_
+
+#include <stddef.h>
+
+#include "RecognizerApi.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Single-producer/single-consumer ring of frames in shared memory (memfd), for passing camera frames from a capture
+ * process to a recognition process without copying them. Producer writes pixels straight into a slot, consumer wraps
+ * the slot into RecognizerImage. Indices are updated with atomic operations only, no locks or system calls are used
+ * per frame.
+ *
+ * Each side must be used from a single thread.
+ */
+typedef struct FrameRing FrameRing;
+
+/**
+ * Creates ring backed by a new memfd, sealed against shrinking and growing. Called by the producer.
+ *
+ *  @param ring         pointer to pointer referencing the created ring, set to NULL on error
+ *  @param numSlots     number of frames ring can hold, a power of two
+ *  @param slotCapacity size of pixel data of one frame in bytes
+ *
+ *  @return status of the operation
+ */
+RecognizerErrorStatus frameRingCreate(FrameRing** ring, unsigned int numSlots, size_t slotCapacity);
+
+/**
+ * Maps ring created by another process. Called by the consumer with the descriptor obtained from the producer,
+ * e.g. inherited over fork or received with SCM_RIGHTS. Descriptor is duplicated, so caller may close it.
+ *
+ *  @param ring pointer to pointer referencing the attached ring, set to NULL on error
+ *  @param fd   descriptor returned by frameRingGetFd in the producer
+ *
+ *  @return status of the operation. RECOGNIZER_ERROR_STATUS_INVALID_TYPE if fd does not hold a frame ring or is not
+ *          sealed against shrinking and growing.
+ */
+RecognizerErrorStatus frameRingAttach(FrameRing** ring, int fd);
+
+/**
+ * Returns memfd backing the ring, to be handed to the consumer. Descriptor is owned by ring.
+ *
+ *  @param ring ring
+ *  @param fd   destination of descriptor
+ *
+ *  @return status of the operation
+ */
+RecognizerErrorStatus frameRingGetFd(const FrameRing* ring, int* fd);
+
+/**
+ * Returns slot to which the producer writes pixels of the next frame.
+ *
+ *  @param ring     ring
+ *  @param pixels   destination of pointer to slot pixels
+ *  @param capacity if non-NULL, set to size of slot in bytes
+ *
+ *  @return status of the operation. RECOGNIZER_ERROR_STATUS_FAIL if ring is full, i.e. consumer has not released
+ *          the oldest frame yet. Producer would then typically drop the frame.
+ */
+RecognizerErrorStatus frameRingBeginWrite(FrameRing* ring, void** pixels, size_t* capacity);
+
+/**
+ * Publishes frame written to slot returned by frameRingBeginWrite.
+ *
+ *  @param ring         ring
+ *  @param width        width of the frame in pixels
+ *  @param height       height of the frame in pixels
+ *  @param bytesPerRow  number of bytes in every row of the frame
+ *  @param rawType      type of the frame
+ *
+ *  @return status of the operation. RECOGNIZER_ERROR_STATUS_INDEX_OUT_OF_RANGE if frame does not fit into slot, or
+ *          bytesPerRow is less than width times bytes per pixel.
+ */
+RecognizerErrorStatus frameRingEndWrite(FrameRing* ring, int width, int height, size_t bytesPerRow, RawImageType rawType);
+
+/**
+ * Wraps the oldest published frame into image, without copying pixels. Slot stays owned by the consumer until the
+ * image is deleted with frameRingImageDelete. When several images are held, they must be deleted in the order they
+ * were created. The descriptor written by the producer is checked against the slot, so a faulty producer cannot
+ * make the consumer read outside the ring.
+ *
+ *  @param ring     ring
+ *  @param image    pointer to pointer referencing the created image
+ *
+ *  @return status of the operation. RECOGNIZER_ERROR_STATUS_FAIL if no frame is available,
+ *          RECOGNIZER_ERROR_STATUS_INVALID_TYPE if the frame did not fit into its slot and was dropped.
+ */
+RecognizerErrorStatus frameRingImageCreate(FrameRing* ring, RecognizerImage** image);
+
+/**
+ * Deletes image created by frameRingImageCreate and returns its slot to the producer.
+ *
+ *  @param ring     ring
+ *  @param image    pointer to pointer referencing the image, set to NULL
+ *
+ *  @return status of the operation
+ */
+RecognizerErrorStatus frameRingImageDelete(FrameRing* ring, RecognizerImage** image);
+
+/**
+ * Unmaps ring and closes its descriptor. Shared memory is freed once both sides have deleted the ring.
+ *
+ *  @param ring pointer to pointer referencing the ring, set to NULL
+ *
+ *  @return status of the operation
+ */
+RecognizerErrorStatus frameRingDelete(FrameRing** ring);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
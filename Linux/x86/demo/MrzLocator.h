@@ -0,0 +1,88 @@
+#ifndef MRZLOCATOR_H_
+#define MRZLOCATOR_H_
+
+#include "RecognizerApi.h"
+#include "RecognizeOptions.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Options of MRZ localisation.
+ */
+typedef struct MrzLocatorOptions {
+	/* width of the sampled copy on which MRZ is searched for, in pixels. Work done by localisation depends on this
+	width only, not on the size of the image. */
+	int workWidth;
+	/* minimum difference of neighbouring gray levels counted as a character edge */
+	int edgeThreshold;
+	/* band is extended above and below by this fraction of its height, and to the sides by half of it */
+	float margin;
+	/* region searched in relative coordinates, or NULL for the whole image. The band never extends past it. */
+	const PPRectangle* roi;
+	/* if non-zero, recognizeMrzCoarseToFine recognizes the whole region again when the band gives no valid result */
+	int retryWholeImage;
+} MrzLocatorOptions;
+
+/**
+ * Part of the image from which recognizeMrzCoarseToFine returned its result.
+ */
+typedef enum MrzLocalization {
+	/* no band has been found, the whole region has been recognized once */
+	MRZ_LOCALIZATION_NONE,
+	/* band has been recognized, result comes from it only */
+	MRZ_LOCALIZATION_BAND,
+	/* band gave no valid result and the whole region has been recognized after it, taking both recognitions */
+	MRZ_LOCALIZATION_RETRIED
+} MrzLocalization;
+
+/**
+ * Initializes options for a 640 pixel wide copy, edge threshold of 24 and 25% margin, searching the whole image and
+ * retrying it when the band fails.
+ *
+ *  @param options options to initialize
+ */
+void mrzLocatorOptionsInit(MrzLocatorOptions* options);
+
+/**
+ * Finds band of the image likely holding the MRZ. Region of the image given by options is point sampled into a
+ * fixed-size gray copy, on which rows dense in character edges are searched for; MRZ is the largest group of such rows spanning a wide part of the copy.
+ * Only the copy is read after sampling, so time taken is nearly independent of image resolution.
+ *
+ *  @param image    image to search
+ *  @param options  options, or NULL for defaults
+ *  @param band     destination of the band in relative coordinates of the whole image, inside the searched region,
+ *                  usable as RecognizeOptions::roi
+ *  @param found    set to non-zero if a band has been found. band is left untouched otherwise.
+ *
+ *  @return status of the operation
+ */
+RecognizerErrorStatus mrzLocate(const RecognizerImage* image, const MrzLocatorOptions* options, PPRectangle* band,
+		int* found);
+
+/**
+ * Performs recognition of MRZ coarse-to-fine: the MRZ band is localised with mrzLocate and only the band is
+ * recognized at full resolution. If no band is found, the whole image is recognized. If recognition of the band gives
+ * no valid result, the whole image is recognized again unless MrzLocatorOptions::retryWholeImage is zero, which
+ * doubles the cost of such images; localized tells the cases apart. If options have a ROI, it is searched and
+ * recognized instead of the whole image.
+ *
+ *  @param recognizer       recognizer used for recognition
+ *  @param resultList       destination of the result list, see recognizerRecognizeFromImage
+ *  @param image            image on which recognition will be performed
+ *  @param options          per-call options, or NULL for defaults. Band, found inside ROI of options, replaces it.
+ *  @param locatorOptions   localisation options, or NULL for defaults. Their ROI is replaced by ROI of options.
+ *  @param localized        if non-NULL, set to the part of the image the returned result list comes from
+ *
+ *  @return status of the operation
+ */
+RecognizerErrorStatus recognizeMrzCoarseToFine(const Recognizer* recognizer, RecognizerResultList** resultList,
+		const RecognizerImage* image, const RecognizeOptions* options, const MrzLocatorOptions* locatorOptions,
+		MrzLocalization* localized);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
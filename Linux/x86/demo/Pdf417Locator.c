@@ -0,0 +1,432 @@
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "Pdf417Locator.h"
+
+/* located symbols recognized by recognizePdf417Located at most */
+#define MAX_LOCATED_SYMBOLS 16
+/* hits kept per image; more only come from dense false matches */
+#define MAX_HITS 8192
+
+typedef enum PatternKind {
+	PATTERN_START,
+	PATTERN_STOP,
+	PATTERN_START_REVERSED,
+	PATTERN_STOP_REVERSED
+} PatternKind;
+
+typedef struct Pattern {
+	PatternKind kind;
+	/* non-zero if the first element is a bar. The start pattern ends with a space, so read backwards it starts with one. */
+	int dark;
+	/* widths of alternating bars and spaces in modules */
+	int widths[9];
+	int length;
+	int modules;
+} Pattern;
+
+static const Pattern patterns[] = {
+	{ PATTERN_START, 1, { 8, 1, 1, 1, 1, 1, 1, 3 }, 8, 17 },
+	{ PATTERN_STOP, 1, { 7, 1, 1, 3, 1, 1, 1, 2, 1 }, 9, 18 },
+	{ PATTERN_START_REVERSED, 0, { 3, 1, 1, 1, 1, 1, 1, 8 }, 8, 17 },
+	{ PATTERN_STOP_REVERSED, 1, { 1, 2, 1, 1, 1, 3, 1, 1, 7 }, 9, 18 }
+};
+
+/* Match of a start or stop pattern at the outer edge of the pattern, i.e. on the border of the symbol */
+typedef struct PatternHit {
+	float x;
+	float y;
+	int isStop;
+	/* direction from the pattern into the symbol, i.e. along its rows */
+	int inwardX;
+	int inwardY;
+	/* union-find parent, hits of one symbol share the root */
+	size_t parent;
+} PatternHit;
+
+/* Hits of one pattern column, or of a whole symbol once start and stop are joined */
+typedef struct HitGroup {
+	size_t numStartHits;
+	size_t numStopHits;
+	float left;
+	float top;
+	float right;
+	float bottom;
+	float sumX;
+	float sumY;
+	/* sum of inward directions of the hits */
+	float inwardX;
+	float inwardY;
+} HitGroup;
+
+typedef struct LocatorState {
+	const ScanlineImage* image;
+	unsigned char* samples;
+	unsigned int* runs;
+	size_t capacity;
+	PatternHit* hits;
+	size_t numHits;
+} LocatorState;
+
+static size_t findRoot(PatternHit* hits, size_t i) {
+	while (hits[i].parent != i) {
+		/* path halving keeps trees flat without recursion */
+		hits[i].parent = hits[hits[i].parent].parent;
+		i = hits[i].parent;
+	}
+	return i;
+}
+
+static void unite(PatternHit* hits, size_t a, size_t b) {
+	a = findRoot(hits, a);
+	b = findRoot(hits, b);
+	if (a != b) hits[b].parent = a;
+}
+
+/* Non-zero if runs match pattern within tolerance. Module width is derived from the total width of the runs. */
+static int matchPattern(const unsigned int* runs, const Pattern* pattern, float* module) {
+	unsigned int total = 0;
+	float variance = 0.f;
+	int i;
+
+	for (i = 0; i < pattern->length; ++i) total += runs[i];
+	if (total < (unsigned int) pattern->modules) return 0;
+	*module = (float) total / pattern->modules;
+
+	for (i = 0; i < pattern->length; ++i) {
+		float diff = runs[i] / *module - pattern->widths[i];
+		if (diff < 0.f) diff = -diff;
+		if (diff > 0.7f) return 0;
+		variance += diff;
+	}
+	return variance <= 0.25f * pattern->modules;
+}
+
+/* Non-zero if run is a quiet zone of at least two modules, or the scanline ends there */
+static int isQuietZone(const unsigned int* runs, size_t numRuns, long index, float module) {
+	if (index < 0 || (size_t) index >= numRuns) return 1;
+	return runs[index] >= 2.f * module;
+}
+
+static size_t addHit(LocatorState* state, float x, float y, int isStop, int inwardX, int inwardY) {
+	PatternHit* hit;
+
+	if (state->numHits == MAX_HITS) return (size_t) -1;
+	hit = &state->hits[state->numHits];
+	hit->x = x;
+	hit->y = y;
+	hit->isStop = isStop;
+	hit->inwardX = inwardX;
+	hit->inwardY = inwardY;
+	hit->parent = state->numHits;
+	return state->numHits++;
+}
+
+/* Matches patterns on the scanline of length samples starting at (x0, y0) and advancing by (stepX, stepY) */
+static void scanLine(LocatorState* state, int x0, int y0, int stepX, int stepY, int length) {
+	size_t numSamples, numRuns, k, position, hit;
+	/* hit a symbol is entered through on this scanline; a matching exit pattern joins both into one symbol */
+	size_t entry = (size_t) -1;
+	int firstDark;
+
+	if (length < 17) return;
+	numSamples = scanlineSample(state->image, x0, y0, x0 + (length - 1) * stepX, y0 + (length - 1) * stepY,
+			state->samples, state->capacity);
+	numRuns = scanlineRuns(state->samples, numSamples, scanlineThreshold(state->samples, numSamples), state->runs,
+			state->capacity, &firstDark);
+
+	for (k = 0, position = 0; k + 8 <= numRuns; position += state->runs[k++]) {
+		/* runs alternate in colour */
+		int dark = k % 2 == 0 ? firstDark : !firstDark;
+		size_t p;
+
+		for (p = 0; p < sizeof(patterns) / sizeof(patterns[0]); ++p) {
+			const Pattern* pattern = &patterns[p];
+			size_t edge = position, end = position;
+			float module;
+			int i, entering;
+
+			if (pattern->dark != dark || k + pattern->length > numRuns) continue;
+			if (!matchPattern(state->runs + k, pattern, &module)) continue;
+			for (i = 0; i < pattern->length; ++i) end += state->runs[k + i];
+
+			/* start is preceded and stop followed by a quiet zone; reversed patterns mirror that */
+			if (pattern->kind == PATTERN_START || pattern->kind == PATTERN_STOP_REVERSED) {
+				if (!isQuietZone(state->runs, numRuns, (long) k - 1, module)) continue;
+			} else {
+				if (!isQuietZone(state->runs, numRuns, (long) (k + pattern->length), module)) continue;
+				edge = end - 1;
+			}
+
+			entering = pattern->kind == PATTERN_START || pattern->kind == PATTERN_STOP_REVERSED;
+			hit = addHit(state, (float) (x0 + (long) edge * stepX), (float) (y0 + (long) edge * stepY),
+					pattern->kind == PATTERN_STOP || pattern->kind == PATTERN_STOP_REVERSED,
+					entering ? stepX : -stepX, entering ? stepY : -stepY);
+			if (hit == (size_t) -1) return;
+
+			if (entering) {
+				entry = hit;
+			} else if (entry != (size_t) -1) {
+				unite(state->hits, entry, hit);
+				entry = (size_t) -1;
+			}
+			break;
+		}
+	}
+}
+
+/* Runs scanlines in four orientations over the whole image */
+static void scanImage(LocatorState* state, int spacing) {
+	int width = state->image->width;
+	int height = state->image->height;
+	int c;
+
+	for (c = spacing / 2; c < height; c += spacing) scanLine(state, 0, c, 1, 0, width);
+	for (c = spacing / 2; c < width; c += spacing) scanLine(state, c, 0, 0, 1, height);
+	/* down-right diagonals, indexed by x - y */
+	for (c = -(height - 1) + spacing / 2; c < width; c += spacing) {
+		int x0 = c >= 0 ? c : 0;
+		int y0 = c >= 0 ? 0 : -c;
+		scanLine(state, x0, y0, 1, 1, width - x0 < height - y0 ? width - x0 : height - y0);
+	}
+	/* up-right diagonals, indexed by x + y */
+	for (c = spacing / 2; c < width + height - 1; c += spacing) {
+		int x0 = c < height ? 0 : c - height + 1;
+		int y0 = c < height ? c : height - 1;
+		scanLine(state, x0, y0, 1, -1, width - x0 < y0 + 1 ? width - x0 : y0 + 1);
+	}
+}
+
+/* Joins hits closer than maxDistance, so that matches along one pattern form one group */
+static void groupNearbyHits(PatternHit* hits, size_t numHits, float maxDistance) {
+	float limit = maxDistance * maxDistance;
+	size_t i, j;
+
+	for (i = 0; i < numHits; ++i) {
+		for (j = i + 1; j < numHits; ++j) {
+			float dx = hits[i].x - hits[j].x;
+			float dy = hits[i].y - hits[j].y;
+			if (dx * dx + dy * dy <= limit) unite(hits, i, j);
+		}
+	}
+}
+
+/* Builds one group per union-find root. groupOf maps hits to groups. */
+static size_t buildGroups(PatternHit* hits, size_t numHits, size_t* groupOf, HitGroup* groups) {
+	size_t numGroups = 0;
+	size_t i;
+
+	for (i = 0; i < numHits; ++i) groupOf[i] = (size_t) -1;
+	for (i = 0; i < numHits; ++i) {
+		size_t root = findRoot(hits, i);
+		HitGroup* group;
+
+		if (groupOf[root] == (size_t) -1) {
+			group = &groups[numGroups];
+			memset(group, 0, sizeof(*group));
+			group->left = group->right = hits[i].x;
+			group->top = group->bottom = hits[i].y;
+			groupOf[root] = numGroups++;
+		}
+		group = &groups[groupOf[root]];
+		if (hits[i].isStop) ++group->numStopHits;
+		else ++group->numStartHits;
+		if (hits[i].x < group->left) group->left = hits[i].x;
+		if (hits[i].x > group->right) group->right = hits[i].x;
+		if (hits[i].y < group->top) group->top = hits[i].y;
+		if (hits[i].y > group->bottom) group->bottom = hits[i].y;
+		group->sumX += hits[i].x;
+		group->sumY += hits[i].y;
+		group->inwardX += (float) hits[i].inwardX;
+		group->inwardY += (float) hits[i].inwardY;
+	}
+	return numGroups;
+}
+
+static void mergeGroup(HitGroup* into, HitGroup* from) {
+	into->numStartHits += from->numStartHits;
+	into->numStopHits += from->numStopHits;
+	if (from->left < into->left) into->left = from->left;
+	if (from->right > into->right) into->right = from->right;
+	if (from->top < into->top) into->top = from->top;
+	if (from->bottom > into->bottom) into->bottom = from->bottom;
+	into->sumX += from->sumX;
+	into->sumY += from->sumY;
+	into->inwardX += from->inwardX;
+	into->inwardY += from->inwardY;
+	from->numStartHits = from->numStopHits = 0;
+}
+
+/* Length of the pattern column a group lies on */
+static float groupLength(const HitGroup* group) {
+	float width = group->right - group->left;
+	float height = group->bottom - group->top;
+	return (float) sqrt(width * width + height * height);
+}
+
+/* Joins groups holding only a start pattern with the nearest group holding only a stop pattern of the same symbol.
+Scanlines far from the row direction never cross both patterns, so they are paired geometrically: the stop must lie
+inwards from the start and the start inwards from the stop, and both columns must be of similar length. */
+static void pairGroups(HitGroup* groups, size_t numGroups) {
+	size_t i, j;
+
+	for (i = 0; i < numGroups; ++i) {
+		HitGroup* start = &groups[i];
+		float startX, startY, startInward, startLength, bestDistance = 0.f;
+		size_t best = (size_t) -1;
+
+		if (start->numStartHits == 0 || start->numStopHits != 0) continue;
+		startX = start->sumX / start->numStartHits;
+		startY = start->sumY / start->numStartHits;
+		startInward = (float) sqrt(start->inwardX * start->inwardX + start->inwardY * start->inwardY);
+		startLength = groupLength(start);
+
+		for (j = 0; j < numGroups; ++j) {
+			const HitGroup* stop = &groups[j];
+			float dx, dy, distance, stopInward, stopLength;
+
+			if (stop->numStopHits == 0 || stop->numStartHits != 0) continue;
+			dx = stop->sumX / stop->numStopHits - startX;
+			dy = stop->sumY / stop->numStopHits - startY;
+			distance = (float) sqrt(dx * dx + dy * dy);
+			stopInward = (float) sqrt(stop->inwardX * stop->inwardX + stop->inwardY * stop->inwardY);
+			stopLength = groupLength(stop);
+
+			/* within 60 degrees of the inward directions, which leaves room for skew */
+			if (dx * start->inwardX + dy * start->inwardY < 0.5f * distance * startInward) continue;
+			if (-(dx * stop->inwardX + dy * stop->inwardY) < 0.5f * distance * stopInward) continue;
+			if (startLength > 2.f * stopLength || stopLength > 2.f * startLength) continue;
+			if (best == (size_t) -1 || distance < bestDistance) {
+				best = j;
+				bestDistance = distance;
+			}
+		}
+		if (best != (size_t) -1) mergeGroup(start, &groups[best]);
+	}
+}
+
+/* Turns groups into candidates, strongest first */
+static size_t collectCandidates(const HitGroup* groups, size_t numGroups, const Pdf417LocatorOptions* options,
+		int width, int height, Pdf417Candidate* candidates, size_t maxCandidates) {
+	size_t numCandidates = 0;
+	size_t i, j;
+
+	for (i = 0; i < numGroups; ++i) {
+		const HitGroup* group = &groups[i];
+		Pdf417Candidate candidate;
+		float left, top, right, bottom, extendX, extendY;
+
+		if (group->numStartHits + group->numStopHits < (size_t) options->minHits) continue;
+
+		memset(&candidate, 0, sizeof(candidate));
+		candidate.numStartHits = group->numStartHits;
+		candidate.numStopHits = group->numStopHits;
+		if (group->numStartHits > 0 && group->numStopHits > 0) {
+			extendX = (group->right - group->left) * options->margin;
+			extendY = (group->bottom - group->top) * options->margin;
+		} else {
+			/* only one edge of the symbol was found, its extent away from that edge is unknown */
+			extendX = extendY = groupLength(group);
+		}
+		left = group->left - extendX < 0.f ? 0.f : group->left - extendX;
+		top = group->top - extendY < 0.f ? 0.f : group->top - extendY;
+		right = group->right + extendX + 1.f > width ? (float) width : group->right + extendX + 1.f;
+		bottom = group->bottom + extendY + 1.f > height ? (float) height : group->bottom + extendY + 1.f;
+		candidate.region.x = left;
+		candidate.region.y = top;
+		candidate.region.width = right - left;
+		candidate.region.height = bottom - top;
+
+		/* insertion into the list sorted by number of hits */
+		for (j = numCandidates < maxCandidates ? numCandidates : maxCandidates; j > 0; --j) {
+			const Pdf417Candidate* previous = &candidates[j - 1];
+			if (previous->numStartHits + previous->numStopHits >= candidate.numStartHits + candidate.numStopHits) break;
+			if (j < maxCandidates) candidates[j] = *previous;
+		}
+		if (j < maxCandidates) {
+			candidates[j] = candidate;
+			if (numCandidates < maxCandidates) ++numCandidates;
+		}
+	}
+	return numCandidates;
+}
+
+void pdf417LocatorOptionsInit(Pdf417LocatorOptions* options) {
+	options->spacing = 8;
+	options->minHits = 3;
+	options->margin = 0.1f;
+}
+
+RecognizerErrorStatus pdf417Locate(const ScanlineImage* image, const Pdf417LocatorOptions* options,
+		Pdf417Candidate* candidates, size_t maxCandidates, size_t* numCandidates) {
+	Pdf417LocatorOptions defaults;
+	LocatorState state;
+	size_t* groupOf;
+	HitGroup* groups;
+	size_t numGroups;
+	RecognizerErrorStatus status = RECOGNIZER_ERROR_STATUS_SUCCESS;
+
+	if (image == NULL || candidates == NULL || numCandidates == NULL) return RECOGNIZER_ERROR_STATUS_POINTER_IS_NULL;
+	*numCandidates = 0;
+	if (options == NULL) {
+		pdf417LocatorOptionsInit(&defaults);
+		options = &defaults;
+	}
+	if (options->spacing < 1 || image->width <= 0 || image->height <= 0) return RECOGNIZER_ERROR_STATUS_INVALID_TYPE;
+
+	memset(&state, 0, sizeof(state));
+	state.image = image;
+	state.capacity = (size_t) (image->width > image->height ? image->width : image->height);
+	state.samples = (unsigned char*) malloc(state.capacity);
+	state.runs = (unsigned int*) malloc(state.capacity * sizeof(unsigned int));
+	state.hits = (PatternHit*) malloc(MAX_HITS * sizeof(PatternHit));
+	groupOf = (size_t*) malloc(MAX_HITS * sizeof(size_t));
+	groups = (HitGroup*) malloc(MAX_HITS * sizeof(HitGroup));
+
+	if (state.samples == NULL || state.runs == NULL || state.hits == NULL || groupOf == NULL || groups == NULL) {
+		status = RECOGNIZER_ERROR_STATUS_FAIL;
+	} else {
+		scanImage(&state, options->spacing);
+		groupNearbyHits(state.hits, state.numHits, 3.f * options->spacing);
+		numGroups = buildGroups(state.hits, state.numHits, groupOf, groups);
+		pairGroups(groups, numGroups);
+		*numCandidates = collectCandidates(groups, numGroups, options, image->width, image->height, candidates,
+				maxCandidates);
+	}
+
+	free(state.samples);
+	free(state.runs);
+	free(state.hits);
+	free(groupOf);
+	free(groups);
+	return status;
+}
+
+RecognizerErrorStatus recognizePdf417Located(const Recognizer* const* recognizers, size_t numRecognizers,
+		const RecognizerImage* image, const Pdf417LocatorOptions* options, double deadlineMs, TiledResults* results) {
+	Pdf417Candidate candidates[MAX_LOCATED_SYMBOLS];
+	PPRectangle regions[MAX_LOCATED_SYMBOLS];
+	ScanlineImage scanlineImage;
+	size_t numCandidates = 0, i;
+	RecognizerErrorStatus status;
+
+	if (results == NULL) return RECOGNIZER_ERROR_STATUS_POINTER_IS_NULL;
+	memset(results, 0, sizeof(*results));
+
+	status = scanlineImageInit(&scanlineImage, image);
+	if (status == RECOGNIZER_ERROR_STATUS_SUCCESS) {
+		status = pdf417Locate(&scanlineImage, options, candidates, MAX_LOCATED_SYMBOLS, &numCandidates);
+	}
+	if (status != RECOGNIZER_ERROR_STATUS_SUCCESS) return status;
+
+	for (i = 0; i < numCandidates; ++i) regions[i] = candidates[i].region;
+	if (numCandidates == 0) {
+		regions[0].x = 0.f;
+		regions[0].y = 0.f;
+		regions[0].width = (float) scanlineImage.width;
+		regions[0].height = (float) scanlineImage.height;
+		numCandidates = 1;
+	}
+	return recognizeRegions(recognizers, numRecognizers, image, regions, numCandidates, deadlineMs, results);
+}
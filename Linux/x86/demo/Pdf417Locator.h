@@ -0,0 +1,84 @@
+#ifndef PDF417LOCATOR_H_
+#define PDF417LOCATOR_H_
+
+#include <stddef.h>
+
+#include "RecognizerApi.h"
+#include "ScanlineRuns.h"
+#include "TiledRecognition.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Options of PDF417 localisation.
+ */
+typedef struct Pdf417LocatorOptions {
+	/* distance between parallel scanlines in pixels. Must be smaller than the height of the smallest symbol. */
+	int spacing;
+	/* number of pattern matches needed to accept a symbol */
+	int minHits;
+	/* each side of a located symbol is extended by this fraction of its size */
+	float margin;
+} Pdf417LocatorOptions;
+
+/**
+ * Located PDF417 symbol.
+ */
+typedef struct Pdf417Candidate {
+	/* region holding the symbol, in pixels */
+	PPRectangle region;
+	/* number of scanlines which crossed the start pattern */
+	size_t numStartHits;
+	/* number of scanlines which crossed the stop pattern */
+	size_t numStopHits;
+} Pdf417Candidate;
+
+/**
+ * Initializes options for scanlines 8 pixels apart, 3 hits per symbol and 10% margin.
+ *
+ *  @param options options to initialize
+ */
+void pdf417LocatorOptionsInit(Pdf417LocatorOptions* options);
+
+/**
+ * Finds PDF417 symbols by their start and stop patterns. Scanlines are run horizontally, vertically and along both
+ * diagonals, and split into runs; a start (8 1 1 1 1 1 1 3 modules) or stop (7 1 1 3 1 1 1 2 1 modules) pattern is
+ * matched in both reading directions. Relative widths along any line crossing a pattern are the same, so symbols
+ * of any rotation and moderate skew are found. Matches close to each other, or on one scanline between a start and
+ * a stop pattern, are grouped into one symbol.
+ *
+ *  @param image            image to search
+ *  @param options          options, or NULL for defaults
+ *  @param candidates       destination of located symbols, strongest first
+ *  @param maxCandidates    number of candidates which fit into candidates
+ *  @param numCandidates    set to number of located symbols
+ *
+ *  @return status of the operation
+ */
+RecognizerErrorStatus pdf417Locate(const ScanlineImage* image, const Pdf417LocatorOptions* options,
+		Pdf417Candidate* candidates, size_t maxCandidates, size_t* numCandidates);
+
+/**
+ * Recognizes only the regions of located PDF417 symbols, in parallel with recognizeRegions. The rest of the image
+ * is never given to the library. If no symbol is located, the whole image is recognized.
+ *
+ *  @param recognizers      recognizers, one per thread, with PDF417 or USDL recognizer enabled
+ *  @param numRecognizers   number of recognizers
+ *  @param image            image to recognize
+ *  @param options          localisation options, or NULL for defaults
+ *  @param deadlineMs       absolute deadline of recognizeMonotonicMs() clock, or zero for no deadline
+ *  @param results          destination, tiles of which are the located regions. Must be released with
+ *                          tiledResultsTerm, also on failure.
+ *
+ *  @return status of the operation
+ */
+RecognizerErrorStatus recognizePdf417Located(const Recognizer* const* recognizers, size_t numRecognizers,
+		const RecognizerImage* image, const Pdf417LocatorOptions* options, double deadlineMs, TiledResults* results);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,320 @@
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "RecognizeOptions.h"
+#include "DemoUtil.h"
+
+/* raw pixels of an image, either borrowed from RecognizerImage or owned by caller */
+typedef struct RawView {
+	const unsigned char* data;
+	int width;
+	int height;
+	size_t bytesPerRow;
+	RawImageType type;
+} RawView;
+
+/* deadline of recognition running on this thread. onShouldStopRecognition has no user data parameter,
+so per-call state must be reachable through thread local storage. */
+static __thread double tlsDeadlineMs = 0.0;
+/* onShouldStopRecognition given by the caller, chained after the deadline check */
+static __thread int (*tlsChainedShouldStop)() = NULL;
+
+static int deadlineShouldStopRecognition() {
+	if (tlsDeadlineMs > 0.0 && recognizeMonotonicMs() >= tlsDeadlineMs) {
+		return 1;
+	}
+	if (tlsChainedShouldStop != NULL) {
+		return tlsChainedShouldStop();
+	}
+	return 0;
+}
+
+static RecognizerErrorStatus rawViewFromImage(const RecognizerImage* image, RawView* view) {
+	void* data;
+	int bytesPerRow;
+	RecognizerErrorStatus status;
+
+	status = recognizerImageGetRawBytes(image, &data);
+	if (status != RECOGNIZER_ERROR_STATUS_SUCCESS) return status;
+	status = recognizerImageGetWidth(image, &view->width);
+	if (status != RECOGNIZER_ERROR_STATUS_SUCCESS) return status;
+	status = recognizerImageGetHeight(image, &view->height);
+	if (status != RECOGNIZER_ERROR_STATUS_SUCCESS) return status;
+	status = recognizerImageGetBytesPerRow(image, &bytesPerRow);
+	if (status != RECOGNIZER_ERROR_STATUS_SUCCESS) return status;
+	status = recognizerImageGetRawImageType(image, &view->type);
+	if (status != RECOGNIZER_ERROR_STATUS_SUCCESS) return status;
+
+	view->data = (const unsigned char*) data;
+	view->bytesPerRow = (size_t) bytesPerRow;
+	return RECOGNIZER_ERROR_STATUS_SUCCESS;
+}
+
+static float clampRelative(float v) {
+	return v < 0.f ? 0.f : (v > 1.f ? 1.f : v);
+}
+
+/* Narrows view to given relative ROI. Packed formats are only re-pointed, NV21 is copied into *buffer
+because its chroma plane is located relative to the full image height. */
+static RecognizerErrorStatus cropView(RawView* view, const PPRectangle* roi, unsigned char** buffer) {
+	float left = clampRelative(roi->x);
+	float top = clampRelative(roi->y);
+	float right = clampRelative(roi->x + roi->width);
+	float bottom = clampRelative(roi->y + roi->height);
+	int x = (int) (left * view->width);
+	int y = (int) (top * view->height);
+	int w = (int) (right * view->width) - x;
+	int h = (int) (bottom * view->height) - y;
+
+	if (view->type == RAW_IMAGE_TYPE_NV21) {
+		const unsigned char* uvPlane = view->data + view->height * view->bytesPerRow;
+		unsigned char* dst;
+		int row;
+
+		/* chroma is subsampled 2x2, so crop must start and end on even coordinates */
+		x &= ~1;
+		y &= ~1;
+		w &= ~1;
+		h &= ~1;
+		if (w <= 0 || h <= 0) return RECOGNIZER_ERROR_STATUS_INVALID_TYPE;
+
+		dst = (unsigned char*) malloc((size_t) w * h * 3 / 2);
+		if (dst == NULL) return RECOGNIZER_ERROR_STATUS_FAIL;
+		for (row = 0; row < h; ++row) {
+			memcpy(dst + (size_t) row * w, view->data + (y + row) * view->bytesPerRow + x, w);
+		}
+		for (row = 0; row < h / 2; ++row) {
+			memcpy(dst + (size_t) w * h + (size_t) row * w, uvPlane + (y / 2 + row) * view->bytesPerRow + x, w);
+		}
+		*buffer = dst;
+		view->data = dst;
+		view->bytesPerRow = (size_t) w;
+	} else {
+		if (w <= 0 || h <= 0) return RECOGNIZER_ERROR_STATUS_INVALID_TYPE;
+		view->data += y * view->bytesPerRow + (size_t) x * demoBytesPerPixel(view->type);
+	}
+	view->width = w;
+	view->height = h;
+	return RECOGNIZER_ERROR_STATUS_SUCCESS;
+}
+
+/* Downscales view by integer factor so that its longer side fits into maxDimension. Pixels are area averaged
+into *buffer. NV21 is reduced to its luma plane. */
+static RecognizerErrorStatus downscaleView(RawView* view, int maxDimension, unsigned char** buffer) {
+	int longer = view->width > view->height ? view->width : view->height;
+	int factor = (longer + maxDimension - 1) / maxDimension;
+	int channels = demoBytesPerPixel(view->type);
+	int factorX, factorY, outWidth, outHeight, ox, oy, c, dx, dy;
+	unsigned int area;
+	unsigned char* dst;
+
+	if (factor <= 1) return RECOGNIZER_ERROR_STATUS_SUCCESS;
+
+	/* a side shorter than factor (thin ROI, extreme aspect ratio) is averaged over its own length only, so that no
+	row or column past the view is read */
+	factorX = factor < view->width ? factor : view->width;
+	factorY = factor < view->height ? factor : view->height;
+	outWidth = view->width / factorX;
+	outHeight = view->height / factorY;
+	area = (unsigned int) (factorX * factorY);
+
+	dst = (unsigned char*) malloc((size_t) outWidth * outHeight * channels);
+	if (dst == NULL) return RECOGNIZER_ERROR_STATUS_FAIL;
+
+	for (oy = 0; oy < outHeight; ++oy) {
+		unsigned char* outRow = dst + (size_t) oy * outWidth * channels;
+		for (ox = 0; ox < outWidth; ++ox) {
+			for (c = 0; c < channels; ++c) {
+				unsigned int sum = 0;
+				for (dy = 0; dy < factorY; ++dy) {
+					const unsigned char* in = view->data + (oy * factorY + dy) * view->bytesPerRow
+							+ (size_t) ox * factorX * channels + c;
+					for (dx = 0; dx < factorX; ++dx) {
+						sum += in[dx * channels];
+					}
+				}
+				outRow[ox * channels + c] = (unsigned char) ((sum + area / 2) / area);
+			}
+		}
+	}
+
+	/* ROI may already have produced a temporary buffer which is now not needed anymore */
+	free(*buffer);
+	*buffer = dst;
+	view->data = dst;
+	view->width = outWidth;
+	view->height = outHeight;
+	view->bytesPerRow = (size_t) outWidth * channels;
+	if (view->type == RAW_IMAGE_TYPE_NV21) {
+		view->type = RAW_IMAGE_TYPE_GRAY;
+	}
+	return RECOGNIZER_ERROR_STATUS_SUCCESS;
+}
+
+void recognizeOptionsInit(RecognizeOptions* options) {
+	options->roi = NULL;
+	options->maxImageDimension = 0;
+	options->deadlineMs = 0.0;
+	options->imageIsVideoFrame = 0;
+	options->callback = NULL;
+}
+
+double recognizeMonotonicMs() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+}
+
+RecognizerErrorStatus recognizeWithOptions(const Recognizer* recognizer, RecognizerResultList** resultList,
+		const RecognizerImage* image, const RecognizeOptions* options) {
+	RecognizeOptions defaults;
+	/* image actually given to recognizer; either the original or a view of it */
+	const RecognizerImage* input = image;
+	RecognizerImage* derived = NULL;
+	/* pixels owned by this call, if cropping or scaling had to copy them */
+	unsigned char* buffer = NULL;
+	RecognizerCallback callback;
+	const RecognizerCallback* callbackToUse;
+	double savedDeadline;
+	int (*savedChained)();
+	RecognizerErrorStatus status;
+
+	if (resultList == NULL) return RECOGNIZER_ERROR_STATUS_POINTER_IS_NULL;
+	*resultList = NULL;
+	if (recognizer == NULL || image == NULL) return RECOGNIZER_ERROR_STATUS_POINTER_IS_NULL;
+
+	if (options == NULL) {
+		recognizeOptionsInit(&defaults);
+		options = &defaults;
+	}
+
+	if (options->roi != NULL || options->maxImageDimension > 0) {
+		RawView view;
+
+		status = rawViewFromImage(image, &view);
+		if (status == RECOGNIZER_ERROR_STATUS_SUCCESS && options->roi != NULL) {
+			status = cropView(&view, options->roi, &buffer);
+		}
+		if (status == RECOGNIZER_ERROR_STATUS_SUCCESS && options->maxImageDimension > 0) {
+			status = downscaleView(&view, options->maxImageDimension, &buffer);
+		}
+		if (status == RECOGNIZER_ERROR_STATUS_SUCCESS) {
+			status = recognizerImageCreateFromRawImage(&derived, view.data, view.width, view.height, view.bytesPerRow, view.type);
+		}
+		if (status != RECOGNIZER_ERROR_STATUS_SUCCESS) {
+			free(buffer);
+			return status;
+		}
+		input = derived;
+	}
+
+	callbackToUse = options->callback;
+	savedDeadline = tlsDeadlineMs;
+	savedChained = tlsChainedShouldStop;
+	if (options->deadlineMs > 0.0) {
+		if (options->callback != NULL) {
+			callback = *options->callback;
+		} else {
+			memset(&callback, 0, sizeof(callback));
+		}
+		tlsDeadlineMs = options->deadlineMs;
+		tlsChainedShouldStop = callback.onShouldStopRecognition;
+		callback.onShouldStopRecognition = deadlineShouldStopRecognition;
+		callbackToUse = &callback;
+	}
+
+	status = recognizerRecognizeFromImage(recognizer, resultList, input, options->imageIsVideoFrame, callbackToUse);
+
+	tlsDeadlineMs = savedDeadline;
+	tlsChainedShouldStop = savedChained;
+
+	if (derived != NULL) {
+		recognizerImageDelete(&derived);
+	}
+	free(buffer);
+	return status;
+}
+
+int recognizeResultListQuality(const RecognizerResultList* resultList) {
+	size_t numResults = 0;
+	size_t i;
+	int quality = 0;
+
+	recognizerResultListGetNumOfResults(resultList, &numResults);
+	for (i = 0; i < numResults && quality < 3; ++i) {
+		RecognizerResult* result;
+		int empty = 1;
+		int valid = 0;
+		int uncertain = 0;
+
+		if (recognizerResultListGetResultAtIndex(resultList, i, &result) != RECOGNIZER_ERROR_STATUS_SUCCESS) continue;
+		recognizerResultIsResultEmpty(result, &empty);
+		if (empty) continue;
+		recognizerResultIsResultValid(result, &valid);
+		/* results which do not carry uncertainty information are certain */
+		recognizerResultIsResultUncertain(result, &uncertain);
+		if (valid && !uncertain) {
+			quality = 3;
+		} else if (valid && quality < 2) {
+			quality = 2;
+		} else if (quality < 1) {
+			quality = 1;
+		}
+	}
+	return quality;
+}
+
+RecognizerErrorStatus recognizeWithinDeadline(const Recognizer* const* recognizers, size_t numRecognizers,
+		RecognizerResultList** resultList, const RecognizerImage* image, const RecognizeOptions* options,
+		size_t* pass, int* degraded) {
+	RecognizerResultList* best = NULL;
+	int bestQuality = -1;
+	size_t bestPass = 0;
+	RecognizerErrorStatus status = RECOGNIZER_ERROR_STATUS_SUCCESS;
+	int failedPass = 0;
+	size_t i;
+
+	if (resultList == NULL || recognizers == NULL) return RECOGNIZER_ERROR_STATUS_POINTER_IS_NULL;
+	*resultList = NULL;
+
+	for (i = 0; i < numRecognizers && bestQuality < 3; ++i) {
+		RecognizerResultList* current;
+		int quality;
+
+		if (options != NULL && options->deadlineMs > 0.0 && recognizeMonotonicMs() >= options->deadlineMs) break;
+
+		status = recognizeWithOptions(recognizers[i], &current, image, options);
+		if (status != RECOGNIZER_ERROR_STATUS_SUCCESS) {
+			if (best != NULL) {
+				/* later passes are skipped, so the earlier result is no more certain than one cut by the deadline */
+				failedPass = 1;
+				break;
+			}
+			continue;
+		}
+
+		quality = recognizeResultListQuality(current);
+		if (quality > bestQuality) {
+			if (best != NULL) recognizerResultListDelete(&best);
+			best = current;
+			bestQuality = quality;
+			bestPass = i;
+		} else {
+			recognizerResultListDelete(&current);
+		}
+	}
+
+	if (pass != NULL) *pass = bestPass;
+	/* the last pass still running at the deadline may have been stopped by it */
+	if (degraded != NULL) {
+		*degraded = failedPass || (bestQuality < 3 && options != NULL && options->deadlineMs > 0.0
+				&& recognizeMonotonicMs() >= options->deadlineMs);
+	}
+	if (best == NULL) return status;
+
+	*resultList = best;
+	return RECOGNIZER_ERROR_STATUS_SUCCESS;
+}
@@ -0,0 +1,97 @@
+#ifndef RECOGNIZEOPTIONS_H_
+#define RECOGNIZEOPTIONS_H_
+
+#include "RecognizerApi.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Options that apply to a single recognition call.
+ *
+ * Unlike ::recognizerSetROI or ::recognizerUpdateSettings, nothing here is stored in the Recognizer object, so
+ * one warm Recognizer can serve callers that need different ROI, image size or time budget without being
+ * locked or duplicated.
+ */
+typedef struct RecognizeOptions {
+	/* region of interest in relative coordinates (same convention as recognizerSetROI), or NULL for the whole image */
+	const PPRectangle* roi;
+	/* longer image side is downscaled to at most this many pixels before recognition. Zero disables scaling. */
+	int maxImageDimension;
+	/* absolute deadline in milliseconds of recognizeMonotonicMs() clock. Zero disables the deadline. The deadline is
+	kept in thread-local state read by onShouldStopRecognition, which has no user data parameter, so it is honoured only
+	if the library calls onShouldStopRecognition on the thread which called recognizeWithOptions. */
+	double deadlineMs;
+	/* if non-zero, image is treated as video frame of the session kept by the Recognizer */
+	int imageIsVideoFrame;
+	/* callbacks called during recognition, or NULL. onShouldStopRecognition is chained after the deadline check. */
+	const RecognizerCallback* callback;
+} RecognizeOptions;
+
+/**
+ * Initializes options to the behaviour of plain recognizerRecognizeFromImage: whole image, no scaling,
+ * no deadline, no callbacks.
+ *
+ *  @param options options to initialize
+ */
+void recognizeOptionsInit(RecognizeOptions* options);
+
+/**
+ * Returns current time of a monotonic clock in milliseconds. Use it to build RecognizeOptions::deadlineMs.
+ */
+double recognizeMonotonicMs();
+
+/**
+ * Performs recognition of image with per-call options. ROI is applied by wrapping the selected part of the image
+ * pixels without copying them (NV21 images are cropped into a temporary buffer because of their chroma plane).
+ * Deadline is enforced through onShouldStopRecognition, which the library polls on the calling thread.
+ *
+ *  @param recognizer  recognizer used for recognition
+ *  @param resultList  destination of the result list, see recognizerRecognizeFromImage
+ *  @param image       image on which recognition will be performed
+ *  @param options     per-call options, or NULL for defaults
+ *
+ *  @return status of the operation. RECOGNIZER_ERROR_STATUS_INVALID_TYPE is returned if ROI is empty after clamping.
+ */
+RecognizerErrorStatus recognizeWithOptions(const Recognizer* recognizer, RecognizerResultList** resultList,
+		const RecognizerImage* image, const RecognizeOptions* options);
+
+/**
+ * Grades result list by its best result.
+ *
+ *  @param resultList result list
+ *
+ *  @return 3 if list contains valid and certain result, 2 for valid but uncertain, 1 for non-empty, 0 otherwise
+ */
+int recognizeResultListQuality(const RecognizerResultList* resultList);
+
+/**
+ * Performs recognition within the deadline given in options, spending the time budget on recognizers in the
+ * given order. Cheap passes (e.g. Recognizer with only MRTD enabled) should come first and thorough passes
+ * (e.g. ZXingSettings.slowThoroughScan or BarDecoderSettings.tryHarder enabled) later. Recognition finishes on the
+ * first pass which yields a valid and certain result. Otherwise the best result list obtained before the deadline
+ * is returned, preferring valid over uncertain and uncertain over merely non-empty results.
+ *
+ *  @param recognizers      recognizers used for the passes, in priority order
+ *  @param numRecognizers   number of recognizers
+ *  @param resultList       destination of the best result list. Set to NULL if no pass succeeded.
+ *  @param image            image on which recognition will be performed
+ *  @param options          per-call options shared by all passes
+ *  @param pass             if non-NULL, set to index of the pass which produced returned result list
+ *  @param degraded         if non-NULL, set to non-zero if deadline has been reached before a valid and certain result
+ *                          was found, i.e. a pass was skipped or possibly stopped by the deadline, or if a pass failed
+ *                          after an earlier one produced a result list, so that the remaining passes were skipped.
+ *                          Returned result should then be treated as uncertain. Zero if all passes ran to completion.
+ *
+ *  @return status of the operation. Error of a pass is returned only if no earlier pass produced a result list.
+ */
+RecognizerErrorStatus recognizeWithinDeadline(const Recognizer* const* recognizers, size_t numRecognizers,
+		RecognizerResultList** resultList, const RecognizerImage* image, const RecognizeOptions* options,
+		size_t* pass, int* degraded);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
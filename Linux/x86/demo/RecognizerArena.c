@@ -0,0 +1,114 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "RecognizerArena.h"
+
+#define ARENA_ALIGNMENT 16
+
+static size_t alignUp(size_t size) {
+	return (size + ARENA_ALIGNMENT - 1) & ~(size_t) (ARENA_ALIGNMENT - 1);
+}
+
+/* Marks size bytes at the current position as allocated. Caller checks that they fit, padding to alignment
+is clamped to the budget. */
+static void* commit(RecognizerArena* arena, size_t size) {
+	void* memory = arena->base + arena->used;
+	size_t padded = alignUp(size);
+	arena->used = padded > arena->capacity - arena->used ? arena->capacity : arena->used + padded;
+	if (arena->used > arena->highWater) arena->highWater = arena->used;
+	return memory;
+}
+
+RecognizerErrorStatus recognizerArenaInit(RecognizerArena* arena, size_t capacity) {
+	if (arena == NULL) return RECOGNIZER_ERROR_STATUS_POINTER_IS_NULL;
+
+	memset(arena, 0, sizeof(*arena));
+	/* malloc is aligned at least as strictly as any allocation the arena hands out */
+	arena->base = (unsigned char*) malloc(capacity > 0 ? capacity : 1);
+	if (arena->base == NULL) return RECOGNIZER_ERROR_STATUS_FAIL;
+	arena->capacity = capacity;
+	return RECOGNIZER_ERROR_STATUS_SUCCESS;
+}
+
+void* recognizerArenaAlloc(RecognizerArena* arena, size_t size) {
+	if (arena == NULL) return NULL;
+	if (size > arena->capacity - arena->used) {
+		++arena->numFailed;
+		return NULL;
+	}
+	return commit(arena, size);
+}
+
+void recognizerArenaReset(RecognizerArena* arena) {
+	if (arena == NULL) return;
+	arena->used = 0;
+	++arena->numResets;
+}
+
+RecognizerErrorStatus recognizerArenaAdoptResultList(RecognizerArena* arena, RecognizerResultList** resultList,
+		SerializedResultList* view) {
+	RecognizerErrorStatus status;
+	size_t available;
+	size_t written = 0;
+	void* memory;
+
+	if (arena == NULL || resultList == NULL || *resultList == NULL || view == NULL) {
+		return RECOGNIZER_ERROR_STATUS_POINTER_IS_NULL;
+	}
+
+	/* serialize straight into free space, so that the list is walked only once when it fits */
+	available = arena->capacity - arena->used;
+	status = resultListSerialize(*resultList, arena->base + arena->used, available, &written);
+	if (status == RECOGNIZER_ERROR_STATUS_FAIL && written > available) {
+		++arena->numFailed;
+		return status;
+	}
+	if (status != RECOGNIZER_ERROR_STATUS_SUCCESS) return status;
+
+	memory = commit(arena, written);
+	status = serializedResultListOpen(view, memory, written);
+	if (status != RECOGNIZER_ERROR_STATUS_SUCCESS) return status;
+
+	return recognizerResultListDelete(resultList);
+}
+
+RecognizerErrorStatus recognizerArenaCopyImage(RecognizerArena* arena, const RecognizerImage* image,
+		RecognizerArenaImage* copy) {
+	RecognizerErrorStatus status;
+	void* data;
+	void* memory;
+	size_t size;
+
+	if (arena == NULL || image == NULL || copy == NULL) return RECOGNIZER_ERROR_STATUS_POINTER_IS_NULL;
+
+	status = recognizerImageGetRawBytes(image, &data);
+	if (status != RECOGNIZER_ERROR_STATUS_SUCCESS) return status;
+	status = recognizerImageGetWidth(image, &copy->width);
+	if (status != RECOGNIZER_ERROR_STATUS_SUCCESS) return status;
+	status = recognizerImageGetHeight(image, &copy->height);
+	if (status != RECOGNIZER_ERROR_STATUS_SUCCESS) return status;
+	status = recognizerImageGetBytesPerRow(image, &copy->bytesPerRow);
+	if (status != RECOGNIZER_ERROR_STATUS_SUCCESS) return status;
+	status = recognizerImageGetRawImageType(image, &copy->type);
+	if (status != RECOGNIZER_ERROR_STATUS_SUCCESS) return status;
+
+	size = (size_t) copy->bytesPerRow * copy->height;
+	/* NV21 has interleaved chroma plane of half height after the luma plane */
+	if (copy->type == RAW_IMAGE_TYPE_NV21) size += size / 2;
+
+	memory = recognizerArenaAlloc(arena, size);
+	if (memory == NULL) return RECOGNIZER_ERROR_STATUS_FAIL;
+	memcpy(memory, data, size);
+	copy->data = memory;
+	return RECOGNIZER_ERROR_STATUS_SUCCESS;
+}
+
+RecognizerErrorStatus recognizerArenaTerm(RecognizerArena* arena) {
+	if (arena == NULL) return RECOGNIZER_ERROR_STATUS_POINTER_IS_NULL;
+
+	free(arena->base);
+	arena->base = NULL;
+	arena->capacity = 0;
+	arena->used = 0;
+	return RECOGNIZER_ERROR_STATUS_SUCCESS;
+}
@@ -0,0 +1,81 @@
+#ifndef RECOGNIZERCLIENT_H_
+#define RECOGNIZERCLIENT_H_
+
+#include <stddef.h>
+
+#include "RecognizerApi.h"
+#include "ResultSerializer.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Connection to recognizerd. The daemon keeps OCR model and recognizers loaded, so a client pays only for
+ * inter-process communication instead of loading the model and creating a recognizer. Client is not thread safe,
+ * use one per thread.
+ */
+typedef struct RecognizerClient RecognizerClient;
+
+/**
+ * Connects to recognizerd.
+ *
+ *  @param client       pointer to pointer referencing the created client, set to NULL on error
+ *  @param socketPath   path of daemon socket, or NULL for RECOGNIZERD_DEFAULT_SOCKET
+ *
+ *  @return status of the operation. RECOGNIZER_ERROR_STATUS_FAIL if daemon is not reachable.
+ */
+RecognizerErrorStatus recognizerClientCreate(RecognizerClient** client, const char* socketPath);
+
+/**
+ * Returns shared memory buffer of at least size bytes. Pixels written there reach the daemon without any copy.
+ * Buffer is reused between requests and stays valid until the next call of this function or recognizerClientDelete.
+ *
+ *  @param client   client
+ *  @param size     required size in bytes
+ *  @param pixels   destination of buffer pointer
+ *
+ *  @return status of the operation
+ */
+RecognizerErrorStatus recognizerClientGetImageBuffer(RecognizerClient* client, size_t size, void** pixels);
+
+/**
+ * Recognizes image whose pixels were written to the buffer returned by recognizerClientGetImageBuffer.
+ *
+ *  @param client               client
+ *  @param width                width of the image in pixels
+ *  @param height               height of the image in pixels
+ *  @param bytesPerRow          number of bytes in every row of the image
+ *  @param rawType              type of the image
+ *  @param imageIsVideoFrame    non-zero if image is a video frame
+ *  @param results              destination view of results. Data is owned by client and valid until the next request.
+ *
+ *  @return status of the operation. Status of the recognition in the daemon is returned as it is.
+ *          RECOGNIZER_ERROR_STATUS_FAIL if the exchange with the daemon broke off; the connection is then closed and
+ *          all further requests fail, so a new client must be created.
+ */
+RecognizerErrorStatus recognizerClientRecognize(RecognizerClient* client, int width, int height, size_t bytesPerRow,
+		RawImageType rawType, int imageIsVideoFrame, SerializedResultList* results);
+
+/**
+ * Copies pixels into the shared memory buffer and recognizes them.
+ *
+ *  @see recognizerClientRecognize
+ */
+RecognizerErrorStatus recognizerClientRecognizeRawImage(RecognizerClient* client, const void* pixels, int width, int height,
+		size_t bytesPerRow, RawImageType rawType, int imageIsVideoFrame, SerializedResultList* results);
+
+/**
+ * Closes connection and frees all resources of client.
+ *
+ *  @param client pointer to pointer referencing the client, set to NULL
+ *
+ *  @return status of the operation
+ */
+RecognizerErrorStatus recognizerClientDelete(RecognizerClient** client);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
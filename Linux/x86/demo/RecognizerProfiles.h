@@ -0,0 +1,126 @@
+#ifndef RECOGNIZERPROFILES_H_
+#define RECOGNIZERPROFILES_H_
+
+#include "RecognizerApi.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Snapshot of which recognizers are enabled and how they are configured. Profile is a plain value, so it can
+ * be copied and compared cheaply. Recognizers whose use flag is zero are disabled.
+ */
+typedef struct RecognizerProfile {
+	int usePdf417;
+	Pdf417Settings pdf417;
+	int useUsdl;
+	UsdlSettings usdl;
+	int useBarDecoder;
+	BarDecoderSettings barDecoder;
+	int useZXing;
+	ZXingSettings zxing;
+	int useMRTD;
+	MRTDSettings mrtd;
+	int useMyKad;
+	MyKadSettings myKad;
+	int outputMultipleResults;
+} RecognizerProfile;
+
+/**
+ * Cache of Recognizer objects, one per profile, created from the same base settings (license key, device info
+ * and OCR model). Switching between profiles is then only a lookup, at the cost of memory for each recognizer.
+ */
+typedef struct RecognizerProfileCache {
+	/* base settings shared by all profiles. Owned by caller and must outlive the cache. */
+	RecognizerSettings* settings;
+	/* number of cached profiles */
+	size_t numProfiles;
+	/* copies of cached profiles */
+	RecognizerProfile* profiles;
+	/* recognizer for each profile */
+	Recognizer** recognizers;
+} RecognizerProfileCache;
+
+/**
+ * Initializes profile with all recognizers disabled and their settings set to library defaults.
+ *
+ *  @param profile profile to initialize
+ */
+void recognizerProfileInit(RecognizerProfile* profile);
+
+/**
+ * Enables recognizers named in a comma separated list of mrtd, usdl, pdf417, zxing, bardecoder and mykad, as
+ * accepted by the -t option of the demo tools. Other recognizers are left as they are.
+ *
+ *  @param profile  profile to modify
+ *  @param types    list of recognizer names
+ *
+ *  @return non-zero on success, zero if a name is not known
+ */
+int recognizerProfileParseTypes(RecognizerProfile* profile, const char* types);
+
+/**
+ * Applies recognizer settings from profile to settings object. Settings not covered by profile (license key,
+ * device info, OCR model) are left untouched.
+ *
+ *  @param profile  profile to apply
+ *  @param settings settings object that will be modified
+ *
+ *  @return status of the operation
+ */
+RecognizerErrorStatus recognizerProfileApply(const RecognizerProfile* profile, RecognizerSettings* settings);
+
+/**
+ * Switches recognizer from current to next profile. recognizerUpdateSettings is skipped when profiles are equal,
+ * so repeated switches to the active profile cost only a comparison.
+ *
+ *  @param recognizer   recognizer to update
+ *  @param settings     base settings used to create recognizer
+ *  @param current      profile currently active on recognizer. Set to next on success.
+ *  @param next         profile to switch to
+ *
+ *  @return status of the operation
+ */
+RecognizerErrorStatus recognizerProfileSwitch(Recognizer* recognizer, RecognizerSettings* settings,
+		RecognizerProfile* current, const RecognizerProfile* next);
+
+/**
+ * Creates one recognizer for each given profile. All recognizers are created upfront so that later lookups
+ * never pay recognizer creation.
+ *
+ *  @param cache        cache to initialize
+ *  @param settings     base settings with license key, device info and OCR model
+ *  @param profiles     profiles to cache
+ *  @param numProfiles  number of profiles
+ *
+ *  @return status of the operation. On failure, all recognizers created so far are deleted.
+ */
+RecognizerErrorStatus recognizerProfileCacheInit(RecognizerProfileCache* cache, RecognizerSettings* settings,
+		const RecognizerProfile* profiles, size_t numProfiles);
+
+/**
+ * Returns recognizer configured with profile at given index.
+ *
+ *  @param cache       cache
+ *  @param index       index of profile as given to recognizerProfileCacheInit
+ *  @param recognizer  destination of recognizer. Recognizer is owned by cache.
+ *
+ *  @return status of the operation. RECOGNIZER_ERROR_STATUS_INDEX_OUT_OF_RANGE if there is no such profile.
+ */
+RecognizerErrorStatus recognizerProfileCacheGet(const RecognizerProfileCache* cache, size_t index, const Recognizer** recognizer);
+
+/**
+ * Deletes all cached recognizers and frees taken resources. Base settings are not deleted.
+ *
+ *  @param cache cache
+ *
+ *  @return status of the operation
+ */
+RecognizerErrorStatus recognizerProfileCacheTerm(RecognizerProfileCache* cache);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
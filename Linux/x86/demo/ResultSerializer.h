@@ -0,0 +1,165 @@
+#ifndef RESULTSERIALIZER_H_
+#define RESULTSERIALIZER_H_
+
+#include <stddef.h>
+
+#include "RecognizerApi.h"
+#include "StringView.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Version of the serialized format written by resultListSerialize */
+#define SERIALIZED_RESULT_LIST_VERSION 1
+
+/**
+ * Serialized format. All integers are little endian and every record is aligned to 4 bytes.
+ *
+ *  header:  u32 magic "RRLS", u16 version, u16 reserved, u32 number of results, u32 total size,
+ *           u32 offset of each result from the start of the buffer
+ *  result:  u32 record size, u8 kind (SerializedResultKind), u8 flags (SerializedResultFlag), u16 number of fields,
+ *           i32 type (BarcodeType for barcode results, MRTDDocumentType for MRTD results, otherwise 0),
+ *           fields
+ *  field:   u16 field id, u16 reserved, u32 length, bytes, padding to 4 bytes
+ *
+ * Field ids are SerializedBarcodeField, SerializedMRTDField, UsdlFieldId (plus SERIALIZED_USDL_RAW_DATA) or
+ * SerializedMyKadField, depending on the kind of result. Binary payloads are stored as they are.
+ */
+
+/**
+ * Recognizer which produced the serialized result.
+ */
+typedef enum SerializedResultKind {
+	SERIALIZED_RESULT_UNKNOWN,
+	SERIALIZED_RESULT_MRTD,
+	SERIALIZED_RESULT_USDL,
+	SERIALIZED_RESULT_PDF417,
+	SERIALIZED_RESULT_ZXING,
+	SERIALIZED_RESULT_BARDECODER,
+	SERIALIZED_RESULT_MYKAD
+} SerializedResultKind;
+
+/**
+ * Flags of serialized result.
+ */
+typedef enum SerializedResultFlag {
+	SERIALIZED_RESULT_FLAG_EMPTY = 1 << 0,
+	SERIALIZED_RESULT_FLAG_VALID = 1 << 1,
+	SERIALIZED_RESULT_FLAG_UNCERTAIN = 1 << 2
+} SerializedResultFlag;
+
+/** Fields of PDF417, ZXing and BarDecoder results */
+typedef enum SerializedBarcodeField {
+	SERIALIZED_BARCODE_STRING_DATA,
+	SERIALIZED_BARCODE_RAW_DATA,
+	SERIALIZED_BARCODE_EXTENDED_STRING_DATA,
+	SERIALIZED_BARCODE_EXTENDED_RAW_DATA
+} SerializedBarcodeField;
+
+/** Fields of MRTD results */
+typedef enum SerializedMRTDField {
+	SERIALIZED_MRTD_DOCUMENT_CODE,
+	SERIALIZED_MRTD_ISSUER,
+	SERIALIZED_MRTD_DOCUMENT_NUMBER,
+	SERIALIZED_MRTD_PRIMARY_ID,
+	SERIALIZED_MRTD_SECONDARY_ID,
+	SERIALIZED_MRTD_NATIONALITY,
+	SERIALIZED_MRTD_SEX,
+	SERIALIZED_MRTD_DATE_OF_BIRTH,
+	SERIALIZED_MRTD_DATE_OF_EXPIRY,
+	SERIALIZED_MRTD_OPT1,
+	SERIALIZED_MRTD_OPT2,
+	SERIALIZED_MRTD_ALIEN_NUMBER,
+	SERIALIZED_MRTD_APPLICATION_RECEIPT_NUMBER,
+	SERIALIZED_MRTD_IMMIGRANT_CASE_NUMBER,
+	SERIALIZED_MRTD_RAW_DATA
+} SerializedMRTDField;
+
+/** Fields of MyKad results */
+typedef enum SerializedMyKadField {
+	SERIALIZED_MYKAD_FULL_NAME,
+	SERIALIZED_MYKAD_ADDRESS,
+	SERIALIZED_MYKAD_RELIGION,
+	SERIALIZED_MYKAD_SEX,
+	SERIALIZED_MYKAD_BIRTH_DATE,
+	SERIALIZED_MYKAD_NRIC_NUMBER
+} SerializedMyKadField;
+
+/** Field id of raw binary data of USDL results, following all UsdlFieldId values */
+#define SERIALIZED_USDL_RAW_DATA 0xFFFF
+
+/**
+ * Read-only view of a serialized result list. Refers to the serialized buffer, which must outlive it.
+ */
+typedef struct SerializedResultList {
+	const unsigned char* data;
+	size_t size;
+	size_t numResults;
+} SerializedResultList;
+
+/**
+ * Read-only view of one serialized result.
+ */
+typedef struct SerializedResult {
+	const unsigned char* data;
+	size_t size;
+	SerializedResultKind kind;
+	int flags;
+	int type;
+	size_t numFields;
+} SerializedResult;
+
+/**
+ * Serializes all results of result list into buffer.
+ *
+ *  @param resultList   result list to serialize
+ *  @param buffer       destination buffer, may be NULL when only querying the required size
+ *  @param capacity     size of buffer in bytes
+ *  @param written      set to number of bytes written, or to required number of bytes if buffer is too small
+ *
+ *  @return status of the operation. RECOGNIZER_ERROR_STATUS_FAIL if buffer is too small.
+ */
+RecognizerErrorStatus resultListSerialize(const RecognizerResultList* resultList, void* buffer, size_t capacity, size_t* written);
+
+/**
+ * Opens serialized result list for reading in place. Only the header and record bounds are validated, no data is copied:
+ * every record must start after the offset table, at a multiple of 4 bytes, and end within the total size.
+ *
+ *  @param list     destination view
+ *  @param buffer   serialized data
+ *  @param size     size of serialized data in bytes
+ *
+ *  @return status of the operation. RECOGNIZER_ERROR_STATUS_INVALID_TYPE if data is not a serialized result list of
+ *          supported version.
+ */
+RecognizerErrorStatus serializedResultListOpen(SerializedResultList* list, const void* buffer, size_t size);
+
+/**
+ * Returns view of result at given index.
+ *
+ *  @param list     serialized result list
+ *  @param index    index of the result
+ *  @param result   destination view
+ *
+ *  @return status of the operation
+ */
+RecognizerErrorStatus serializedResultListGetResult(const SerializedResultList* list, size_t index, SerializedResult* result);
+
+/**
+ * Returns view of field with given id. Returned data points into the serialized buffer. String fields are
+ * zero-terminated, so data can also be used as C string.
+ *
+ *  @param result   serialized result
+ *  @param fieldId  id of the field
+ *  @param value    destination view
+ *
+ *  @return status of the operation. RECOGNIZER_ERROR_STATUS_UNKNOWN_KEY if result has no such field.
+ */
+RecognizerErrorStatus serializedResultGetField(const SerializedResult* result, unsigned int fieldId, StringView* value);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,247 @@
+#include <stdlib.h>
+#include <string.h>
+
+/* vector kernels are built with per-function target attributes and picked at run time, so the default build,
+which targets neither AVX2 nor, on 32-bit x86, SSE2, still uses them where the CPU has them */
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SCANLINE_RUNS_X86
+#include <immintrin.h>
+#endif
+
+#include "ScanlineRuns.h"
+#include "DemoUtil.h"
+
+static unsigned char lumaAt(const ScanlineImage* image, int x, int y) {
+	const unsigned char* p = image->data + (size_t) y * image->bytesPerRow + (size_t) x * demoBytesPerPixel(image->type);
+	return (unsigned char) demoLuma(p, image->type);
+}
+
+#ifdef SCANLINE_RUNS_X86
+/* Appends runs ended by transitions in 32 samples starting at position, given mask with bit k set if sample k is dark */
+static void appendTransitions(unsigned int dark, size_t position, unsigned int* prevDark, size_t* start,
+		unsigned int* runs, size_t* n, size_t maxRuns) {
+	/* bit k is set where sample k differs in colour from the sample before it */
+	unsigned int transitions = dark ^ ((dark << 1) | *prevDark);
+
+	*prevDark = dark >> 31;
+	while (transitions != 0 && *n < maxRuns) {
+		size_t end = position + (size_t) __builtin_ctz(transitions);
+		runs[(*n)++] = (unsigned int) (end - *start);
+		*start = end;
+		transitions &= transitions - 1;
+	}
+}
+
+/* Classifies samples 32 at a time with AVX2 from *i on. Returns number of runs appended to the first n. */
+__attribute__((target("avx2")))
+static size_t vectorRunsAvx2(const unsigned char* samples, size_t length, unsigned char threshold, unsigned int* runs,
+		size_t maxRuns, size_t n, size_t* i, size_t* start, unsigned int* prevDark) {
+	const __m256i t = _mm256_set1_epi8((char) threshold);
+
+	for (; *i + 32 <= length && n < maxRuns; *i += 32) {
+		__m256i v = _mm256_loadu_si256((const __m256i*) (samples + *i));
+		/* saturating t - v is non-zero exactly when v < t, which avoids signed byte comparison */
+		__m256i light = _mm256_cmpeq_epi8(_mm256_subs_epu8(t, v), _mm256_setzero_si256());
+		appendTransitions(~(unsigned int) _mm256_movemask_epi8(light), *i, prevDark, start, runs, &n, maxRuns);
+	}
+	return n;
+}
+
+/* Same as vectorRunsAvx2 with two SSE2 halves of 16 samples */
+__attribute__((target("sse2")))
+static size_t vectorRunsSse2(const unsigned char* samples, size_t length, unsigned char threshold, unsigned int* runs,
+		size_t maxRuns, size_t n, size_t* i, size_t* start, unsigned int* prevDark) {
+	const __m128i t = _mm_set1_epi8((char) threshold);
+	const __m128i zero = _mm_setzero_si128();
+
+	for (; *i + 32 <= length && n < maxRuns; *i += 32) {
+		__m128i lo = _mm_loadu_si128((const __m128i*) (samples + *i));
+		__m128i hi = _mm_loadu_si128((const __m128i*) (samples + *i + 16));
+		unsigned int lightLo = (unsigned int) _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_subs_epu8(t, lo), zero));
+		unsigned int lightHi = (unsigned int) _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_subs_epu8(t, hi), zero));
+		appendTransitions(~(lightLo | (lightHi << 16)), *i, prevDark, start, runs, &n, maxRuns);
+	}
+	return n;
+}
+#endif
+
+RecognizerErrorStatus scanlineImageInit(ScanlineImage* scanlineImage, const RecognizerImage* image) {
+	void* data;
+	int bytesPerRow;
+	RecognizerErrorStatus status;
+
+	if (scanlineImage == NULL || image == NULL) return RECOGNIZER_ERROR_STATUS_POINTER_IS_NULL;
+
+	status = recognizerImageGetRawBytes(image, &data);
+	if (status == RECOGNIZER_ERROR_STATUS_SUCCESS) status = recognizerImageGetWidth(image, &scanlineImage->width);
+	if (status == RECOGNIZER_ERROR_STATUS_SUCCESS) status = recognizerImageGetHeight(image, &scanlineImage->height);
+	if (status == RECOGNIZER_ERROR_STATUS_SUCCESS) status = recognizerImageGetBytesPerRow(image, &bytesPerRow);
+	if (status == RECOGNIZER_ERROR_STATUS_SUCCESS) status = recognizerImageGetRawImageType(image, &scanlineImage->type);
+	if (status != RECOGNIZER_ERROR_STATUS_SUCCESS) return status;
+
+	scanlineImage->data = (const unsigned char*) data;
+	scanlineImage->bytesPerRow = (size_t) bytesPerRow;
+	return RECOGNIZER_ERROR_STATUS_SUCCESS;
+}
+
+size_t scanlineSample(const ScanlineImage* image, int x0, int y0, int x1, int y1, unsigned char* samples,
+		size_t capacity) {
+	int dx = x1 - x0;
+	int dy = y1 - y0;
+	int steps = (dx < 0 ? -dx : dx) > (dy < 0 ? -dy : dy) ? (dx < 0 ? -dx : dx) : (dy < 0 ? -dy : dy);
+	size_t n = (size_t) steps + 1;
+	/* 16.16 fixed point needs more than 32 bits for coordinates from 32768 on */
+	long long x, y, stepX, stepY;
+	size_t i;
+
+	if (x0 < 0 || y0 < 0 || x1 < 0 || y1 < 0 || x0 >= image->width || x1 >= image->width
+			|| y0 >= image->height || y1 >= image->height) {
+		return 0;
+	}
+	if (n > capacity) n = capacity;
+
+	if (dy == 0 && dx > 0 && demoBytesPerPixel(image->type) == 1) {
+		memcpy(samples, image->data + (size_t) y0 * image->bytesPerRow + x0, n);
+		return n;
+	}
+
+	/* 16.16 fixed point stepping, so every sample costs two additions */
+	x = x0 * 65536LL + 32768LL;
+	y = y0 * 65536LL + 32768LL;
+	stepX = steps > 0 ? dx * 65536LL / steps : 0;
+	stepY = steps > 0 ? dy * 65536LL / steps : 0;
+	for (i = 0; i < n; ++i) {
+		samples[i] = lumaAt(image, (int) (x >> 16), (int) (y >> 16));
+		x += stepX;
+		y += stepY;
+	}
+	return n;
+}
+
+unsigned char scanlineThreshold(const unsigned char* samples, size_t length) {
+	unsigned char low = 255, high = 0;
+	size_t i;
+
+	for (i = 0; i < length; ++i) {
+		if (samples[i] < low) low = samples[i];
+		if (samples[i] > high) high = samples[i];
+	}
+	return (unsigned char) ((low + high + 1) / 2);
+}
+
+size_t scanlineRuns(const unsigned char* samples, size_t length, unsigned char threshold, unsigned int* runs,
+		size_t maxRuns, int* firstDark) {
+	size_t n = 0, start = 0, i = 0;
+	unsigned int prevDark;
+
+	*firstDark = 0;
+	if (length == 0 || maxRuns == 0) return 0;
+	prevDark = samples[0] < threshold;
+	*firstDark = (int) prevDark;
+
+#ifdef SCANLINE_RUNS_X86
+	if (__builtin_cpu_supports("avx2")) {
+		n = vectorRunsAvx2(samples, length, threshold, runs, maxRuns, n, &i, &start, &prevDark);
+	} else if (__builtin_cpu_supports("sse2")) {
+		n = vectorRunsSse2(samples, length, threshold, runs, maxRuns, n, &i, &start, &prevDark);
+	}
+#endif
+	for (; i < length && n < maxRuns; ++i) {
+		unsigned int dark = samples[i] < threshold;
+		if (dark != prevDark) {
+			runs[n++] = (unsigned int) (i - start);
+			start = i;
+			prevDark = dark;
+		}
+	}
+	if (i == length && n < maxRuns) runs[n++] = (unsigned int) (length - start);
+	return n;
+}
+
+const char* scanlineRunsKernel(void) {
+#ifdef SCANLINE_RUNS_X86
+	if (__builtin_cpu_supports("avx2")) return "AVX2";
+	if (__builtin_cpu_supports("sse2")) return "SSE2";
+#endif
+	return "scalar";
+}
+
+size_t scanlineRunsScalar(const unsigned char* samples, size_t length, unsigned char threshold, unsigned int* runs,
+		size_t maxRuns, int* firstDark) {
+	size_t n = 0, start = 0, i;
+	unsigned int prevDark;
+
+	*firstDark = 0;
+	if (length == 0 || maxRuns == 0) return 0;
+	prevDark = samples[0] < threshold;
+	*firstDark = (int) prevDark;
+
+	for (i = 1; i < length && n < maxRuns; ++i) {
+		unsigned int dark = samples[i] < threshold;
+		if (dark != prevDark) {
+			runs[n++] = (unsigned int) (i - start);
+			start = i;
+			prevDark = dark;
+		}
+	}
+	if (i == length && n < maxRuns) runs[n++] = (unsigned int) (length - start);
+	return n;
+}
+
+/* Votes for polarity of one scanline: +1 for light quiet zone, -1 for dark, 0 if no code-like stretch was found */
+static int polarityVote(const unsigned char* samples, size_t length, unsigned int* runs, size_t maxRuns) {
+	/* narrow runs are at most a fiftieth of the scanline and a code has at least 20 of them in a row */
+	size_t maxNarrow = length / 50 > 2 ? length / 50 : 2;
+	size_t minCode = 20;
+	size_t numRuns, bestStart = 0, bestLength = 0, start = 0, i;
+	int firstDark, before, after;
+
+	numRuns = scanlineRuns(samples, length, scanlineThreshold(samples, length), runs, maxRuns, &firstDark);
+	for (i = 0; i <= numRuns; ++i) {
+		if (i < numRuns && runs[i] <= maxNarrow) continue;
+		if (i - start > bestLength) {
+			bestStart = start;
+			bestLength = i - start;
+		}
+		start = i + 1;
+	}
+	if (bestLength < minCode) return 0;
+
+	/* run k is dark when k has the parity of the first dark run; -1 marks a missing neighbour */
+	before = bestStart > 0 ? (int) ((bestStart - 1) % 2 == 0 ? firstDark : !firstDark) : -1;
+	after = bestStart + bestLength < numRuns ? (int) ((bestStart + bestLength) % 2 == 0 ? firstDark : !firstDark) : -1;
+	if (before < 0 && after < 0) return 0;
+	if (before >= 0 && after >= 0 && before != after) return 0;
+	return (before >= 0 ? before : after) ? -1 : 1;
+}
+
+ScanlinePolarity scanlinePolarity(const ScanlineImage* image, int numScanlines) {
+	size_t capacity = (size_t) (image->width > image->height ? image->width : image->height);
+	unsigned char* samples = (unsigned char*) malloc(capacity);
+	unsigned int* runs = (unsigned int*) malloc(capacity * sizeof(unsigned int));
+	int normal = 0, inverse = 0, vote, i;
+
+	if (samples != NULL && runs != NULL) {
+		for (i = 0; i < numScanlines; ++i) {
+			int y = (int) ((2L * i + 1) * image->height / (2L * numScanlines));
+			int x = (int) ((2L * i + 1) * image->width / (2L * numScanlines));
+			size_t n;
+
+			n = scanlineSample(image, 0, y, image->width - 1, y, samples, capacity);
+			vote = polarityVote(samples, n, runs, capacity);
+			normal += vote > 0;
+			inverse += vote < 0;
+
+			n = scanlineSample(image, x, 0, x, image->height - 1, samples, capacity);
+			vote = polarityVote(samples, n, runs, capacity);
+			normal += vote > 0;
+			inverse += vote < 0;
+		}
+	}
+	free(samples);
+	free(runs);
+
+	if (normal > 2 * inverse) return SCANLINE_POLARITY_NORMAL;
+	if (inverse > 2 * normal) return SCANLINE_POLARITY_INVERSE;
+	return SCANLINE_POLARITY_UNKNOWN;
+}
@@ -0,0 +1,115 @@
+#ifndef SCANLINERUNS_H_
+#define SCANLINERUNS_H_
+
+#include <stddef.h>
+
+#include "RecognizerApi.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Polarity of barcodes in an image.
+ */
+typedef enum ScanlinePolarity {
+	SCANLINE_POLARITY_UNKNOWN,
+	/* dark bars on light background */
+	SCANLINE_POLARITY_NORMAL,
+	/* light bars on dark background */
+	SCANLINE_POLARITY_INVERSE
+} ScanlinePolarity;
+
+/**
+ * Luma pixels of an image, borrowed from RecognizerImage. Scanlines are sampled from it without copying the image.
+ */
+typedef struct ScanlineImage {
+	const unsigned char* data;
+	int width;
+	int height;
+	size_t bytesPerRow;
+	RawImageType type;
+} ScanlineImage;
+
+/**
+ * Wraps pixels of image. Image must outlive the wrapper.
+ *
+ *  @param scanlineImage    wrapper to initialize
+ *  @param image            image to wrap
+ *
+ *  @return status of the operation
+ */
+RecognizerErrorStatus scanlineImageInit(ScanlineImage* scanlineImage, const RecognizerImage* image);
+
+/**
+ * Samples gray levels along the line from (x0, y0) to (x1, y1), one sample per pixel step of the longer axis.
+ * Lines of any angle are supported; horizontal lines of GRAY and NV21 images are copied directly.
+ *
+ *  @param image    image to sample
+ *  @param x0       x coordinate of the first sample
+ *  @param y0       y coordinate of the first sample
+ *  @param x1       x coordinate of the last sample
+ *  @param y1       y coordinate of the last sample
+ *  @param samples  destination of gray levels
+ *  @param capacity number of samples which fit into samples
+ *
+ *  @return number of samples written. Zero if an end point lies outside the image.
+ */
+size_t scanlineSample(const ScanlineImage* image, int x0, int y0, int x1, int y1, unsigned char* samples,
+		size_t capacity);
+
+/**
+ * Returns threshold halfway between the darkest and the brightest sample.
+ *
+ *  @param samples  gray levels
+ *  @param length   number of samples
+ */
+unsigned char scanlineThreshold(const unsigned char* samples, size_t length);
+
+/**
+ * Splits scanline into runs of dark (below threshold) and light samples, which is the input of 1D barcode and
+ * PDF417 row decoding. Runs alternate in colour, starting with the colour of the first sample. 32 samples are
+ * classified at a time with AVX2 or SSE2 on x86, whichever the CPU supports, so the cost is proportional to the number
+ * of runs rather than the number of samples. No compiler flags are needed, the kernel is chosen at run time.
+ *
+ *  @param samples      gray levels
+ *  @param length       number of samples
+ *  @param threshold    samples below threshold are dark
+ *  @param runs         destination of run lengths
+ *  @param maxRuns      number of runs which fit into runs
+ *  @param firstDark    set to non-zero if the first run is dark
+ *
+ *  @return number of runs. If it equals maxRuns, the scanline may have been cut short.
+ */
+size_t scanlineRuns(const unsigned char* samples, size_t length, unsigned char threshold, unsigned int* runs,
+		size_t maxRuns, int* firstDark);
+
+/**
+ * Returns name of the kernel scanlineRuns uses on this CPU: "AVX2", "SSE2" or "scalar".
+ */
+const char* scanlineRunsKernel(void);
+
+/**
+ * Scalar implementation of scanlineRuns, producing identical output. Kept as reference for benchmarks.
+ */
+size_t scanlineRunsScalar(const unsigned char* samples, size_t length, unsigned char threshold, unsigned int* runs,
+		size_t maxRuns, int* firstDark);
+
+/**
+ * Estimates polarity of barcodes from the quiet zones around them. On evenly spaced rows and columns, the longest
+ * stretch of narrow runs is taken as a code and the colour of the runs bordering it as its quiet zone, which is
+ * light for normal and dark for inverse codes. Only a few scanlines are read, so this costs a small fraction of a
+ * decoding pass.
+ *
+ *  @param image        image to examine
+ *  @param numScanlines number of rows and of columns to sample
+ *
+ *  @return polarity agreed on by a clear majority of scanlines, SCANLINE_POLARITY_UNKNOWN otherwise
+ */
+ScanlinePolarity scanlinePolarity(const ScanlineImage* image, int numScanlines);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
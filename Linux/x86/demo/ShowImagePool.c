@@ -0,0 +1,357 @@
+#include <stdlib.h>
+#include <string.h>
+#include <zlib.h>
+
+#include "ShowImagePool.h"
+#include "DemoUtil.h"
+
+/* pool collecting images on this thread. onShowImage has no user data parameter, so it is reachable only
+through thread local storage. */
+static __thread ShowImagePool* tlsPool = NULL;
+
+static unsigned int clampByte(int value) {
+	return value < 0 ? 0 : (value > 255 ? 255 : (unsigned int) value);
+}
+
+/* Reads pixel at (x, y) as BGRA. NV21 is converted with integer BT.601 coefficients. */
+static void readPixel(const unsigned char* data, int height, int bytesPerRow, RawImageType type, int x, int y,
+		unsigned int bgra[4]) {
+	const unsigned char* p;
+	int luma, u, v;
+
+	switch (type) {
+	case RAW_IMAGE_TYPE_BGRA:
+		p = data + (size_t) y * bytesPerRow + x * 4;
+		bgra[0] = p[0]; bgra[1] = p[1]; bgra[2] = p[2]; bgra[3] = p[3];
+		return;
+	case RAW_IMAGE_TYPE_BGR:
+		p = data + (size_t) y * bytesPerRow + x * 3;
+		bgra[0] = p[0]; bgra[1] = p[1]; bgra[2] = p[2]; bgra[3] = 255;
+		return;
+	case RAW_IMAGE_TYPE_NV21:
+		luma = data[(size_t) y * bytesPerRow + x];
+		p = data + (size_t) (height + y / 2) * bytesPerRow + (x & ~1);
+		v = p[0] - 128;
+		u = p[1] - 128;
+		bgra[0] = clampByte(luma + ((454 * u) >> 8));
+		bgra[1] = clampByte(luma - ((88 * u + 183 * v) >> 8));
+		bgra[2] = clampByte(luma + ((359 * v) >> 8));
+		bgra[3] = 255;
+		return;
+	default:
+		luma = data[(size_t) y * bytesPerRow + x];
+		bgra[0] = bgra[1] = bgra[2] = (unsigned int) luma;
+		bgra[3] = 255;
+		return;
+	}
+}
+
+static void writePixel(unsigned char* out, RawImageType type, const unsigned int bgra[4]) {
+	switch (type) {
+	case RAW_IMAGE_TYPE_BGRA:
+		out[3] = (unsigned char) bgra[3];
+		/* fall through */
+	case RAW_IMAGE_TYPE_BGR:
+		out[0] = (unsigned char) bgra[0];
+		out[1] = (unsigned char) bgra[1];
+		out[2] = (unsigned char) bgra[2];
+		return;
+	default:
+		out[0] = (unsigned char) ((29 * bgra[0] + 150 * bgra[1] + 77 * bgra[2] + 128) >> 8);
+		return;
+	}
+}
+
+/* Copies image into buffer, downscaling and converting it on the way. Returns zero if image does not fit. */
+static int copyImage(ShowImageBuffer* buffer, const RecognizerImage* image) {
+	const unsigned char* src;
+	unsigned char* dst = (unsigned char*) buffer->data;
+	void* data;
+	int width, height, bytesPerRow, rowSize, rows, y;
+	int factor = 1;
+	RawImageType type, outputType;
+
+	if (recognizerImageGetRawBytes(image, &data) != RECOGNIZER_ERROR_STATUS_SUCCESS
+			|| recognizerImageGetWidth(image, &width) != RECOGNIZER_ERROR_STATUS_SUCCESS
+			|| recognizerImageGetHeight(image, &height) != RECOGNIZER_ERROR_STATUS_SUCCESS
+			|| recognizerImageGetBytesPerRow(image, &bytesPerRow) != RECOGNIZER_ERROR_STATUS_SUCCESS
+			|| recognizerImageGetRawImageType(image, &type) != RECOGNIZER_ERROR_STATUS_SUCCESS) {
+		return 0;
+	}
+	src = (const unsigned char*) data;
+
+	if (buffer->maxDimension > 0) {
+		int longer = width > height ? width : height;
+		factor = (longer + buffer->maxDimension - 1) / buffer->maxDimension;
+		if (factor < 1) factor = 1;
+	}
+	outputType = buffer->convert ? buffer->outputType : type;
+	/* PNG has no NV21 form, so encoded NV21 images are kept as gray */
+	if (buffer->encoding == SHOW_IMAGE_ENCODING_PNG && outputType == RAW_IMAGE_TYPE_NV21) outputType = RAW_IMAGE_TYPE_GRAY;
+
+	if (factor == 1 && outputType == type) {
+		/* plain copy, only row padding is dropped */
+		rowSize = width * demoBytesPerPixel(type);
+		/* NV21 has interleaved chroma plane of half height after the luma plane */
+		rows = type == RAW_IMAGE_TYPE_NV21 ? height + (height + 1) / 2 : height;
+		if ((size_t) rowSize * rows > buffer->capacity) return 0;
+		for (y = 0; y < rows; ++y) {
+			memcpy(dst + (size_t) y * rowSize, src + (size_t) y * bytesPerRow, rowSize);
+		}
+	} else {
+		/* a side shorter than factor is averaged over its own length only, so that no pixel past it is read */
+		int factorX = factor < width ? factor : width;
+		int factorY = factor < height ? factor : height;
+		int outWidth = width / factorX;
+		int outHeight = height / factorY;
+		int channels, area, x, dx, dy, c;
+
+		/* NV21 cannot be produced, scaled NV21 is kept as gray */
+		if (outputType == RAW_IMAGE_TYPE_NV21) outputType = RAW_IMAGE_TYPE_GRAY;
+		channels = demoBytesPerPixel(outputType);
+		rowSize = outWidth * channels;
+		rows = outHeight;
+		if ((size_t) rowSize * rows > buffer->capacity) return 0;
+
+		area = factorX * factorY;
+		for (y = 0; y < outHeight; ++y) {
+			unsigned char* outRow = dst + (size_t) y * rowSize;
+			for (x = 0; x < outWidth; ++x) {
+				unsigned int sum[4] = { 0, 0, 0, 0 };
+				unsigned int pixel[4];
+				for (dy = 0; dy < factorY; ++dy) {
+					for (dx = 0; dx < factorX; ++dx) {
+						readPixel(src, height, bytesPerRow, type, x * factorX + dx, y * factorY + dy, pixel);
+						for (c = 0; c < 4; ++c) sum[c] += pixel[c];
+					}
+				}
+				for (c = 0; c < 4; ++c) sum[c] = (sum[c] + area / 2) / area;
+				writePixel(outRow + x * channels, outputType, sum);
+			}
+		}
+		width = outWidth;
+		height = outHeight;
+	}
+
+	buffer->width = width;
+	buffer->height = height;
+	buffer->bytesPerRow = rowSize;
+	buffer->type = outputType;
+	buffer->size = (size_t) rowSize * rows;
+	return 1;
+}
+
+static void putBigEndian(unsigned char* out, unsigned long value) {
+	out[0] = (unsigned char) (value >> 24);
+	out[1] = (unsigned char) (value >> 16);
+	out[2] = (unsigned char) (value >> 8);
+	out[3] = (unsigned char) value;
+}
+
+/* Writes length and type of a chunk whose data follows at out + 8 */
+static void beginChunk(unsigned char* out, unsigned long length, const char* type) {
+	putBigEndian(out, length);
+	memcpy(out + 4, type, 4);
+}
+
+/* Writes CRC of a chunk started with beginChunk. Returns size of the whole chunk. */
+static size_t endChunk(unsigned char* out, unsigned long length) {
+	putBigEndian(out + 8 + length, crc32(0, out + 4, 4 + (uInt) length));
+	return 12 + (size_t) length;
+}
+
+/* Sets up deflate state of pool, kept from the first encoded image until showImagePoolDetach */
+static z_stream* poolDeflater(ShowImagePool* pool) {
+	z_stream* stream = (z_stream*) pool->deflater;
+
+	if (stream != NULL) {
+		return deflateReset(stream) == Z_OK ? stream : NULL;
+	}
+	stream = (z_stream*) calloc(1, sizeof(z_stream));
+	if (stream == NULL) return NULL;
+	/* fastest level, since images are encoded on the recognition thread */
+	if (deflateInit(stream, Z_BEST_SPEED) != Z_OK) {
+		free(stream);
+		return NULL;
+	}
+	pool->deflater = stream;
+	return stream;
+}
+
+/* Turns the tightly packed image in buffer into a PNG file in place. Rows are first moved to the end of the buffer,
+then deflated from there into the IDAT chunk at its start. Deflate copies input into its own window, so the output
+may take every byte before the first row not yet read; the file is dropped if it catches up with them.
+Returns zero if the file does not fit. */
+static int encodePng(ShowImagePool* pool, ShowImageBuffer* buffer) {
+	/* filter type of every row, subtraction of the pixel to the left */
+	static const unsigned char filterSub = 1;
+	unsigned char* data = (unsigned char*) buffer->data;
+	size_t rowSize = (size_t) buffer->bytesPerRow;
+	size_t size = rowSize * (size_t) buffer->height;
+	/* signature, IHDR and IDAT chunk header precede the zlib stream, IDAT CRC and IEND follow it */
+	size_t head = 8 + 25 + 8, tail = 4 + 12;
+	size_t channels = (size_t) demoBytesPerPixel(buffer->type), i, zlibSize;
+	unsigned char *rows, *end, *p;
+	z_stream* stream;
+	int row, status;
+
+	if (buffer->capacity < head + tail || size > buffer->capacity - head - tail) return 0;
+	stream = poolDeflater(pool);
+	if (stream == NULL) return 0;
+
+	end = data + buffer->capacity - tail;
+	rows = end - size;
+	memmove(rows, data, size);
+	stream->next_out = data + head;
+
+	for (row = 0; row < buffer->height; ++row) {
+		unsigned char* line = rows + (size_t) row * rowSize;
+		/* PNG stores red first */
+		if (buffer->type != RAW_IMAGE_TYPE_GRAY) {
+			for (i = 0; i < rowSize; i += channels) {
+				unsigned char blue = line[i];
+				line[i] = line[i + 2];
+				line[i + 2] = blue;
+			}
+		}
+		for (i = rowSize; i-- > channels;) line[i] = (unsigned char) (line[i] - line[i - channels]);
+
+		stream->next_in = (Bytef*) &filterSub;
+		stream->avail_in = 1;
+		while (stream->avail_in > 0 || stream->next_in != line + rowSize) {
+			if (stream->avail_in == 0) {
+				stream->next_in = line;
+				stream->avail_in = (uInt) rowSize;
+			}
+			/* output may reach the first byte of this row not read yet */
+			stream->avail_out = (uInt) ((stream->next_in == &filterSub ? line : stream->next_in) - stream->next_out);
+			if (stream->avail_out == 0 || deflate(stream, Z_NO_FLUSH) != Z_OK) return 0;
+		}
+	}
+	do {
+		stream->avail_out = (uInt) (end - stream->next_out);
+		if (stream->avail_out == 0) return 0;
+		status = deflate(stream, Z_FINISH);
+	} while (status == Z_OK);
+	if (status != Z_STREAM_END) return 0;
+	zlibSize = (size_t) (stream->next_out - (data + head));
+
+	memcpy(data, "\x89PNG\r\n\x1a\n", 8);
+	p = data + 8;
+	beginChunk(p, 13, "IHDR");
+	putBigEndian(p + 8, (unsigned long) buffer->width);
+	putBigEndian(p + 12, (unsigned long) buffer->height);
+	p[16] = 8;
+	p[17] = (unsigned char) (buffer->type == RAW_IMAGE_TYPE_GRAY ? 0 : (buffer->type == RAW_IMAGE_TYPE_BGR ? 2 : 6));
+	p[18] = p[19] = p[20] = 0;
+	p += endChunk(p, 13);
+
+	beginChunk(p, (unsigned long) zlibSize, "IDAT");
+	p += endChunk(p, (unsigned long) zlibSize);
+
+	beginChunk(p, 0, "IEND");
+	p += endChunk(p, 0);
+
+	buffer->size = (size_t) (p - data);
+	return 1;
+}
+
+static void poolOnShowImage(const RecognizerImage* image, const ShowImageType showType, const char* name) {
+	ShowImagePool* pool = tlsPool;
+
+	if (pool == NULL) return;
+
+	if (showType >= 0 && showType < SHOW_IMAGE_POOL_NUM_TYPES && pool->buffers[showType].data != NULL) {
+		ShowImageBuffer* buffer = &pool->buffers[showType];
+		buffer->valid = copyImage(buffer, image);
+		if (buffer->valid && buffer->encoding == SHOW_IMAGE_ENCODING_PNG) buffer->valid = encodePng(pool, buffer);
+		if (!buffer->valid) ++pool->numDropped;
+	}
+
+	if (pool->chainedOnShowImage != NULL) {
+		pool->chainedOnShowImage(image, showType, name);
+	}
+}
+
+void showImagePoolInit(ShowImagePool* pool) {
+	memset(pool, 0, sizeof(*pool));
+}
+
+RecognizerErrorStatus showImagePoolSetBuffer(ShowImagePool* pool, ShowImageType type, void* data, size_t capacity) {
+	ShowImageBuffer* buffer;
+
+	if (pool == NULL) return RECOGNIZER_ERROR_STATUS_POINTER_IS_NULL;
+	if (type < 0 || type >= SHOW_IMAGE_POOL_NUM_TYPES) return RECOGNIZER_ERROR_STATUS_INDEX_OUT_OF_RANGE;
+
+	buffer = &pool->buffers[type];
+	buffer->data = data;
+	buffer->capacity = data != NULL ? capacity : 0;
+	buffer->valid = 0;
+	return RECOGNIZER_ERROR_STATUS_SUCCESS;
+}
+
+RecognizerErrorStatus showImagePoolSetOutput(ShowImagePool* pool, ShowImageType type, int maxDimension, int convert,
+		RawImageType outputType) {
+	ShowImageBuffer* buffer;
+
+	if (pool == NULL) return RECOGNIZER_ERROR_STATUS_POINTER_IS_NULL;
+	if (type < 0 || type >= SHOW_IMAGE_POOL_NUM_TYPES) return RECOGNIZER_ERROR_STATUS_INDEX_OUT_OF_RANGE;
+	if (convert && outputType != RAW_IMAGE_TYPE_BGRA && outputType != RAW_IMAGE_TYPE_BGR
+			&& outputType != RAW_IMAGE_TYPE_GRAY) {
+		return RECOGNIZER_ERROR_STATUS_INVALID_TYPE;
+	}
+
+	buffer = &pool->buffers[type];
+	buffer->maxDimension = maxDimension > 0 ? maxDimension : 0;
+	buffer->convert = convert;
+	buffer->outputType = outputType;
+	buffer->valid = 0;
+	return RECOGNIZER_ERROR_STATUS_SUCCESS;
+}
+
+RecognizerErrorStatus showImagePoolSetEncoding(ShowImagePool* pool, ShowImageType type, ShowImageEncoding encoding) {
+	if (pool == NULL) return RECOGNIZER_ERROR_STATUS_POINTER_IS_NULL;
+	if (type < 0 || type >= SHOW_IMAGE_POOL_NUM_TYPES) return RECOGNIZER_ERROR_STATUS_INDEX_OUT_OF_RANGE;
+	if (encoding != SHOW_IMAGE_ENCODING_RAW && encoding != SHOW_IMAGE_ENCODING_PNG) return RECOGNIZER_ERROR_STATUS_INVALID_TYPE;
+
+	pool->buffers[type].encoding = encoding;
+	pool->buffers[type].valid = 0;
+	return RECOGNIZER_ERROR_STATUS_SUCCESS;
+}
+
+void showImagePoolClear(ShowImagePool* pool) {
+	int i;
+
+	if (pool == NULL) return;
+	for (i = 0; i < SHOW_IMAGE_POOL_NUM_TYPES; ++i) {
+		pool->buffers[i].valid = 0;
+	}
+}
+
+RecognizerErrorStatus showImagePoolAttach(ShowImagePool* pool, RecognizerCallback* callback) {
+	if (pool == NULL || callback == NULL) return RECOGNIZER_ERROR_STATUS_POINTER_IS_NULL;
+
+	/* attaching twice must not chain the pool to itself */
+	if (callback->onShowImage != poolOnShowImage) {
+		pool->chainedOnShowImage = callback->onShowImage;
+		callback->onShowImage = poolOnShowImage;
+	}
+	tlsPool = pool;
+	return RECOGNIZER_ERROR_STATUS_SUCCESS;
+}
+
+RecognizerErrorStatus showImagePoolDetach(ShowImagePool* pool, RecognizerCallback* callback) {
+	if (pool == NULL || callback == NULL) return RECOGNIZER_ERROR_STATUS_POINTER_IS_NULL;
+
+	if (callback->onShowImage == poolOnShowImage) {
+		callback->onShowImage = pool->chainedOnShowImage;
+	}
+	pool->chainedOnShowImage = NULL;
+	if (tlsPool == pool) tlsPool = NULL;
+	if (pool->deflater != NULL) {
+		deflateEnd((z_stream*) pool->deflater);
+		free(pool->deflater);
+		pool->deflater = NULL;
+	}
+	return RECOGNIZER_ERROR_STATUS_SUCCESS;
+}
@@ -0,0 +1,157 @@
+#ifndef STRUCTUREDAPPEND_H_
+#define STRUCTUREDAPPEND_H_
+
+#include <stddef.h>
+
+#include "RecognizerApi.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* symbols in one QR structured append sequence at most */
+#define STRUCTURED_APPEND_MAX_SEGMENTS 16
+
+/* sequences gathered at the same time at most */
+#define STRUCTURED_APPEND_MAX_SETS 8
+
+/**
+ * Structured append header of one QR symbol.
+ */
+typedef struct StructuredAppendHeader {
+	/* position of the symbol in its sequence, from 0 */
+	unsigned int index;
+	/* number of symbols in the sequence, 1 to 16 */
+	unsigned int count;
+	/* XOR of all data bytes of the whole message, the same in every symbol of the sequence */
+	unsigned int parity;
+} StructuredAppendHeader;
+
+/**
+ * Segments of one sequence received so far.
+ */
+typedef struct StructuredAppendSet {
+	unsigned int count;
+	unsigned int parity;
+	/* payload of each received segment, NULL for missing ones */
+	unsigned char* segments[STRUCTURED_APPEND_MAX_SEGMENTS];
+	size_t sizes[STRUCTURED_APPEND_MAX_SEGMENTS];
+	unsigned int numReceived;
+	/* frame in which a segment was last received */
+	unsigned long lastFrame;
+} StructuredAppendSet;
+
+/**
+ * Assembler of QR structured append sequences, fed with results of one image or of consecutive video frames. Macro
+ * PDF417, Data Matrix and Aztec sequences are not supported, since their results do not expose the control data.
+ */
+typedef struct StructuredAppend {
+	StructuredAppendSet sets[STRUCTURED_APPEND_MAX_SETS];
+	size_t numSets;
+	/* current frame, advanced by structuredAppendNextFrame */
+	unsigned long frame;
+	/* a set not extended for this many frames is dropped when a frame ends. Zero drops incomplete sets at the end of
+	every frame. */
+	unsigned long maxAgeFrames;
+	/* segments added, including duplicates */
+	unsigned long numSegments;
+	/* segments already received in the same frame or an earlier one */
+	unsigned long numDuplicates;
+	/* messages completed with matching parity */
+	unsigned long numCompleted;
+	/* sets dropped because the parity of the completed message did not match */
+	unsigned long numParityErrors;
+	/* sets dropped because they were not completed in time, or to make room for a newer one */
+	unsigned long numExpired;
+	/* QR results whose raw data is their decoded text instead of the codeword bitstream, see structuredAppendParseQR */
+	unsigned long numDecodedRaw;
+} StructuredAppend;
+
+/**
+ * Parses raw data of a QR symbol, as returned by recognizerResultGetBarcodeRawData for QR results: the data codewords
+ * with their mode indicators, as ZXing reports raw bytes. The API promises only "raw binary barcode data"; should the
+ * engine return decoded bytes instead, no structured append header can be read and every symbol is reported as not
+ * structured append. structuredAppendAddResult tells that case apart by comparing raw data with the string data of
+ * the result and counts it in StructuredAppend::numDecodedRaw. If the symbol starts with a structured append header, its
+ * header is returned and the rest of the bitstream is decoded into payload bytes. Numeric and alphanumeric data are
+ * written as ASCII, byte data as is and Kanji as Shift JIS, which are the bytes the parity is computed over. ECI
+ * designators are skipped and FNC1 escapes of alphanumeric data are resolved.
+ *
+ * The version of the symbol, which sets the width of character counts, is not part of raw data, so every version
+ * class possible for the number of codewords, i.e. of raw data bytes, is tried, and the first one decoding to a terminator followed only by
+ * padding is taken.
+ *
+ *  @param raw          raw data of a QR result
+ *  @param size         size of raw data in bytes
+ *  @param header       destination of the structured append header
+ *  @param payload      destination of payload bytes. Payload is never longer than 3 * size bytes.
+ *  @param capacity     size of payload in bytes
+ *  @param payloadSize  set to number of payload bytes
+ *
+ *  @return status of the operation. RECOGNIZER_ERROR_STATUS_INVALID_TYPE if raw data is not a structured append
+ *          symbol, RECOGNIZER_ERROR_STATUS_INDEX_OUT_OF_RANGE if payload does not fit into capacity.
+ */
+RecognizerErrorStatus structuredAppendParseQR(const void* raw, size_t size, StructuredAppendHeader* header,
+		unsigned char* payload, size_t capacity, size_t* payloadSize);
+
+/**
+ * Initializes empty assembler.
+ *
+ *  @param assembler    assembler to initialize
+ *  @param maxAgeFrames frames after which a sequence not extended is dropped; zero for sequences all of which are
+ *                      in one image
+ */
+void structuredAppendInit(StructuredAppend* assembler, unsigned long maxAgeFrames);
+
+/**
+ * Adds raw data of a QR symbol to its sequence. Sequences are told apart by their count and parity; a segment which
+ * conflicts with a different one already received at its position starts the sequence anew. When the last segment
+ * arrives, payloads are joined in order, parity is verified and the sequence is removed.
+ *
+ *  @param assembler    assembler
+ *  @param raw          raw data of a QR result
+ *  @param size         size of raw data in bytes
+ *  @param message      set to the joined message when this segment completes its sequence, otherwise to NULL.
+ *                      Must be released with free.
+ *  @param messageSize  set to size of message in bytes
+ *
+ *  @return status of the operation. RECOGNIZER_ERROR_STATUS_INVALID_TYPE if raw data is not a structured append
+ *          symbol, RECOGNIZER_ERROR_STATUS_FAIL if the completed message fails its parity or memory runs out.
+ */
+RecognizerErrorStatus structuredAppendAdd(StructuredAppend* assembler, const void* raw, size_t size,
+		unsigned char** message, size_t* messageSize);
+
+/**
+ * Adds QR result to its sequence like structuredAppendAdd. Results of other types are ignored.
+ *
+ *  @param assembler    assembler
+ *  @param result       recognition result
+ *  @param message      set to the joined message when this result completes its sequence, otherwise to NULL.
+ *                      Must be released with free.
+ *  @param messageSize  set to size of message in bytes
+ *
+ *  @return status of the operation. RECOGNIZER_ERROR_STATUS_INVALID_TYPE if result is not a structured append QR
+ *          symbol, or if its raw data is the decoded text, which is counted in numDecodedRaw.
+ */
+RecognizerErrorStatus structuredAppendAddResult(StructuredAppend* assembler, RecognizerResult* result,
+		unsigned char** message, size_t* messageSize);
+
+/**
+ * Ends current frame. Sequences last extended maxAgeFrames or more frames before the ending one are dropped.
+ *
+ *  @param assembler    assembler
+ */
+void structuredAppendNextFrame(StructuredAppend* assembler);
+
+/**
+ * Drops all incomplete sequences and frees taken resources.
+ *
+ *  @param assembler    assembler
+ */
+void structuredAppendTerm(StructuredAppend* assembler);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,134 @@
+#ifndef TILEDRECOGNITION_H_
+#define TILEDRECOGNITION_H_
+
+#include <stddef.h>
+
+#include "RecognizerApi.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Options of tiled recognition.
+ */
+typedef struct TileOptions {
+	/* side of a square tile in pixels. Larger tiles repeat less work in overlaps. */
+	int tileSize;
+	/* number of pixels shared by neighbouring tiles, less than tileSize. Must be at least objectSize, otherwise an
+	object crossing a tile border may not be found in any tile. */
+	int overlap;
+	/* size of the largest object (MRZ, document, barcode) to be recognized in pixels at the resolution of the image,
+	or zero if unknown */
+	int objectSize;
+	/* absolute deadline in milliseconds of recognizeMonotonicMs() clock. Tiles not started before the deadline are
+	skipped. Zero disables the deadline. */
+	double deadlineMs;
+} TileOptions;
+
+/**
+ * Merged results of all tiles. Results point into result lists of the tiles, which are owned by this structure.
+ */
+typedef struct TiledResults {
+	/* result list of each tile, NULL for tiles which failed or were skipped */
+	RecognizerResultList** lists;
+	/* time spent recognizing each tile in milliseconds, zero for skipped tiles. With one region per symbol, as given
+	by pdf417Locate, this is the decoding time of each symbol. */
+	double* tileMs;
+	size_t numTiles;
+	/* non-empty results of all tiles with duplicates from overlapping tiles removed */
+	RecognizerResult** results;
+	/* tile from which each result comes, in pixels of the whole image */
+	PPRectangle* regions;
+	/* index of the tile from which each result comes */
+	size_t* tileIndices;
+	size_t numResults;
+	/* number of tiles skipped because of the deadline */
+	size_t numSkipped;
+} TiledResults;
+
+/**
+ * Initializes options for 600 dpi scans: objects up to 3000 pixels (TD3 MRZ is about 2950 pixels wide), 6144 pixel
+ * tiles overlapping by 3072 pixels and no deadline. For other resolutions, scale all three sizes.
+ *
+ *  @param options options to initialize
+ */
+void tileOptionsInit(TileOptions* options);
+
+/**
+ * Recognizes image tile by tile. Tiles wrap pixels of the image without copying (except for NV21 images), so memory
+ * used by recognition is bounded by tile size instead of image size. Tiles are recognized in parallel, one thread per
+ * given recognizer. Results found in several overlapping tiles are reported once; when copies differ in quality,
+ * valid and certain one is kept.
+ *
+ *  @param recognizers      recognizers, one per thread. All should be created with the same settings.
+ *  @param numRecognizers   number of recognizers
+ *  @param image            image to recognize
+ *  @param options          tiling options, or NULL for defaults
+ *  @param results          destination. Must be released with tiledResultsTerm, also on failure.
+ *
+ *  @return status of the operation. RECOGNIZER_ERROR_STATUS_INDEX_OUT_OF_RANGE if overlap is negative, not less than
+ *          tileSize or less than objectSize. If all tiles failed, error of the first tile is returned.
+ */
+RecognizerErrorStatus recognizeTiled(const Recognizer* const* recognizers, size_t numRecognizers,
+		const RecognizerImage* image, const TileOptions* options, TiledResults* results);
+
+/**
+ * Recognizes given regions of image in parallel, like recognizeTiled does with tiles. Regions may be of any size
+ * and may overlap; duplicates are removed the same way. Larger regions are started first, so that the slowest ones
+ * do not delay completion by running last on a single thread.
+ *
+ *  @param recognizers      recognizers, one per thread. All should be created with the same settings.
+ *  @param numRecognizers   number of recognizers
+ *  @param image            image to recognize
+ *  @param regions          regions in pixels of image
+ *  @param numRegions       number of regions
+ *  @param deadlineMs       absolute deadline of recognizeMonotonicMs() clock, or zero for no deadline
+ *  @param results          destination, tiles of which are the given regions. Must be released with
+ *                          tiledResultsTerm, also on failure.
+ *
+ *  @return status of the operation. RECOGNIZER_ERROR_STATUS_INDEX_OUT_OF_RANGE if a region is empty or not within
+ *          the image. If all regions failed, error of the first region is returned.
+ */
+RecognizerErrorStatus recognizeRegions(const Recognizer* const* recognizers, size_t numRecognizers,
+		const RecognizerImage* image, const PPRectangle* regions, size_t numRegions, double deadlineMs,
+		TiledResults* results);
+
+/**
+ * Recognizes given regions of image in parallel like recognizeRegions, choosing the recognizer of each region by its
+ * class. This lets regions already classified, e.g. by symbology, be decoded with recognizers which only look for
+ * that class, all in one parallel pass.
+ *
+ *  @param recognizers      numClasses recognizers per thread: recognizer of class c on thread t is at index
+ *                          t * numClasses + c
+ *  @param numRecognizers   number of threads
+ *  @param numClasses       number of region classes
+ *  @param image            image to recognize
+ *  @param regions          regions in pixels of image
+ *  @param classes          class of each region, less than numClasses
+ *  @param numRegions       number of regions
+ *  @param deadlineMs       absolute deadline of recognizeMonotonicMs() clock, or zero for no deadline
+ *  @param results          destination, tiles of which are the given regions. Must be released with
+ *                          tiledResultsTerm, also on failure.
+ *
+ *  @return status of the operation. RECOGNIZER_ERROR_STATUS_INDEX_OUT_OF_RANGE if a class is out of range or a
+ *          region is empty or not within the image.
+ */
+RecognizerErrorStatus recognizeClassifiedRegions(const Recognizer* const* recognizers, size_t numRecognizers,
+		size_t numClasses, const RecognizerImage* image, const PPRectangle* regions, const size_t* classes,
+		size_t numRegions, double deadlineMs, TiledResults* results);
+
+/**
+ * Deletes result lists of all tiles and frees taken resources.
+ *
+ *  @param results results
+ *
+ *  @return status of the operation
+ */
+RecognizerErrorStatus tiledResultsTerm(TiledResults* results);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
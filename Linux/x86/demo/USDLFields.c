@@ -0,0 +1,321 @@
+#include <stddef.h>
+#include <string.h>
+
+#include "USDLFields.h"
+
+#define USDL_FIELD_KEY_OFFSET(id, key) offsetof(struct USDLFieldKeysType, key),
+
+/* offset of each field key inside USDLFieldKeys, indexed by UsdlFieldId */
+static const size_t keyOffsets[USDL_FIELD_COUNT] = {
+	USDL_FIELD_LIST(USDL_FIELD_KEY_OFFSET)
+};
+
+#undef USDL_FIELD_KEY_OFFSET
+
+/* Data element of AAMVA payload and the field it fills */
+typedef struct AamvaElement {
+	char id[4];
+	UsdlFieldId field;
+} AamvaElement;
+
+/* Elements of version 01, whose IDs differ from or are reused by later versions. Looked up first for version 01. */
+static const AamvaElement version1Elements[] = {
+	{ "DAA", USDL_FIELD_CUSTOMER_FULL_NAME },
+	{ "DAB", USDL_FIELD_CUSTOMER_FAMILY_NAME },
+	{ "DAE", USDL_FIELD_NAME_SUFFIX },
+	{ "DAF", USDL_FIELD_NAME_PREFIX },
+	{ "DAL", USDL_FIELD_RESIDENCE_STREET_ADDRESS },
+	{ "DAM", USDL_FIELD_RESIDENCE_STREET_ADDRESS2 },
+	{ "DAN", USDL_FIELD_RESIDENCE_CITY },
+	{ "DAO", USDL_FIELD_RESIDENCE_JURISDICTION_CODE },
+	{ "DAP", USDL_FIELD_RESIDENCE_POSTAL_CODE },
+	{ "DAR", USDL_FIELD_JURISDICTION_VEHICLE_CLASS },
+	{ "DAS", USDL_FIELD_JURISDICTION_RESTRICTION_CODES },
+	{ "DAT", USDL_FIELD_JURISDICTION_ENDORSEMENT_CODES },
+	{ "DAV", USDL_FIELD_HEIGHT_CM },
+	{ "DBE", USDL_FIELD_ISSUE_TIMESTAMP },
+	{ "DBF", USDL_FIELD_NUMBER_OF_DUPLICATES },
+	{ "DBG", USDL_FIELD_MEDICAL_INDICATOR },
+	{ "DBH", USDL_FIELD_ORGAN_DONOR },
+	{ "DBI", USDL_FIELD_NON_RESIDENT },
+	{ "DBJ", USDL_FIELD_UNIQUE_CUSTOMER_ID },
+	{ "DBK", USDL_FIELD_SOCIAL_SECURITY_NUMBER },
+	{ "DBL", USDL_FIELD_AKA_DATE_OF_BIRTH },
+	{ "DBM", USDL_FIELD_AKA_SOCIAL_SECURITY_NUMBER },
+	{ "DBN", USDL_FIELD_AKA_FULL_NAME },
+	{ "DBO", USDL_FIELD_AKA_FAMILY_NAME },
+	{ "DBP", USDL_FIELD_AKA_GIVEN_NAME },
+	{ "DBQ", USDL_FIELD_AKA_MIDDLE_NAME },
+	{ "DBR", USDL_FIELD_AKA_SUFFIX_NAME },
+	{ "DBS", USDL_FIELD_AKA_PREFIX_NAME }
+};
+
+/* Elements of all versions */
+static const AamvaElement elements[] = {
+	{ "DAC", USDL_FIELD_CUSTOMER_FIRST_NAME },
+	{ "DAD", USDL_FIELD_CUSTOMER_MIDDLE_NAME },
+	{ "DAG", USDL_FIELD_ADDRESS_STREET },
+	{ "DAH", USDL_FIELD_ADDRESS_STREET2 },
+	{ "DAI", USDL_FIELD_ADDRESS_CITY },
+	{ "DAJ", USDL_FIELD_ADDRESS_JURISDICTION_CODE },
+	{ "DAK", USDL_FIELD_ADDRESS_POSTAL_CODE },
+	{ "DAQ", USDL_FIELD_CUSTOMER_ID_NUMBER },
+	{ "DAU", USDL_FIELD_HEIGHT },
+	{ "DAW", USDL_FIELD_WEIGHT_POUNDS },
+	{ "DAX", USDL_FIELD_WEIGHT_KILOGRAMS },
+	{ "DAY", USDL_FIELD_EYE_COLOR },
+	{ "DAZ", USDL_FIELD_HAIR_COLOR },
+	{ "DBA", USDL_FIELD_DOCUMENT_EXPIRATION_DATE },
+	{ "DBB", USDL_FIELD_DATE_OF_BIRTH },
+	{ "DBC", USDL_FIELD_SEX },
+	{ "DBD", USDL_FIELD_DOCUMENT_ISSUE_DATE },
+	{ "DBG", USDL_FIELD_AKA_GIVEN_NAME },
+	{ "DBN", USDL_FIELD_AKA_FAMILY_NAME },
+	{ "DBS", USDL_FIELD_AKA_SUFFIX_NAME },
+	{ "DCA", USDL_FIELD_JURISDICTION_VEHICLE_CLASS },
+	{ "DCB", USDL_FIELD_JURISDICTION_RESTRICTION_CODES },
+	{ "DCD", USDL_FIELD_JURISDICTION_ENDORSEMENT_CODES },
+	{ "DCE", USDL_FIELD_WEIGHT_RANGE },
+	{ "DCF", USDL_FIELD_DOCUMENT_DISCRIMINATOR },
+	{ "DCG", USDL_FIELD_COUNTRY_IDENTIFICATION },
+	{ "DCH", USDL_FIELD_FEDERAL_COMMERCIAL_VEHICLE_CODES },
+	{ "DCI", USDL_FIELD_PLACE_OF_BIRTH },
+	{ "DCJ", USDL_FIELD_AUDIT_INFORMATION },
+	{ "DCK", USDL_FIELD_INVENTORY_CONTROL_NUMBER },
+	{ "DCL", USDL_FIELD_RACE_ETHNICITY },
+	{ "DCM", USDL_FIELD_STANDARD_VEHICLE_CLASSIFICATION },
+	{ "DCN", USDL_FIELD_STANDARD_ENDORSEMENT_CODE },
+	{ "DCO", USDL_FIELD_STANDARD_RESTRICTION_CODE },
+	{ "DCP", USDL_FIELD_JURISDICTION_VEHICLE_CLASSIFICATION_DESCRIPTION },
+	{ "DCQ", USDL_FIELD_JURISDICTION_ENDORSMENT_CODE_DESCRIPTION },
+	{ "DCR", USDL_FIELD_JURISDICTION_RESTRICTION_CODE_DESCRIPTION },
+	{ "DCS", USDL_FIELD_CUSTOMER_FAMILY_NAME },
+	/* given names of versions 02 and 03 */
+	{ "DCT", USDL_FIELD_CUSTOMER_FIRST_NAME },
+	{ "DCU", USDL_FIELD_NAME_SUFFIX },
+	{ "DDA", USDL_FIELD_COMPLIANCE_TYPE },
+	{ "DDB", USDL_FIELD_CARD_REVISION_DATE },
+	{ "DDC", USDL_FIELD_HAZMAT_EXPIRATION_DATE },
+	{ "DDD", USDL_FIELD_LIMITED_DURATION_DOCUMENT },
+	{ "DDE", USDL_FIELD_FAMILY_NAME_TRUNCATION },
+	{ "DDF", USDL_FIELD_FIRST_NAME_TRUNCATION },
+	{ "DDG", USDL_FIELD_MIDDLE_NAME_TRUNCATION },
+	{ "DDH", USDL_FIELD_UNDER18 },
+	{ "DDI", USDL_FIELD_UNDER19 },
+	{ "DDJ", USDL_FIELD_UNDER21 },
+	{ "DDK", USDL_FIELD_ORGAN_DONOR },
+	{ "DDL", USDL_FIELD_VETERAN },
+	{ "PAB", USDL_FIELD_PERMIT_EXPIRATION_DATE },
+	{ "PAC", USDL_FIELD_PERMIT_IDENTIFIER },
+	{ "PAD", USDL_FIELD_PERMIT_ISSUE_DATE }
+};
+
+static RecognizerErrorStatus checkUsdlResult(const RecognizerResult* result) {
+	int isUsdl = 0;
+	RecognizerErrorStatus status = recognizerResultIsUSDLResult(result, &isUsdl);
+	if (status != RECOGNIZER_ERROR_STATUS_SUCCESS) return status;
+	return isUsdl ? RECOGNIZER_ERROR_STATUS_SUCCESS : RECOGNIZER_ERROR_STATUS_INVALID_TYPE;
+}
+
+static StringView getField(const RecognizerResult* result, UsdlFieldId id) {
+	StringView view;
+	const char* value = NULL;
+
+	if (recognizerResultGetUSDLField(result, &value, usdlFieldKey(id)) == RECOGNIZER_ERROR_STATUS_SUCCESS && value != NULL) {
+		view.data = value;
+		view.length = strlen(value);
+	} else {
+		view.data = "";
+		view.length = 0;
+	}
+	return view;
+}
+
+static StringView makeView(const char* data, size_t length) {
+	StringView view;
+	view.data = data;
+	view.length = length;
+	return view;
+}
+
+static int isDigits(const char* data, size_t length) {
+	size_t i;
+	for (i = 0; i < length; ++i) {
+		if (data[i] < '0' || data[i] > '9') return 0;
+	}
+	return 1;
+}
+
+static int isElementId(const char* data) {
+	int i;
+	for (i = 0; i < 3; ++i) {
+		if (data[i] < 'A' || data[i] > 'Z') return 0;
+	}
+	return 1;
+}
+
+/* Value of decimal digits, or -1 */
+static int parseNumber(const char* data, size_t length) {
+	int value = 0;
+	size_t i;
+
+	if (!isDigits(data, length)) return -1;
+	for (i = 0; i < length; ++i) value = value * 10 + (data[i] - '0');
+	return value;
+}
+
+static int lookupElement(const AamvaElement* table, size_t count, const char* id, UsdlFieldId* field) {
+	size_t i;
+	for (i = 0; i < count; ++i) {
+		if (memcmp(table[i].id, id, 3) == 0) {
+			*field = table[i].field;
+			return 1;
+		}
+	}
+	return 0;
+}
+
+/* Finds the subfile of given type. Its designated offset is trusted only if the type is found there, since several
+jurisdictions encode offsets wrongly; otherwise the type followed by an element ID is searched for. Designators are
+skipped by the search, as digits follow their type. */
+static const char* findSubfile(const char* data, size_t size, size_t from, const char* type, size_t offset) {
+	size_t i;
+
+	if (offset + 5 <= size && memcmp(data + offset, type, 2) == 0 && isElementId(data + offset + 2)) return data + offset;
+	for (i = from; i + 5 <= size; ++i) {
+		if (memcmp(data + i, type, 2) == 0 && isElementId(data + i + 2)) return data + i;
+	}
+	return NULL;
+}
+
+/* Fills fields from elements of subfile, which ends at the segment terminator or at end of data */
+static void parseSubfile(USDLFieldTable* table, const char* subfile, const char* end, int version) {
+	const char* p = subfile + 2;
+
+	while (p + 3 <= end && *p != '\r') {
+		const char* value = p + 3;
+		const char* valueEnd = value;
+		UsdlFieldId field;
+
+		while (valueEnd < end && *valueEnd != '\n' && *valueEnd != '\r') ++valueEnd;
+		if (isElementId(p) && ((version <= 1
+				&& lookupElement(version1Elements, sizeof(version1Elements) / sizeof(version1Elements[0]), p, &field))
+				|| lookupElement(elements, sizeof(elements) / sizeof(elements[0]), p, &field))) {
+			size_t length = (size_t) (valueEnd - value);
+			/* fixed-width elements of older versions are padded with spaces */
+			while (length > 0 && value[length - 1] == ' ') --length;
+			table->fields[field] = makeView(value, length);
+		}
+		p = valueEnd < end && *valueEnd == '\n' ? valueEnd + 1 : valueEnd;
+	}
+}
+
+/* Splits height such as "069 in" or "175 cm" into number without leading zeros and unit */
+static void splitHeight(USDLFieldTable* table) {
+	StringView height = table->fields[USDL_FIELD_HEIGHT];
+	size_t digits = 0, start = 0;
+
+	while (digits < height.length && height.data[digits] >= '0' && height.data[digits] <= '9') ++digits;
+	if (digits == 0 || height.length < digits + 2) return;
+	while (start + 1 < digits && height.data[start] == '0') ++start;
+	if (memcmp(height.data + height.length - 2, "in", 2) == 0) {
+		table->fields[USDL_FIELD_HEIGHT_IN] = makeView(height.data + start, digits - start);
+	} else if (memcmp(height.data + height.length - 2, "cm", 2) == 0) {
+		table->fields[USDL_FIELD_HEIGHT_CM] = makeView(height.data + start, digits - start);
+	}
+}
+
+const char* usdlFieldKey(UsdlFieldId id) {
+	if ((int) id < 0 || id >= USDL_FIELD_COUNT) return NULL;
+	return *(const char* const*) ((const char*) &USDLFieldKeys + keyOffsets[id]);
+}
+
+RecognizerErrorStatus usdlFieldsGet(const RecognizerResult* result, const UsdlFieldId* ids, size_t numIds, StringView* out) {
+	RecognizerErrorStatus status;
+	size_t i;
+
+	if (result == NULL || (numIds > 0 && (ids == NULL || out == NULL))) return RECOGNIZER_ERROR_STATUS_POINTER_IS_NULL;
+
+	status = checkUsdlResult(result);
+	if (status != RECOGNIZER_ERROR_STATUS_SUCCESS) return status;
+
+	for (i = 0; i < numIds; ++i) {
+		if ((int) ids[i] < 0 || ids[i] >= USDL_FIELD_COUNT) return RECOGNIZER_ERROR_STATUS_INDEX_OUT_OF_RANGE;
+	}
+	for (i = 0; i < numIds; ++i) {
+		out[i] = getField(result, ids[i]);
+	}
+	return RECOGNIZER_ERROR_STATUS_SUCCESS;
+}
+
+RecognizerErrorStatus usdlFieldTableFill(USDLFieldTable* table, const RecognizerResult* result) {
+	RecognizerErrorStatus status;
+	int i;
+
+	if (table == NULL || result == NULL) return RECOGNIZER_ERROR_STATUS_POINTER_IS_NULL;
+
+	status = checkUsdlResult(result);
+	if (status != RECOGNIZER_ERROR_STATUS_SUCCESS) return status;
+
+	for (i = 0; i < USDL_FIELD_COUNT; ++i) {
+		table->fields[i] = getField(result, (UsdlFieldId) i);
+	}
+	return RECOGNIZER_ERROR_STATUS_SUCCESS;
+}
+
+RecognizerErrorStatus usdlFieldTableParse(USDLFieldTable* table, const void* data, size_t size) {
+	const char* bytes = (const char*) data;
+	const char* fileType = NULL;
+	size_t header, entries, i;
+	int version, numEntries;
+
+	if (table == NULL || data == NULL) return RECOGNIZER_ERROR_STATUS_POINTER_IS_NULL;
+	for (i = 0; i < USDL_FIELD_COUNT; ++i) table->fields[i] = makeView("", 0);
+
+	/* compliance indicator "@" and separators precede the file type, but separators are often mangled */
+	if (size == 0 || bytes[0] != '@') return RECOGNIZER_ERROR_STATUS_INVALID_TYPE;
+	for (i = 1; i < 8 && i + 5 <= size && fileType == NULL; ++i) {
+		if (memcmp(bytes + i, "ANSI ", 5) == 0 || memcmp(bytes + i, "AAMVA", 5) == 0) fileType = bytes + i;
+	}
+	if (fileType == NULL) return RECOGNIZER_ERROR_STATUS_INVALID_TYPE;
+	header = (size_t) (fileType - bytes) + 5;
+
+	/* IIN, version, jurisdiction version (since version 02) and number of entries */
+	if (header + 10 > size || !isDigits(bytes + header, 6)) return RECOGNIZER_ERROR_STATUS_INVALID_TYPE;
+	version = parseNumber(bytes + header + 6, 2);
+	if (version < 0) return RECOGNIZER_ERROR_STATUS_INVALID_TYPE;
+	table->fields[USDL_FIELD_DOCUMENT_TYPE] = makeView("AAMVA", 5);
+	table->fields[USDL_FIELD_ISSUER_IDENTIFICATION_NUMBER] = makeView(bytes + header, 6);
+	table->fields[USDL_FIELD_STANDARD_VERSION_NUMBER] = makeView(bytes + header + 6, 2);
+	if (version <= 1) {
+		entries = header + 8;
+	} else {
+		if (header + 12 > size) return RECOGNIZER_ERROR_STATUS_INVALID_TYPE;
+		table->fields[USDL_FIELD_JURISDICTION_VERSION_NUMBER] = makeView(bytes + header + 8, 2);
+		entries = header + 10;
+	}
+	numEntries = parseNumber(bytes + entries, 2);
+	if (numEntries < 0) return RECOGNIZER_ERROR_STATUS_INVALID_TYPE;
+	entries += 2;
+
+	/* designators of 2 character type, 4 digit offset and 4 digit length */
+	for (i = 0; i < (size_t) numEntries && entries + 10 * (i + 1) <= size; ++i) {
+		const char* designator = bytes + entries + 10 * i;
+		const char* subfile;
+		const char* end = bytes + size;
+		size_t offset = 0, length = 0, k;
+
+		if (memcmp(designator, "DL", 2) != 0 && memcmp(designator, "ID", 2) != 0) continue;
+		if (isDigits(designator + 2, 8)) {
+			for (k = 2; k < 6; ++k) offset = offset * 10 + (size_t) (designator[k] - '0');
+			for (k = 6; k < 10; ++k) length = length * 10 + (size_t) (designator[k] - '0');
+		}
+		subfile = findSubfile(bytes, size, entries, designator, offset);
+		if (subfile == NULL) continue;
+		if (subfile == bytes + offset && length > 0 && offset + length <= size) end = subfile + length;
+		parseSubfile(table, subfile, end, version);
+		splitHeight(table);
+		return RECOGNIZER_ERROR_STATUS_SUCCESS;
+	}
+	return RECOGNIZER_ERROR_STATUS_INVALID_TYPE;
+}
@@ -0,0 +1,173 @@
+#ifndef USDLFIELDS_H_
+#define USDLFIELDS_H_
+
+#include "RecognizerApi.h"
+#include "StringView.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* List of all US Driver's License fields, in order of members of USDLFieldKeysType */
+#define USDL_FIELD_LIST(X) \
+	X(DOCUMENT_TYPE, kDocumentType) \
+	X(STANDARD_VERSION_NUMBER, kStandardVersionNumber) \
+	X(CUSTOMER_FAMILY_NAME, kCustomerFamilyName) \
+	X(CUSTOMER_FIRST_NAME, kCustomerFirstName) \
+	X(CUSTOMER_FULL_NAME, kCustomerFullName) \
+	X(DATE_OF_BIRTH, kDateOfBirth) \
+	X(SEX, kSex) \
+	X(EYE_COLOR, kEyeColor) \
+	X(ADDRESS_STREET, kAddressStreet) \
+	X(ADDRESS_CITY, kAddressCity) \
+	X(ADDRESS_JURISDICTION_CODE, kAddressJurisdictionCode) \
+	X(ADDRESS_POSTAL_CODE, kAddressPostalCode) \
+	X(FULL_ADDRESS, kFullAddress) \
+	X(HEIGHT, kHeight) \
+	X(HEIGHT_IN, kHeightIn) \
+	X(HEIGHT_CM, kHeightCm) \
+	X(CUSTOMER_MIDDLE_NAME, kCustomerMiddleName) \
+	X(HAIR_COLOR, kHairColor) \
+	X(NAME_SUFFIX, kNameSuffix) \
+	X(AKA_FULL_NAME, kAKAFullName) \
+	X(AKA_FAMILY_NAME, kAKAFamilyName) \
+	X(AKA_GIVEN_NAME, kAKAGivenName) \
+	X(AKA_SUFFIX_NAME, kAKASuffixName) \
+	X(WEIGHT_RANGE, kWeightRange) \
+	X(WEIGHT_POUNDS, kWeightPounds) \
+	X(WEIGHT_KILOGRAMS, kWeightKilograms) \
+	X(CUSTOMER_ID_NUMBER, kCustomerIdNumber) \
+	X(FAMILY_NAME_TRUNCATION, kFamilyNameTruncation) \
+	X(FIRST_NAME_TRUNCATION, kFirstNameTruncation) \
+	X(MIDDLE_NAME_TRUNCATION, kMiddleNameTruncation) \
+	X(PLACE_OF_BIRTH, kPlaceOfBirth) \
+	X(ADDRESS_STREET2, kAddressStreet2) \
+	X(RACE_ETHNICITY, kRaceEthnicity) \
+	X(NAME_PREFIX, kNamePrefix) \
+	X(COUNTRY_IDENTIFICATION, kCountryIdentification) \
+	X(RESIDENCE_STREET_ADDRESS, kResidenceStreetAddress) \
+	X(RESIDENCE_STREET_ADDRESS2, kResidenceStreetAddress2) \
+	X(RESIDENCE_CITY, kResidenceCity) \
+	X(RESIDENCE_JURISDICTION_CODE, kResidenceJurisdictionCode) \
+	X(RESIDENCE_POSTAL_CODE, kResidencePostalCode) \
+	X(RESIDENCE_FULL_ADDRESS, kResidenceFullAddress) \
+	X(UNDER18, kUnder18) \
+	X(UNDER19, kUnder19) \
+	X(UNDER21, kUnder21) \
+	X(SOCIAL_SECURITY_NUMBER, kSocialSecurityNumber) \
+	X(AKA_SOCIAL_SECURITY_NUMBER, kAKASocialSecurityNumber) \
+	X(AKA_MIDDLE_NAME, kAKAMiddleName) \
+	X(AKA_PREFIX_NAME, kAKAPrefixName) \
+	X(ORGAN_DONOR, kOrganDonor) \
+	X(VETERAN, kVeteran) \
+	X(AKA_DATE_OF_BIRTH, kAKADateOfBirth) \
+	X(ISSUER_IDENTIFICATION_NUMBER, kIssuerIdentificationNumber) \
+	X(ISSUING_JURISDICTION_NAME, kIssuingJurisdictionName) \
+	X(DOCUMENT_EXPIRATION_DATE, kDocumentExpirationDate) \
+	X(JURISDICTION_VERSION_NUMBER, kJurisdictionVersionNumber) \
+	X(JURISDICTION_VEHICLE_CLASS, kJurisdictionVehicleClass) \
+	X(JURISDICTION_RESTRICTION_CODES, kJurisdictionRestrictionCodes) \
+	X(JURISDICTION_ENDORSEMENT_CODES, kJurisdictionEndorsementCodes) \
+	X(DOCUMENT_ISSUE_DATE, kDocumentIssueDate) \
+	X(FEDERAL_COMMERCIAL_VEHICLE_CODES, kFederalCommercialVehicleCodes) \
+	X(ISSUING_JURISDICTION, kIssuingJurisdiction) \
+	X(STANDARD_VEHICLE_CLASSIFICATION, kStandardVehicleClassification) \
+	X(STANDARD_ENDORSEMENT_CODE, kStandardEndorsementCode) \
+	X(STANDARD_RESTRICTION_CODE, kStandardRestrictionCode) \
+	X(JURISDICTION_VEHICLE_CLASSIFICATION_DESCRIPTION, kJurisdictionVehicleClassificationDescription) \
+	X(JURISDICTION_ENDORSMENT_CODE_DESCRIPTION, kJurisdictionEndorsmentCodeDescription) \
+	X(JURISDICTION_RESTRICTION_CODE_DESCRIPTION, kJurisdictionRestrictionCodeDescription) \
+	X(INVENTORY_CONTROL_NUMBER, kInventoryControlNumber) \
+	X(CARD_REVISION_DATE, kCardRevisionDate) \
+	X(DOCUMENT_DISCRIMINATOR, kDocumentDiscriminator) \
+	X(LIMITED_DURATION_DOCUMENT, kLimitedDurationDocument) \
+	X(AUDIT_INFORMATION, kAuditInformation) \
+	X(COMPLIANCE_TYPE, kComplianceType) \
+	X(ISSUE_TIMESTAMP, kIssueTimestamp) \
+	X(PERMIT_EXPIRATION_DATE, kPermitExpirationDate) \
+	X(PERMIT_IDENTIFIER, kPermitIdentifier) \
+	X(PERMIT_ISSUE_DATE, kPermitIssueDate) \
+	X(NUMBER_OF_DUPLICATES, kNumberOfDuplicates) \
+	X(HAZMAT_EXPIRATION_DATE, kHAZMATExpirationDate) \
+	X(MEDICAL_INDICATOR, kMedicalIndicator) \
+	X(NON_RESIDENT, kNonResident) \
+	X(UNIQUE_CUSTOMER_ID, kUniqueCustomerId) \
+	X(DATA_DISCRIMINATOR, kDataDiscriminator) \
+	X(DOCUMENT_EXPIRATION_MONTH, kDocumentExpirationMonth) \
+	X(DOCUMENT_NONEXPIRING, kDocumentNonexpiring) \
+	X(SECURITY_VERSION, kSecurityVersion)
+
+#define USDL_FIELD_ENUM_VALUE(id, key) USDL_FIELD_##id,
+
+/**
+ * Integer identifiers of US Driver's License fields. Each value corresponds to the member of ::USDLFieldKeys with the same name.
+ */
+typedef enum UsdlFieldId {
+	USDL_FIELD_LIST(USDL_FIELD_ENUM_VALUE)
+	/** number of fields */
+	USDL_FIELD_COUNT
+} UsdlFieldId;
+
+#undef USDL_FIELD_ENUM_VALUE
+
+/**
+ * Flat table with all fields of one USDL result, indexed by UsdlFieldId.
+ */
+typedef struct USDLFieldTable {
+	StringView fields[USDL_FIELD_COUNT];
+} USDLFieldTable;
+
+/**
+ * Returns the key from ::USDLFieldKeys for given field, for use with recognizerResultGetUSDLField.
+ *
+ *  @param id field identifier
+ *
+ *  @return key string, or NULL if id is out of range
+ */
+const char* usdlFieldKey(UsdlFieldId id);
+
+/**
+ * Obtains several fields of USDL result with one call. Views point to strings owned by result, so they are valid until
+ * the result list holding the result is deleted. Fields missing in result are set to empty views.
+ *
+ *  @param result   USDL result
+ *  @param ids      fields to obtain
+ *  @param numIds   number of fields to obtain
+ *  @param out      array of numIds views that will be filled
+ *
+ *  @return status of the operation. RECOGNIZER_ERROR_STATUS_INVALID_TYPE if result is not USDL result and
+ *          RECOGNIZER_ERROR_STATUS_INDEX_OUT_OF_RANGE if any of ids is not valid.
+ */
+RecognizerErrorStatus usdlFieldsGet(const RecognizerResult* result, const UsdlFieldId* ids, size_t numIds, StringView* out);
+
+/**
+ * Obtains all fields of USDL result into table, so that later reads are plain array indexing.
+ *
+ *  @param table    destination table
+ *  @param result   USDL result
+ *
+ *  @return status of the operation. RECOGNIZER_ERROR_STATUS_INVALID_TYPE if result is not USDL result.
+ */
+RecognizerErrorStatus usdlFieldTableFill(USDLFieldTable* table, const RecognizerResult* result);
+
+/**
+ * Parses raw AAMVA payload of a driver's license PDF417 barcode into table, without any image recognition. Payloads
+ * obtained earlier with recognizerResultGetBarcodeRawData or recognizerResultGetUSDLRawBinaryData, or read by
+ * hardware scanners, are thus processed at parser speed. Versions 01 to 10 of the AAMVA standard are supported; the
+ * DL or ID subfile is parsed, jurisdiction-specific subfiles are skipped. Views point into data, which must outlive
+ * the table, or to static strings. Fields the library composes from several elements (full name and full address on
+ * versions without such element) are left empty.
+ *
+ *  @param table    destination table
+ *  @param data     raw payload
+ *  @param size     size of payload in bytes
+ *
+ *  @return status of the operation. RECOGNIZER_ERROR_STATUS_INVALID_TYPE if data is not an AAMVA payload.
+ */
+RecognizerErrorStatus usdlFieldTableParse(USDLFieldTable* table, const void* data, size_t size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,142 @@
+#define _XOPEN_SOURCE 600
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "RecognizerApi.h"
+#include "RecognizeOptions.h"
+#include "MrzLocator.h"
+
+typedef struct Resolution {
+	const char* name;
+	int width;
+	int height;
+} Resolution;
+
+static const Resolution resolutions[] = {
+	{ "720p", 1280, 720 },
+	{ "1080p", 1920, 1080 },
+	{ "5 MP", 2592, 1944 },
+	{ "8 MP", 3264, 2448 },
+	{ "12 MP", 4000, 3000 }
+};
+
+/* Draws a line of numChars characters. Characters are blocks of random dark strokes, which is enough to have the
+edge density of printed OCR-B. */
+static void drawTextLine(unsigned char* pixels, int width, int left, int top, int numChars, int charWidth,
+		int lineHeight) {
+	int strokeWidth = charWidth / 6 > 1 ? charWidth / 6 : 1;
+	int c, s, x, y;
+
+	for (c = 0; c < numChars; ++c) {
+		int strokes = 2 + rand() % 3;
+		for (s = 0; s < strokes; ++s) {
+			int strokeX = left + c * charWidth + rand() % (charWidth * 2 / 3);
+			for (y = top; y < top + lineHeight * 2 / 3; ++y) {
+				for (x = strokeX; x < strokeX + strokeWidth; ++x) pixels[(size_t) y * width + x] = 20;
+			}
+		}
+	}
+}
+
+/* Draws a TD3 sized document with a photo and lines of the visual inspection zone above two MRZ lines of 44
+characters. VIZ lines are shorter but use the same characters, so they compete with the MRZ for the strongest band.
+Returns band of MRZ in relative coordinates. */
+static void drawDocument(unsigned char* pixels, int width, int height, PPRectangle* mrz) {
+	int docWidth = width * 3 / 4;
+	int docHeight = docWidth * 88 / 125;
+	int docX = (width - docWidth) / 2;
+	int docY = (height - docHeight) / 2;
+	int charWidth = docWidth * 9 / 10 / 44;
+	int lineHeight = charWidth * 3 / 2;
+	int mrzX = docX + docWidth / 20;
+	int mrzY = docY + docHeight - 3 * lineHeight;
+	int photoX = mrzX, photoY = docY + docHeight / 8;
+	int photoWidth = docWidth * 3 / 10, photoHeight = docHeight * 11 / 20;
+	int vizX = photoX + photoWidth + docWidth / 20;
+	int line, y;
+
+	memset(pixels, 90, (size_t) width * height);
+	for (y = docY; y < docY + docHeight; ++y) memset(pixels + (size_t) y * width + docX, 220, (size_t) docWidth);
+	for (y = photoY; y < photoY + photoHeight; ++y) memset(pixels + (size_t) y * width + photoX, 130, (size_t) photoWidth);
+
+	srand(1);
+	/* labelled fields, e.g. surname, given names, nationality, date of birth, sex, place of birth */
+	for (line = 0; line < 6; ++line) {
+		drawTextLine(pixels, width, vizX, photoY + line * 2 * lineHeight, 12 + rand() % 17, charWidth, lineHeight);
+	}
+	for (line = 0; line < 2; ++line) drawTextLine(pixels, width, mrzX, mrzY + line * lineHeight, 44, charWidth, lineHeight);
+
+	mrz->x = (float) mrzX / width;
+	mrz->y = (float) mrzY / height;
+	mrz->width = (float) (44 * charWidth) / width;
+	mrz->height = (float) (2 * lineHeight) / height;
+}
+
+static int contains(const PPRectangle* outer, const PPRectangle* inner) {
+	return outer->x <= inner->x && outer->y <= inner->y && outer->x + outer->width >= inner->x + inner->width
+			&& outer->y + outer->height >= inner->y + inner->height;
+}
+
+static void usage(const char* program) {
+	fprintf(stderr, "usage %s [-n iterations] [-w work_width]\n", program);
+	fprintf(stderr, "Measures MRZ localisation time on synthetic documents of increasing resolution.\n");
+}
+
+int main(int argc, char* argv[]) {
+	MrzLocatorOptions options;
+	int iterations = 50;
+	size_t r;
+	int opt;
+
+	mrzLocatorOptionsInit(&options);
+	while ((opt = getopt(argc, argv, "n:w:h")) != -1) {
+		switch (opt) {
+		case 'n':
+			iterations = atoi(optarg);
+			break;
+		case 'w':
+			options.workWidth = atoi(optarg);
+			break;
+		default:
+			usage(argv[0]);
+			return -1;
+		}
+	}
+	if (iterations < 1) iterations = 1;
+
+	printf("%-8s %12s %10s  %s\n", "image", "pixels", "ms/locate", "band");
+	for (r = 0; r < sizeof(resolutions) / sizeof(resolutions[0]); ++r) {
+		const Resolution* res = &resolutions[r];
+		unsigned char* pixels = (unsigned char*) malloc((size_t) res->width * res->height);
+		RecognizerImage* image = NULL;
+		PPRectangle mrz, band;
+		double start, elapsed;
+		int found = 0;
+		int i;
+
+		if (pixels == NULL) {
+			fprintf(stderr, "Out of memory\n");
+			return -1;
+		}
+		drawDocument(pixels, res->width, res->height, &mrz);
+		recognizerImageCreateFromRawImage(&image, pixels, res->width, res->height, (size_t) res->width, RAW_IMAGE_TYPE_GRAY);
+
+		start = recognizeMonotonicMs();
+		for (i = 0; i < iterations; ++i) mrzLocate(image, &options, &band, &found);
+		elapsed = (recognizeMonotonicMs() - start) / iterations;
+
+		if (found) {
+			printf("%-8s %12d %10.3f  %.3f,%.3f %.3fx%.3f %s\n", res->name, res->width * res->height, elapsed,
+					band.x, band.y, band.width, band.height, contains(&band, &mrz) ? "covers MRZ" : "MISSES MRZ");
+		} else {
+			printf("%-8s %12d %10.3f  not found\n", res->name, res->width * res->height, elapsed);
+		}
+
+		recognizerImageDelete(&image);
+		free(pixels);
+	}
+	return 0;
+}
@@ -0,0 +1,116 @@
+#define _XOPEN_SOURCE 600
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "RecognizeOptions.h"
+#include "ScanlineRuns.h"
+
+#define MAX_RUNS 4096
+
+/* Fills row with a synthetic 1D barcode: quiet zones, bars and spaces of 1 to 4 modules, blurred edges and noise */
+static void drawBarcode(unsigned char* row, size_t length, int moduleWidth) {
+	size_t x = length / 10;
+	size_t end = length - length / 10;
+	size_t i;
+	int dark = 1;
+
+	memset(row, 200, length);
+	while (x < end) {
+		size_t width = (size_t) ((1 + rand() % 4) * moduleWidth);
+		for (i = x; i < x + width && i < end; ++i) row[i] = dark ? 40 : 200;
+		x += width;
+		dark = !dark;
+	}
+	for (i = 1; i < length; ++i) {
+		int v = (row[i] + row[i - 1]) / 2 + rand() % 17 - 8;
+		row[i] = (unsigned char) (v < 0 ? 0 : (v > 255 ? 255 : v));
+	}
+}
+
+static void usage(const char* program) {
+	fprintf(stderr, "usage %s [-n rows] [-l row_length] [-m module_width]\n", program);
+	fprintf(stderr, "Measures scanline run-length extraction on synthetic 1D barcodes.\n");
+}
+
+int main(int argc, char* argv[]) {
+	size_t numRows = 2000, length = 1920;
+	int moduleWidth = 3;
+	unsigned char* rows;
+	unsigned int* runs;
+	unsigned int* reference;
+	unsigned char* thresholds;
+	size_t r, totalRuns = 0, mismatches = 0;
+	double start, scalarMs, vectorMs;
+	int firstDark, opt, pass;
+
+	while ((opt = getopt(argc, argv, "n:l:m:h")) != -1) {
+		switch (opt) {
+		case 'n':
+			numRows = (size_t) atol(optarg);
+			break;
+		case 'l':
+			length = (size_t) atol(optarg);
+			break;
+		case 'm':
+			moduleWidth = atoi(optarg);
+			break;
+		default:
+			usage(argv[0]);
+			return -1;
+		}
+	}
+	if (numRows < 1 || length < 32 || moduleWidth < 1) {
+		usage(argv[0]);
+		return -1;
+	}
+
+	rows = (unsigned char*) malloc(numRows * length);
+	thresholds = (unsigned char*) malloc(numRows);
+	runs = (unsigned int*) malloc(MAX_RUNS * sizeof(unsigned int));
+	reference = (unsigned int*) malloc(MAX_RUNS * sizeof(unsigned int));
+	if (rows == NULL || thresholds == NULL || runs == NULL || reference == NULL) {
+		fprintf(stderr, "Out of memory\n");
+		return -1;
+	}
+	srand(1);
+	for (r = 0; r < numRows; ++r) {
+		drawBarcode(rows + r * length, length, moduleWidth);
+		thresholds[r] = scanlineThreshold(rows + r * length, length);
+	}
+
+	for (r = 0; r < numRows; ++r) {
+		int referenceDark;
+		size_t n = scanlineRunsScalar(rows + r * length, length, thresholds[r], reference, MAX_RUNS, &referenceDark);
+		size_t m = scanlineRuns(rows + r * length, length, thresholds[r], runs, MAX_RUNS, &firstDark);
+		if (n != m || firstDark != referenceDark || memcmp(runs, reference, n * sizeof(unsigned int)) != 0) ++mismatches;
+		totalRuns += n;
+	}
+
+	/* each variant runs twice and the second pass is timed, so both see warm caches */
+	scalarMs = vectorMs = 0.0;
+	for (pass = 0; pass < 2; ++pass) {
+		start = recognizeMonotonicMs();
+		for (r = 0; r < numRows; ++r) scanlineRunsScalar(rows + r * length, length, thresholds[r], runs, MAX_RUNS, &firstDark);
+		scalarMs = recognizeMonotonicMs() - start;
+
+		start = recognizeMonotonicMs();
+		for (r = 0; r < numRows; ++r) scanlineRuns(rows + r * length, length, thresholds[r], runs, MAX_RUNS, &firstDark);
+		vectorMs = recognizeMonotonicMs() - start;
+	}
+
+	printf("kernel: %s\n", scanlineRunsKernel());
+	printf("%lu rows of %lu samples, %.1f runs per row, %lu mismatches\n", (unsigned long) numRows,
+			(unsigned long) length, (double) totalRuns / numRows, (unsigned long) mismatches);
+	printf("scalar    %8.3f ms  %8.1f Msamples/s\n", scalarMs, numRows * length / scalarMs / 1000.0);
+	printf("vector    %8.3f ms  %8.1f Msamples/s  speedup %.2fx\n", vectorMs, numRows * length / vectorMs / 1000.0,
+			scalarMs / vectorMs);
+
+	free(rows);
+	free(thresholds);
+	free(runs);
+	free(reference);
+	return mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,78 @@
+#define _XOPEN_SOURCE 600
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "RecognizerApi.h"
+#include "RecognizeOptions.h"
+#include "USDLFields.h"
+#include "DemoUtil.h"
+
+#define MAX_PATH_LENGTH 4096
+
+static void usage(const char* program) {
+	fprintf(stderr, "usage %s [file...]\n", program);
+	fprintf(stderr, "Parses raw AAMVA payloads of driver's license barcodes, one per file, without image recognition.\n");
+	fprintf(stderr, "Files are given as arguments, or listed one per line on stdin. One JSON line is written per file.\n");
+}
+
+int main(int argc, char* argv[]) {
+	char path[MAX_PATH_LENGTH];
+	JsonBuffer json;
+	unsigned long numFiles = 0, numParsed = 0;
+	double parseMs = 0.0;
+	char* const* files;
+	int index = 0;
+
+	if (getopt(argc, argv, "h") != -1) {
+		usage(argv[0]);
+		return -1;
+	}
+	/* paths come from stdin only when no file is given */
+	files = optind < argc ? argv + optind : NULL;
+
+	memset(&json, 0, sizeof(json));
+	while (demoNextPath(files, argc - optind, &index, path, sizeof(path))) {
+		USDLFieldTable table;
+		char* payload = NULL;
+		int size = 0, first = 1, i;
+		RecognizerErrorStatus status;
+		double start;
+
+		++numFiles;
+		json.size = 0;
+		json.failed = 0;
+		jsonAppendText(&json, "{\"file\":");
+		jsonAppendString(&json, path, strlen(path));
+
+		status = recognizerLoadFileToBuffer(path, &payload, &size);
+		if (status == RECOGNIZER_ERROR_STATUS_SUCCESS) {
+			start = recognizeMonotonicMs();
+			status = usdlFieldTableParse(&table, payload, (size_t) size);
+			parseMs += recognizeMonotonicMs() - start;
+		}
+
+		if (status == RECOGNIZER_ERROR_STATUS_SUCCESS) {
+			++numParsed;
+			jsonAppendText(&json, ",\"fields\":{");
+			for (i = 0; i < USDL_FIELD_COUNT; ++i) {
+				jsonAppendField(&json, &first, usdlFieldKey((UsdlFieldId) i), table.fields[i]);
+			}
+			jsonAppendText(&json, "}}");
+		} else {
+			jsonAppendText(&json, ",\"error\":");
+			jsonAppendText(&json, status == RECOGNIZER_ERROR_STATUS_INVALID_TYPE ? "\"not an AAMVA payload\"}"
+					: "\"could not load file\"}");
+		}
+		/* views in table point into payload, so it is freed only after the line is written */
+		if (!json.failed) puts(json.data);
+		if (payload != NULL) recognizerFreeFileBuffer(&payload);
+	}
+
+	fprintf(stderr, "Parsed %lu of %lu files, parsing took %.3f ms, %.1f us per payload\n", numParsed, numFiles,
+			parseMs, numFiles > 0 ? parseMs * 1000.0 / numFiles : 0.0);
+	free(json.data);
+	return 0;
+}